@@ -0,0 +1,207 @@
+#include "BenchUtil.h"
+#include <QFile>
+#include <QRandomGenerator>
+#include <algorithm>
+#include <limits>
+#include <unistd.h>
+
+namespace Bench {
+
+namespace {
+
+const char* const Words[] = {
+    "library", "tools", "utilities", "python", "bindings", "for", "the", "and",
+    "a", "of", "to", "with", "support", "implementation", "fast",
+    "lightweight", "framework", "gtk", "qt", "rendering", "font", "image", "audio",
+    "video", "codec", "network", "protocol", "client", "server", "daemon", "file",
+    "system", "manager", "parser", "xml", "json", "compression", "archive", "crypto",
+    "ssl", "kernel", "module", "driver", "firmware", "graphics", "opengl", "vulkan",
+    "wayland", "x11", "extension", "plugin", "documentation", "headers", "development",
+    "runtime", "shared", "data", "files", "terminal", "editor", "language", "compiler",
+};
+constexpr int WordCount = int(sizeof(Words) / sizeof(Words[0]));
+
+const char* const Prefixes[] = {
+    "", "lib", "python-", "perl-", "qt6-", "gst-plugins-", "xorg-", "ttf-", "haskell-", "lib32-",
+};
+constexpr int PrefixCount = int(sizeof(Prefixes) / sizeof(Prefixes[0]));
+
+const char* const Licenses[] = {"GPL", "GPL-2.0-or-later", "LGPL", "MIT", "BSD", "Apache", "custom"};
+const char* const Groups[] = {"base-devel", "xorg", "gnome", "kde-applications", "texlive"};
+
+QByteArray word(QRandomGenerator& random) {
+    return Words[random.bounded(WordCount)];
+}
+
+QStringList toStrings(const QList<QByteArray>& values) {
+    QStringList list;
+    list.reserve(values.size());
+    for (const QByteArray& value : values) {
+        list.append(QString::fromUtf8(value));
+    }
+    return list;
+}
+
+} // namespace
+
+SyntheticPackages::SyntheticPackages(int count, quint32 seed) {
+    QRandomGenerator random(seed);
+    m_packages.resize(count);
+
+    for (int i = 0; i < count; ++i) {
+        Source& p = m_packages[i];
+        p.name = QByteArray(Prefixes[random.bounded(PrefixCount)]) + word(random) + '-' + QByteArray::number(i);
+        p.version = QByteArray::number(random.bounded(1, 30)) + '.' + QByteArray::number(random.bounded(20))
+            + '.' + QByteArray::number(random.bounded(12)) + '-' + QByteArray::number(random.bounded(1, 4));
+        if (random.bounded(20) == 0) {
+            p.version.prepend("1:");
+        }
+
+        const int words = random.bounded(4, 14);
+        for (int w = 0; w < words; ++w) {
+            if (w > 0) p.description += ' ';
+            p.description += word(random);
+        }
+        p.url = "https://example.org/" + p.name;
+        p.packager = "Packager " + QByteArray::number(random.bounded(40)) + " <dev@example.org>";
+        p.architecture = random.bounded(10) == 0 ? "any" : "x86_64";
+
+        // Mostly small, a long tail of big ones
+        p.installedSize = qint64(1024) << random.bounded(24);
+        p.installedSize += random.bounded(1024 * 1024);
+        p.buildDate = 1600000000 + random.bounded(100000000);
+        p.installDate = p.buildDate + random.bounded(5000000);
+        p.isExplicit = random.bounded(5) == 0;
+
+        p.licenses.append(Licenses[random.bounded(int(sizeof(Licenses) / sizeof(Licenses[0])))]);
+        if (random.bounded(8) == 0) {
+            p.groups.append(Groups[random.bounded(int(sizeof(Groups) / sizeof(Groups[0])))]);
+        }
+        if (random.bounded(10) == 0) {
+            p.provides.append("so:" + p.name + ".so");
+        }
+    }
+
+    std::sort(m_packages.begin(), m_packages.end(), [](const Source& a, const Source& b) {
+        return a.name < b.name;
+    });
+
+    // Dependencies by name, so the same strings repeat the way they do in a real db
+    for (int i = 0; i < count; ++i) {
+        Source& p = m_packages[i];
+        const int depends = count > 1 ? random.bounded(0, 10) : 0;
+        for (int d = 0; d < depends; ++d) {
+            p.depends.append(m_packages[random.bounded(count)].name);
+        }
+        if (count > 1 && random.bounded(4) == 0) {
+            p.optDepends.append(m_packages[random.bounded(count)].name + ": " + word(random) + " support");
+        }
+    }
+}
+
+void SyntheticPackages::fill(int index, PackageStore::Record& record) const {
+    const Source& p = m_packages[index];
+    record.clear();
+    record.name = p.name;
+    record.version = p.version;
+    record.description = p.description;
+    record.url = p.url;
+    record.packager = p.packager;
+    record.architecture = p.architecture;
+    record.installedSize = p.installedSize;
+    record.installDate = p.installDate;
+    record.buildDate = p.buildDate;
+    record.isExplicit = p.isExplicit;
+    for (const QByteArray& value : p.groups) record.groups.append(value);
+    for (const QByteArray& value : p.licenses) record.licenses.append(value);
+    for (const QByteArray& value : p.depends) record.depends.append(value);
+    for (const QByteArray& value : p.optDepends) record.optDepends.append(value);
+    for (const QByteArray& value : p.provides) record.provides.append(value);
+}
+
+std::shared_ptr<PackageStore> SyntheticPackages::store(quint64 generation) const {
+    auto store = std::make_shared<PackageStore>(generation);
+    store->reserve(size());
+    PackageStore::Record record;
+    for (int i = 0; i < size(); ++i) {
+        fill(i, record);
+        store->append(record);
+    }
+    store->finalize();
+    return store;
+}
+
+QList<Package> SyntheticPackages::packages() const {
+    // What the libalpm loop used to build: every field converted to QString
+    QList<Package> packages;
+    packages.reserve(size());
+    for (const Source& p : m_packages) {
+        Package pkg;
+        pkg.name = QString::fromUtf8(p.name);
+        pkg.version = QString::fromUtf8(p.version);
+        pkg.description = QString::fromUtf8(p.description);
+        pkg.url = QString::fromUtf8(p.url);
+        pkg.packager = QString::fromUtf8(p.packager);
+        pkg.architecture = QString::fromUtf8(p.architecture);
+        pkg.installedSize = p.installedSize;
+        pkg.installDate = QDateTime::fromSecsSinceEpoch(p.installDate);
+        pkg.buildDate = QDateTime::fromSecsSinceEpoch(p.buildDate);
+        pkg.installReason = p.isExplicit ? "explicit" : "dependency";
+        pkg.groups = toStrings(p.groups);
+        pkg.licenses = toStrings(p.licenses);
+        pkg.depends = toStrings(p.depends);
+        pkg.optDepends = toStrings(p.optDepends);
+        pkg.provides = toStrings(p.provides);
+        packages.append(pkg);
+    }
+    return packages;
+}
+
+QList<QByteArray> SyntheticPackages::files(int index, int filesPerPackage) const {
+    // Shared system directories first, then a tree of the package's own
+    const QByteArray& name = m_packages[index].name;
+    QRandomGenerator random(quint32(index) * 2654435761u);
+    QList<QByteArray> paths = {"usr/", "usr/bin/", "usr/lib/", "usr/share/", "usr/share/doc/",
+                               "usr/share/" + name + '/', "usr/share/doc/" + name + '/'};
+    paths.append("usr/bin/" + name);
+
+    QByteArray dir = "usr/share/" + name + '/';
+    while (paths.size() < filesPerPackage) {
+        if (random.bounded(16) == 0) {
+            dir = "usr/share/" + name + '/' + word(random) + QByteArray::number(random.bounded(8)) + '/';
+            paths.append(dir);
+        }
+        const int kind = random.bounded(4);
+        if (kind == 0) {
+            paths.append("usr/lib/lib" + name + '-' + word(random) + ".so." + QByteArray::number(paths.size()));
+        } else {
+            paths.append(dir + word(random) + '_' + QByteArray::number(paths.size()) + (kind == 1 ? ".py" : ".dat"));
+        }
+    }
+    return paths;
+}
+
+double bestMs(int runs, const std::function<void()>& work) {
+    double best = std::numeric_limits<double>::max();
+    for (int run = 0; run < runs; ++run) {
+        QElapsedTimer timer;
+        timer.start();
+        work();
+        best = std::min(best, timer.nsecsElapsed() / 1e6);
+    }
+    return best;
+}
+
+qint64 residentBytes() {
+    // "size resident shared ..." in pages
+    QFile statm("/proc/self/statm");
+    if (!statm.open(QIODevice::ReadOnly)) return 0;
+    QList<QByteArray> fields = statm.readAll().split(' ');
+    return fields.size() > 1 ? fields[1].toLongLong() * sysconf(_SC_PAGESIZE) : 0;
+}
+
+double toMiB(qint64 bytes) {
+    return bytes / (1024.0 * 1024.0);
+}
+
+} // namespace Bench
@@ -0,0 +1,68 @@
+#ifndef BENCHUTIL_H
+#define BENCHUTIL_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QList>
+#include <QStringList>
+#include <functional>
+#include <memory>
+#include "core/PackageStore.h"
+#include "models/Package.h"
+
+// Shared helpers for the benchmark programs: a deterministic synthetic
+// local db, wall-clock timing and resident memory.
+namespace Bench {
+
+// count fake packages with the field shapes of a real local db: sorted
+// names, shared dependency/license/group names, a few thousand distinct
+// description words. The same seed always gives the same packages.
+class SyntheticPackages {
+public:
+    explicit SyntheticPackages(int count, quint32 seed = 42);
+
+    int size() const { return m_packages.size(); }
+
+    // Views point into this object
+    void fill(int index, PackageStore::Record& record) const;
+
+    std::shared_ptr<PackageStore> store(quint64 generation = 1) const;
+    QList<Package> packages() const;  // the old materialized form
+
+    // Installed paths of one package the way pacman lists them: no leading
+    // '/', directories end in '/'. About filesPerPackage of them.
+    QList<QByteArray> files(int index, int filesPerPackage = 250) const;
+
+private:
+    struct Source {
+        QByteArray name;
+        QByteArray version;
+        QByteArray description;
+        QByteArray url;
+        QByteArray packager;
+        QByteArray architecture;
+        qint64 installedSize = 0;
+        qint64 installDate = 0;
+        qint64 buildDate = 0;
+        bool isExplicit = false;
+        QList<QByteArray> groups;
+        QList<QByteArray> licenses;
+        QList<QByteArray> depends;
+        QList<QByteArray> optDepends;
+        QList<QByteArray> provides;
+    };
+
+    QList<Source> m_packages;
+};
+
+// Best of runs wall-clock times of work, in milliseconds
+double bestMs(int runs, const std::function<void()>& work);
+
+// Resident set size of this process, in bytes
+qint64 residentBytes();
+
+double toMiB(qint64 bytes);
+
+} // namespace Bench
+
+#endif // BENCHUTIL_H
@@ -0,0 +1,93 @@
+// FileOwnerIndex over ~1M synthetic installed paths: build time, encoded
+// size against the raw paths, and exact, directory and batch lookups.
+//
+//   bench_file_index [packages]   default 4000, ~250 paths each
+
+#include "BenchUtil.h"
+#include "core/FileOwnerIndex.h"
+#include <QCoreApplication>
+#include <QRandomGenerator>
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+constexpr int Queries = 100000;
+constexpr int BatchQueries = 10000;
+constexpr int DirectoryQueries = 1000;
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    const int packages = argc > 1 ? QByteArray(argv[1]).toInt() : 4000;
+
+    Bench::SyntheticPackages synthetic(packages);
+    QList<QList<QByteArray>> files;
+    qint64 rawBytes = 0;
+    int pathCount = 0;
+    files.reserve(packages);
+    for (int i = 0; i < packages; ++i) {
+        files.append(synthetic.files(i));
+        for (const QByteArray& path : files.last()) {
+            rawBytes += path.size();
+        }
+        pathCount += files.last().size();
+    }
+
+    FileOwnerIndex index;
+    const double buildMs = Bench::bestMs(3, [&]() {
+        FileOwnerIndex::Builder builder;
+        builder.reserve(pathCount, rawBytes);
+        for (int i = 0; i < packages; ++i) {
+            for (const QByteArray& path : files[i]) {
+                builder.add(path, i);
+            }
+        }
+        index = builder.build(1);
+    });
+
+    // Hits on random installed files, with a miss every tenth query
+    QRandomGenerator random(7);
+    QStringList queries;
+    queries.reserve(Queries);
+    for (int q = 0; q < Queries; ++q) {
+        const QList<QByteArray>& list = files[random.bounded(packages)];
+        QString path = "/" + QString::fromUtf8(list[random.bounded(int(list.size()))]);
+        queries.append(q % 10 == 0 ? path + ".missing" : path);
+    }
+
+    int found = 0;
+    const double exactMs = Bench::bestMs(3, [&]() {
+        found = 0;
+        for (const QString& path : queries) {
+            found += index.owner(path) >= 0;
+        }
+    });
+
+    // Each package's own share directory
+    QStringList directories;
+    PackageStore::Record record;
+    for (int q = 0; q < DirectoryQueries; ++q) {
+        synthetic.fill(random.bounded(packages), record);
+        directories.append("/usr/share/" + QString::fromUtf8(record.name));
+    }
+    const double directoryMs = Bench::bestMs(3, [&]() {
+        for (const QString& directory : directories) {
+            index.ownersUnder(directory);
+        }
+    });
+
+    QStringList batch = queries.mid(0, BatchQueries);
+    std::sort(batch.begin(), batch.end());
+    const double batchMs = Bench::bestMs(3, [&]() { index.owners(batch); });
+
+    std::printf("paths               %d in %d packages\n", index.size(), packages);
+    std::printf("build               %.1f ms\n", buildMs);
+    std::printf("raw paths           %.1f MiB\n", Bench::toMiB(rawBytes));
+    std::printf("index               %.1f MiB\n", Bench::toMiB(index.memoryUsage()));
+    std::printf("exact lookup        %.2f us (%d of %d found)\n", exactMs * 1000 / Queries, found, Queries);
+    std::printf("directory lookup    %.2f us\n", directoryMs * 1000 / DirectoryQueries);
+    std::printf("sorted batch        %.2f us per path (%d paths)\n", batchMs * 1000 / BatchQueries, BatchQueries);
+    return 0;
+}
@@ -0,0 +1,87 @@
+// Filter passes of PackageFilterProxyModel over a 50k-row PackageListModel,
+// against the 16.7 ms of one frame at 60 Hz.
+//
+// Each pass is what the Packages view does when a filter control changes:
+// the proxy refilters every source row. The first pass of a text search
+// also builds the model's trigram index, so it is reported separately.
+//
+//   bench_package_filter [rows]
+
+#include "BenchUtil.h"
+#include "models/PackageListModel.h"
+#include <QGuiApplication>
+#include <cstdio>
+
+namespace {
+
+constexpr double FrameMs = 1000.0 / 60;
+constexpr int Runs = 5;
+
+struct Case {
+    const char* label;
+    std::function<void(PackageFilterProxyModel&)> apply;
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    // The model builds fonts, which needs a GUI application but no display
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QGuiApplication app(argc, argv);
+    const int rows = argc > 1 ? QByteArray(argv[1]).toInt() : 50000;
+
+    Bench::SyntheticPackages synthetic(rows);
+    PackageListModel model;
+    model.setStore(synthetic.store());
+    for (int row = 0; row < rows; row += 7) {
+        model.setKeep(row, true);
+    }
+
+    PackageFilterProxyModel proxy;
+    proxy.setSourceModel(&model);
+    proxy.sort(PackageListModel::NameColumn);
+
+    auto reset = [](PackageFilterProxyModel& p) {
+        p.setFilterType(PackageFilterProxyModel::FilterAll);
+        p.setSearchText(QString());
+        p.setMinSize(0);
+    };
+
+    // The trigram index is built on the first text query
+    QElapsedTimer timer;
+    timer.start();
+    proxy.setSearchText("lib");
+    const double coldMs = timer.nsecsElapsed() / 1e6;
+    reset(proxy);
+
+    const QList<Case> cases = {
+        {"type: explicit", [](PackageFilterProxyModel& p) { p.setFilterType(PackageFilterProxyModel::FilterExplicit); }},
+        {"type: orphan", [](PackageFilterProxyModel& p) { p.setFilterType(PackageFilterProxyModel::FilterOrphan); }},
+        {"type: keep", [](PackageFilterProxyModel& p) { p.setFilterType(PackageFilterProxyModel::FilterKeep); }},
+        {"min size 10M", [](PackageFilterProxyModel& p) { p.setMinSize(10 * 1024 * 1024); }},
+        {"text: lib", [](PackageFilterProxyModel& p) { p.setSearchText("lib"); }},
+        {"text: codec support", [](PackageFilterProxyModel& p) { p.setSearchText("codec support"); }},
+        {"query: size:>1M reason:dep name:py*", [](PackageFilterProxyModel& p) { p.setSearchText("size:>1M reason:dep name:py*"); }},
+        {"query: is:keep or is:orphan", [](PackageFilterProxyModel& p) { p.setSearchText("is:keep or is:orphan"); }},
+    };
+
+    std::printf("%d rows, frame budget %.1f ms\n", model.rowCount(), FrameMs);
+    std::printf("%-40s %10s %8s %6s\n", "filter", "ms/pass", "rows", "frame");
+    std::printf("%-40s %10.2f %8s %6s\n", "text: lib (first, builds index)", coldMs, "", coldMs <= FrameMs ? "ok" : "over");
+
+    for (const Case& c : cases) {
+        double best = 1e9;
+        int shown = 0;
+        for (int run = 0; run < Runs; ++run) {
+            reset(proxy);
+            timer.restart();
+            c.apply(proxy);
+            best = qMin(best, timer.nsecsElapsed() / 1e6);
+            shown = proxy.rowCount();
+        }
+        std::printf("%-40s %10.2f %8d %6s\n", c.label, best, shown, best <= FrameMs ? "ok" : "over");
+    }
+    return 0;
+}
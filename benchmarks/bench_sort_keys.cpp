@@ -0,0 +1,106 @@
+// Sort keys of the package table at 50k synthetic packages: building them
+// from scratch against splicing in the packages an incremental reload
+// changed, the whole PackageListModel::applyChanges() such a reload runs on
+// the GUI thread, and a proxy sort by each ranked column.
+//
+//   bench_sort_keys [packages]
+
+#include "BenchUtil.h"
+#include "core/LocalDbWatcher.h"
+#include "models/PackageListModel.h"
+#include "models/PackageSortKeys.h"
+#include <QGuiApplication>
+#include <cstdio>
+
+namespace {
+
+constexpr int Runs = 5;
+const int ChangedCounts[] = {1, 10, 100, 1000};
+
+// The synthetic packages with changed of them upgraded, spread evenly
+std::shared_ptr<PackageStore> upgradedStore(const Bench::SyntheticPackages& synthetic, int changed) {
+    const int every = qMax(1, synthetic.size() / changed);
+    auto store = std::make_shared<PackageStore>(2);
+    store->reserve(synthetic.size());
+    PackageStore::Record record;
+    QByteArray version;
+    for (int i = 0; i < synthetic.size(); ++i) {
+        synthetic.fill(i, record);
+        if (i % every == 0) {
+            version = record.version.toByteArray() + ".1";
+            record.version = version;
+        }
+        store->append(record);
+    }
+    store->finalize();
+    return store;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    // The model builds fonts, which needs a GUI application but no display
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QGuiApplication app(argc, argv);
+    const int count = argc > 1 ? QByteArray(argv[1]).toInt() : 50000;
+
+    Bench::SyntheticPackages synthetic(count);
+    std::shared_ptr<PackageStore> base = synthetic.store();
+
+    PackageSortKeys keys;
+    const double buildMs = Bench::bestMs(Runs, [&]() { keys.build(*base); });
+    std::printf("%d packages, build from scratch %.2f ms\n", count, buildMs);
+
+    std::printf("%-10s %14s %18s\n", "changed", "update ms", "applyChanges ms");
+    for (int changed : ChangedCounts) {
+        std::shared_ptr<PackageStore> upgraded = upgradedStore(synthetic, changed);
+        const LocalDbChanges changes = LocalDbChanges::between(*base, *upgraded);
+
+        PackageSortKeys updated;
+        double updateMs = 1e9;
+        for (int run = 0; run < Runs; ++run) {
+            updated.build(*base);
+            QElapsedTimer timer;
+            timer.start();
+            updated.update(*base, *upgraded);
+            updateMs = qMin(updateMs, timer.nsecsElapsed() / 1e6);
+        }
+
+        // What a pacman transaction costs the Packages view
+        double applyMs = 1e9;
+        for (int run = 0; run < Runs; ++run) {
+            PackageListModel model;
+            PackageFilterProxyModel proxy;
+            proxy.setSourceModel(&model);
+            model.setStore(base);
+            proxy.sort(PackageListModel::NameColumn);
+            QElapsedTimer timer;
+            timer.start();
+            model.applyChanges(upgraded, changes);
+            applyMs = qMin(applyMs, timer.nsecsElapsed() / 1e6);
+        }
+        std::printf("%-10d %14.2f %18.2f\n", int(changes.changed.size()), updateMs, applyMs);
+    }
+
+    PackageListModel model;
+    PackageFilterProxyModel proxy;
+    proxy.setSourceModel(&model);
+    model.setStore(base);
+    std::printf("%-12s %10s\n", "sort by", "ms");
+    const QList<QPair<const char*, int>> columns = {
+        {"name", PackageListModel::NameColumn},
+        {"version", PackageListModel::VersionColumn},
+        {"description", PackageListModel::DescriptionColumn},
+    };
+    for (const auto& column : columns) {
+        // Sorted, then back to source order so every run sorts from scratch
+        const double ms = Bench::bestMs(Runs, [&]() {
+            proxy.sort(column.second, Qt::AscendingOrder);
+            proxy.sort(-1);
+        });
+        std::printf("%-12s %10.2f\n", column.first, ms);
+    }
+    return 0;
+}
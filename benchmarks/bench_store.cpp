@@ -0,0 +1,64 @@
+// Load time and resident memory of the columnar PackageStore against the
+// QList<Package> it replaced, at 5k and 50k synthetic packages.
+//
+// Every case runs in a child process of its own, so one layout's freed
+// memory never shows up in the other's RSS.
+//
+//   bench_store                   all cases, as a table
+//   bench_store <layout> <count>  one case: prints "ms bytes"
+
+#include "BenchUtil.h"
+#include <QCoreApplication>
+#include <QProcess>
+#include <cstdio>
+
+namespace {
+
+const int Counts[] = {5000, 50000};
+const char* const Layouts[] = {"qlist", "store"};
+
+int runCase(const QString& layout, int count) {
+    Bench::SyntheticPackages synthetic(count);
+    const qint64 before = Bench::residentBytes();
+
+    QElapsedTimer timer;
+    timer.start();
+    QList<Package> packages;
+    std::shared_ptr<PackageStore> store;
+    if (layout == "qlist") {
+        packages = synthetic.packages();
+    } else {
+        store = synthetic.store();
+    }
+    const double ms = timer.nsecsElapsed() / 1e6;
+
+    std::printf("%.2f %lld\n", ms, static_cast<long long>(Bench::residentBytes() - before));
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    const QStringList args = app.arguments();
+    if (args.size() == 3) {
+        return runCase(args[1], args[2].toInt());
+    }
+
+    std::printf("%-10s %-8s %12s %12s\n", "packages", "layout", "load ms", "RSS MiB");
+    for (int count : Counts) {
+        for (const char* layout : Layouts) {
+            QProcess child;
+            child.start(app.applicationFilePath(), {layout, QString::number(count)});
+            if (!child.waitForFinished(-1) || child.exitCode() != 0) {
+                std::fprintf(stderr, "bench_store: %s %d failed\n", layout, count);
+                return 1;
+            }
+            const QList<QByteArray> fields = child.readAllStandardOutput().trimmed().split(' ');
+            if (fields.size() != 2) return 1;
+            std::printf("%-10d %-8s %12.2f %12.2f\n", count, layout,
+                        fields[0].toDouble(), Bench::toMiB(fields[1].toLongLong()));
+        }
+    }
+    return 0;
+}
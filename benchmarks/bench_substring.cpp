@@ -0,0 +1,160 @@
+// The substring kernels against QString::contains(Qt::CaseInsensitive),
+// over the names and descriptions of 50k synthetic packages.
+//
+//   bench_substring            timings
+//   bench_substring --verify   checks that every available kernel finds
+//                              the same positions as a plain search; run
+//                              by ctest
+
+#include "BenchUtil.h"
+#include "utils/SubstringSearch.h"
+#include <QCoreApplication>
+#include <QRandomGenerator>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+using SubstringSearch::Kernel;
+
+struct KernelInfo {
+    Kernel kernel;
+    const char* name;
+};
+
+const KernelInfo Kernels[] = {
+    {Kernel::Scalar, "scalar"},
+    {Kernel::Sse2, "sse2"},
+    {Kernel::Avx2, "avx2"},
+};
+
+qsizetype referenceIndexOf(QByteArrayView haystack, QByteArrayView needle, qsizetype from) {
+    if (from < 0 || from > haystack.size()) return -1;
+    const char* found = std::search(haystack.data() + from, haystack.data() + haystack.size(),
+                                    needle.data(), needle.data() + needle.size());
+    if (found == haystack.data() + haystack.size() && !needle.isEmpty()) return -1;
+    return found - haystack.data();
+}
+
+// Small alphabets give many candidates whose first and last byte match but
+// whose middle doesn't. Haystack and needle lengths straddle the 16- and
+// 32-byte vectors, and needles are often cut from the haystack's tail so
+// the match sits in the part the vector loops leave to the scalar tail.
+int verify() {
+    QRandomGenerator random(1);
+    int checks = 0;
+    int failures = 0;
+
+    for (int round = 0; round < 20000; ++round) {
+        const int alphabet = round % 3 == 0 ? 2 : (round % 3 == 1 ? 4 : 26);
+        const int length = random.bounded(0, 100);
+        QByteArray haystack(length, Qt::Uninitialized);
+        for (char& c : haystack) {
+            c = char('a' + random.bounded(alphabet));
+        }
+
+        QByteArray needle;
+        const int needleLength = random.bounded(1, 40);
+        if (length > 0 && random.bounded(2) == 0) {
+            const int from = random.bounded(length);
+            const int start = random.bounded(2) == 0 ? qMax(0, length - needleLength) : from;
+            needle = haystack.mid(start, needleLength);
+        } else {
+            needle.resize(needleLength);
+            for (char& c : needle) {
+                c = char('a' + random.bounded(alphabet));
+            }
+        }
+        const qsizetype from = length > 0 ? random.bounded(length + 1) : 0;
+
+        const qsizetype expected = referenceIndexOf(haystack, needle, from);
+        for (const KernelInfo& info : Kernels) {
+            if (!SubstringSearch::isAvailable(info.kernel)) continue;
+            const qsizetype found = SubstringSearch::indexOf(info.kernel, haystack, needle, from);
+            ++checks;
+            if (found != expected) {
+                ++failures;
+                if (failures <= 10) {
+                    std::fprintf(stderr, "%s: \"%s\" in \"%s\" from %lld: got %lld, expected %lld\n",
+                                 info.name, needle.constData(), haystack.constData(),
+                                 static_cast<long long>(from), static_cast<long long>(found),
+                                 static_cast<long long>(expected));
+                }
+            }
+        }
+    }
+
+    std::printf("%d checks, %d failures (kernels:", checks, failures);
+    for (const KernelInfo& info : Kernels) {
+        if (SubstringSearch::isAvailable(info.kernel)) std::printf(" %s", info.name);
+    }
+    std::printf(")\n");
+    return failures == 0 ? 0 : 1;
+}
+
+int benchmark() {
+    Bench::SyntheticPackages synthetic(50000);
+    std::shared_ptr<PackageStore> store = synthetic.store();
+
+    // One line per name and per description, as FoldedText lays them out
+    QStringList lines;
+    QByteArray blob;
+    for (PackageId id = 0; id < store->size(); ++id) {
+        for (const QString& text : {store->name(id), store->description(id)}) {
+            lines.append(text);
+            blob += SubstringSearch::fold(text);
+            blob += '\n';
+        }
+    }
+
+    const char* const needles[] = {"lib", "Python", "codec support", "so", "nothing-like-this"};
+    std::printf("%d lines, %.1f MiB folded; ms per pass over all lines (lines matched)\n",
+                int(lines.size()), Bench::toMiB(blob.size()));
+    std::printf("%-20s %16s", "needle", "QString");
+    for (const KernelInfo& info : Kernels) {
+        if (SubstringSearch::isAvailable(info.kernel)) std::printf(" %16s", info.name);
+    }
+    std::printf("\n");
+
+    for (const char* text : needles) {
+        const QString needle = QString::fromUtf8(text);
+        int matched = 0;
+        const double qstringMs = Bench::bestMs(5, [&]() {
+            matched = 0;
+            for (const QString& line : lines) {
+                matched += line.contains(needle, Qt::CaseInsensitive);
+            }
+        });
+        std::printf("%-20s %9.2f (%5d)", text, qstringMs, matched);
+
+        const QByteArray folded = SubstringSearch::fold(needle);
+        for (const KernelInfo& info : Kernels) {
+            if (!SubstringSearch::isAvailable(info.kernel)) continue;
+            const double ms = Bench::bestMs(5, [&]() {
+                // After a hit, go on from the next line
+                matched = 0;
+                qsizetype pos = 0;
+                while ((pos = SubstringSearch::indexOf(info.kernel, blob, folded, pos)) >= 0) {
+                    ++matched;
+                    const char* eol = static_cast<const char*>(
+                        std::memchr(blob.constData() + pos, '\n', blob.size() - pos));
+                    pos = eol ? eol - blob.constData() + 1 : blob.size();
+                }
+            });
+            std::printf(" %9.2f (%5d)", ms, matched);
+        }
+        std::printf("\n");
+    }
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    if (app.arguments().contains("--verify")) {
+        return verify();
+    }
+    return benchmark();
+}
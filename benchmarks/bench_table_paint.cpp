@@ -0,0 +1,120 @@
+// Cell text and painting of the Packages table over 50k synthetic rows,
+// against the 16.7 ms of one frame at 60 Hz.
+//
+// data(DisplayRole) is timed for every cell, first while the model still
+// formats each row's text and then from its cache. Painting scrolls a
+// 1280x800 table a page at a time and renders the viewport into an image,
+// once with PackageItemDelegate and once with the QStyledItemDelegate it
+// replaced; the first pass over the delegate also fills its layout cache,
+// so it is reported separately.
+//
+//   bench_table_paint [rows]
+
+#include "BenchUtil.h"
+#include "models/PackageListModel.h"
+#include "ui/PackageItemDelegate.h"
+#include <QApplication>
+#include <QHeaderView>
+#include <QImage>
+#include <QScrollBar>
+#include <QStyledItemDelegate>
+#include <QTableView>
+#include <cstdio>
+
+namespace {
+
+constexpr double FrameMs = 1000.0 / 60;
+constexpr int Pages = 100;
+
+// ms per frame over Pages pages, starting from the top
+double scrollMs(QTableView& view, QImage& image) {
+    QScrollBar* bar = view.verticalScrollBar();
+    const int rowsPerPage = qMax(1, view.viewport()->height() / view.verticalHeader()->defaultSectionSize());
+    QElapsedTimer timer;
+    timer.start();
+    for (int page = 0; page < Pages; ++page) {
+        bar->setValue(page * rowsPerPage);
+        image.fill(Qt::white);
+        view.viewport()->render(&image);
+    }
+    return timer.nsecsElapsed() / 1e6 / Pages;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    // Widgets need a GUI platform but no display
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+    const int rows = argc > 1 ? QByteArray(argv[1]).toInt() : 50000;
+
+    Bench::SyntheticPackages synthetic(rows);
+    PackageListModel model;
+    model.setStore(synthetic.store());
+
+    auto allCells = [&model]() {
+        qsizetype characters = 0;
+        for (int row = 0; row < model.rowCount(); ++row) {
+            for (int column = 0; column < PackageListModel::ColumnCount; ++column) {
+                characters += model.data(model.index(row, column), Qt::DisplayRole).toString().size();
+            }
+        }
+        return characters;
+    };
+    QElapsedTimer timer;
+    timer.start();
+    allCells();
+    const double coldMs = timer.nsecsElapsed() / 1e6;
+    const double warmMs = Bench::bestMs(3, [&]() { allCells(); });
+    const double cells = double(model.rowCount()) * PackageListModel::ColumnCount;
+
+    std::printf("%d rows, frame budget %.1f ms\n", model.rowCount(), FrameMs);
+    std::printf("data() first pass        %8.2f ms  (%.0f ns per cell)\n", coldMs, coldMs * 1e6 / cells);
+    std::printf("data() cached            %8.2f ms  (%.0f ns per cell)\n", warmMs, warmMs * 1e6 / cells);
+
+    // Set up like PackageView's table; the delegates outlive the view
+    PackageItemDelegate delegate;
+    QStyledItemDelegate styled;
+    PackageFilterProxyModel proxy;
+    proxy.setSourceModel(&model);
+    QTableView view;
+    view.setModel(&proxy);
+    view.setAlternatingRowColors(true);
+    view.setSelectionBehavior(QAbstractItemView::SelectRows);
+    view.horizontalHeader()->setStretchLastSection(true);
+    view.verticalHeader()->setVisible(false);
+    view.verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    view.setShowGrid(false);
+    view.setWordWrap(false);
+    view.setColumnWidth(PackageListModel::NameColumn, 200);
+    view.setColumnWidth(PackageListModel::VersionColumn, 150);
+    view.resize(1280, 800);
+    view.show();
+    view.selectRow(3);
+
+    QImage image(view.viewport()->size(), QImage::Format_ARGB32_Premultiplied);
+    std::printf("%-24s %8s %6s\n", "paint, per page", "ms", "frame");
+    auto report = [](const char* label, double ms) {
+        std::printf("%-24s %8.2f %6s\n", label, ms, ms <= FrameMs ? "ok" : "over");
+    };
+
+    view.setItemDelegate(&delegate);
+    view.verticalHeader()->setDefaultSectionSize(PackageItemDelegate::rowHeight(view.font()));
+    report("static text, first", scrollMs(view, image));
+    double best = 1e9;
+    for (int run = 0; run < 3; ++run) {
+        best = qMin(best, scrollMs(view, image));
+    }
+    report("static text", best);
+
+    // Same row height, so both paint the same rows
+    view.setItemDelegate(&styled);
+    best = 1e9;
+    for (int run = 0; run < 3; ++run) {
+        best = qMin(best, scrollMs(view, image));
+    }
+    report("QStyledItemDelegate", best);
+    return 0;
+}
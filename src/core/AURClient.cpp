@@ -19,52 +19,49 @@ void AURClient::search(const QString& query) {
         return;
     }
     
-    setLoading(true);
-    
-    QUrl url(API_BASE + "/search/" + query);
-    QNetworkRequest request(url);
-    request.setHeader(QNetworkRequest::UserAgentHeader, "ArchMaster/1.0");
-    
-    QNetworkReply* reply = m_networkManager->get(request);
-    connect(reply, &QNetworkReply::finished, this, [this, reply]() {
-        onSearchReply(reply);
-    });
+    startSearch(QUrl(API_BASE + "/search/" + query));
 }
 
 void AURClient::searchByMaintainer(const QString& maintainer) {
-    setLoading(true);
-    
     QUrl url(API_BASE + "/search/" + maintainer);
     QUrlQuery query;
     query.addQueryItem("by", "maintainer");
     url.setQuery(query);
     
-    QNetworkRequest request(url);
-    request.setHeader(QNetworkRequest::UserAgentHeader, "ArchMaster/1.0");
-    
-    QNetworkReply* reply = m_networkManager->get(request);
-    connect(reply, &QNetworkReply::finished, this, [this, reply]() {
-        onSearchReply(reply);
-    });
+    startSearch(url);
 }
 
 void AURClient::searchByName(const QString& name) {
-    setLoading(true);
-    
     QUrl url(API_BASE + "/search/" + name);
     QUrlQuery query;
     query.addQueryItem("by", "name");
     url.setQuery(query);
     
+    startSearch(url);
+}
+
+void AURClient::startSearch(const QUrl& url) {
+    cancelSearch();
+    setLoading(true);
+    
     QNetworkRequest request(url);
     request.setHeader(QNetworkRequest::UserAgentHeader, "ArchMaster/1.0");
     
     QNetworkReply* reply = m_networkManager->get(request);
+    m_searchReply = reply;
     connect(reply, &QNetworkReply::finished, this, [this, reply]() {
         onSearchReply(reply);
     });
 }
 
+void AURClient::cancelSearch() {
+    if (m_searchReply && m_searchReply->isRunning()) {
+        m_searchReply->abort();  // finishes with OperationCanceledError
+        setLoading(false);
+    }
+    m_searchReply = nullptr;
+}
+
 void AURClient::getPackageInfo(const QString& packageName) {
     getPackageInfo(QStringList() << packageName);
 }
@@ -171,8 +168,13 @@ void AURClient::checkForUpdates(const QMap<QString, QString>& installedPackages)
 }
 
 void AURClient::onSearchReply(QNetworkReply* reply) {
-    setLoading(false);
     reply->deleteLater();
+    if (reply->error() == QNetworkReply::OperationCanceledError) return;  // superseded
+    
+    if (reply == m_searchReply) {
+        m_searchReply = nullptr;
+    }
+    setLoading(false);
     
     if (reply->error() != QNetworkReply::NoError) {
         setError(reply->errorString());
@@ -4,6 +4,7 @@
 #include <QObject>
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
+#include <QPointer>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
@@ -51,6 +52,10 @@ public:
     void searchByMaintainer(const QString& maintainer);
     void searchByName(const QString& name);
     
+    // Aborts the running search, if any. A new search does this itself, so
+    // only the latest one ever emits searchCompleted or error.
+    void cancelSearch();
+    
     // Get package info
     void getPackageInfo(const QString& packageName);
     void getPackageInfo(const QStringList& packageNames);
@@ -80,8 +85,10 @@ private:
     AURPackage parsePackage(const QJsonObject& obj);
     void setLoading(bool loading);
     void setError(const QString& error);
+    void startSearch(const QUrl& url);
     
     QNetworkAccessManager* m_networkManager;
+    QPointer<QNetworkReply> m_searchReply;
     bool m_loading = false;
     QString m_lastError;
     
@@ -0,0 +1,79 @@
+#include "BKTree.h"
+#include <algorithm>
+
+int BKTree::distance(QByteArrayView a, QByteArrayView b) {
+    if (a.size() < b.size()) std::swap(a, b);
+    
+    // Single row of the DP matrix over the shorter string
+    QVector<int> row(b.size() + 1);
+    for (int j = 0; j <= b.size(); ++j) {
+        row[j] = j;
+    }
+    for (qsizetype i = 1; i <= a.size(); ++i) {
+        int diagonal = row[0];
+        row[0] = int(i);
+        for (qsizetype j = 1; j <= b.size(); ++j) {
+            const int above = row[j];
+            row[j] = std::min({above + 1, row[j - 1] + 1, diagonal + (a[i - 1] == b[j - 1] ? 0 : 1)});
+            diagonal = above;
+        }
+    }
+    return row[b.size()];
+}
+
+void BKTree::insert(const QByteArray& word, int value) {
+    if (m_nodes.isEmpty()) {
+        m_nodes.append({word, {value}, {}});
+        return;
+    }
+    
+    int node = 0;
+    for (;;) {
+        const int d = distance(word, m_nodes[node].word);
+        if (d == 0) {
+            m_nodes[node].values.append(value);
+            return;
+        }
+    
+        int child = -1;
+        for (const auto& edge : m_nodes[node].children) {
+            if (edge.first == d) {
+                child = edge.second;
+                break;
+            }
+        }
+        if (child < 0) {
+            m_nodes[node].children.append(qMakePair(d, int(m_nodes.size())));
+            m_nodes.append({word, {value}, {}});
+            return;
+        }
+        node = child;
+    }
+}
+
+void BKTree::clear() {
+    m_nodes.clear();
+}
+
+QVector<QPair<int, int>> BKTree::find(QByteArrayView word, int maxDistance) const {
+    QVector<QPair<int, int>> result;
+    if (m_nodes.isEmpty()) return result;
+    
+    QVector<int> pending{0};
+    while (!pending.isEmpty()) {
+        const Node& node = m_nodes[pending.takeLast()];
+        const int d = distance(word, node.word);
+        if (d <= maxDistance) {
+            for (int value : node.values) {
+                result.append(qMakePair(value, d));
+            }
+        }
+        // Triangle inequality: only edges in [d - max, d + max] can lead to a match
+        for (const auto& edge : node.children) {
+            if (edge.first >= d - maxDistance && edge.first <= d + maxDistance) {
+                pending.append(edge.second);
+            }
+        }
+    }
+    return result;
+}
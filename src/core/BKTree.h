@@ -0,0 +1,37 @@
+#ifndef BKTREE_H
+#define BKTREE_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QPair>
+#include <QVector>
+
+// Burkhard-Keller tree over byte strings under Levenshtein distance, for
+// "did you mean" lookups. A query within distance k of the target only has
+// to visit children whose edge distance is within k of its distance to the
+// current node, so typo lookups touch a small part of the vocabulary.
+class BKTree {
+public:
+    // value is handed back by find(); a word may be inserted with several
+    void insert(const QByteArray& word, int value);
+    void clear();
+    
+    int size() const { return m_nodes.size(); }
+    bool isEmpty() const { return m_nodes.isEmpty(); }
+    
+    // (value, distance) for every word within maxDistance of word
+    QVector<QPair<int, int>> find(QByteArrayView word, int maxDistance) const;
+    
+    static int distance(QByteArrayView a, QByteArrayView b);
+
+private:
+    struct Node {
+        QByteArray word;
+        QVector<int> values;
+        QVector<QPair<int, int>> children;  // (edge distance, node index)
+    };
+    
+    QVector<Node> m_nodes;  // m_nodes[0] is the root
+};
+
+#endif // BKTREE_H
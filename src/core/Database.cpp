@@ -8,6 +8,8 @@
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QFile>
+#include <QSet>
+#include <algorithm>
 
 Database::Database(QObject* parent)
     : QObject(parent)
@@ -40,7 +42,7 @@ bool Database::initialize(const QString& path) {
         return false;
     }
     
-    if (!createTables()) {
+    if (!createTables() || !loadUserData()) {
         return false;
     }
     
@@ -98,6 +100,65 @@ bool Database::createTables() {
     return true;
 }
 
+bool Database::loadUserData() {
+    m_userData.clear();
+    
+    QSqlQuery query(m_db);
+    query.setForwardOnly(true);
+    if (!query.exec("SELECT package_name, notes, tags, marked_keep, marked_review, last_viewed FROM package_user_data")) {
+        setError(QString("Failed to read user data: %1").arg(query.lastError().text()));
+        return false;
+    }
+    
+    while (query.next()) {
+        PackageUserData data;
+        data.packageName = query.value(0).toString();
+        data.notes = query.value(1).toString();
+        QString tagsStr = query.value(2).toString();
+        data.tags = tagsStr.isEmpty() ? QStringList() : tagsStr.split(",");
+        data.markedKeep = query.value(3).toInt() != 0;
+        data.markedReview = query.value(4).toInt() != 0;
+        data.lastViewed = QDateTime::fromString(query.value(5).toString(), Qt::ISODate);
+        m_userData.insert(data.packageName, data);
+    }
+    
+    return true;
+}
+
+void Database::beginBatch() {
+    if (m_initialized && m_batchDepth++ == 0) {
+        m_db.transaction();
+    }
+}
+
+bool Database::commitBatch() {
+    if (!m_initialized || m_batchDepth == 0 || --m_batchDepth > 0) return true;
+    
+    bool ok = m_db.commit();
+    if (!ok) {
+        setError(QString("Failed to commit user data: %1").arg(m_db.lastError().text()));
+        // Back to what is actually stored
+        m_db.rollback();
+        loadUserData();
+    }
+    
+    QStringList changed;
+    changed.swap(m_pendingChanges);
+    changed.removeDuplicates();
+    if (!changed.isEmpty()) {
+        emit userDataChanged(changed);
+    }
+    return ok;
+}
+
+void Database::notifyChanged(const QString& packageName) {
+    if (m_batchDepth > 0) {
+        m_pendingChanges.append(packageName);
+    } else {
+        emit userDataChanged({packageName});
+    }
+}
+
 bool Database::savePackageUserData(const PackageUserData& data) {
     if (!m_initialized) return false;
     
@@ -120,52 +181,43 @@ bool Database::savePackageUserData(const PackageUserData& data) {
         return false;
     }
     
-    emit dataChanged(data.packageName);
+    m_userData.insert(data.packageName, data);
+    notifyChanged(data.packageName);
     return true;
 }
 
-PackageUserData Database::getPackageUserData(const QString& packageName) {
-    PackageUserData data;
-    data.packageName = packageName;
-    
-    if (!m_initialized) return data;
+bool Database::writeColumn(const QString& packageName, const QString& column, const QVariant& value) {
+    if (!m_initialized) return false;
     
+    // Creates the row if needed and otherwise leaves the other columns alone
     QSqlQuery query(m_db);
-    query.prepare("SELECT notes, tags, marked_keep, marked_review, last_viewed FROM package_user_data WHERE package_name = ?");
+    query.prepare(QString(R"(
+        INSERT INTO package_user_data (package_name, %1) VALUES (?, ?)
+        ON CONFLICT(package_name) DO UPDATE SET %1 = excluded.%1
+    )").arg(column));
     query.addBindValue(packageName);
+    query.addBindValue(value);
     
-    if (query.exec() && query.next()) {
-        data.notes = query.value(0).toString();
-        QString tagsStr = query.value(1).toString();
-        data.tags = tagsStr.isEmpty() ? QStringList() : tagsStr.split(",");
-        data.markedKeep = query.value(2).toInt() != 0;
-        data.markedReview = query.value(3).toInt() != 0;
-        data.lastViewed = QDateTime::fromString(query.value(4).toString(), Qt::ISODate);
+    if (!query.exec()) {
+        setError(QString("Failed to save %1: %2").arg(column, query.lastError().text()));
+        return false;
+    }
+    return true;
+}
+
+PackageUserData Database::getPackageUserData(const QString& packageName) {
+    auto it = m_userData.constFind(packageName);
+    if (it != m_userData.constEnd()) {
+        return *it;
     }
     
+    PackageUserData data;
+    data.packageName = packageName;
     return data;
 }
 
 QList<PackageUserData> Database::getAllUserData() {
-    QList<PackageUserData> list;
-    if (!m_initialized) return list;
-    
-    QSqlQuery query(m_db);
-    query.exec("SELECT package_name, notes, tags, marked_keep, marked_review, last_viewed FROM package_user_data");
-    
-    while (query.next()) {
-        PackageUserData data;
-        data.packageName = query.value(0).toString();
-        data.notes = query.value(1).toString();
-        QString tagsStr = query.value(2).toString();
-        data.tags = tagsStr.isEmpty() ? QStringList() : tagsStr.split(",");
-        data.markedKeep = query.value(3).toInt() != 0;
-        data.markedReview = query.value(4).toInt() != 0;
-        data.lastViewed = QDateTime::fromString(query.value(5).toString(), Qt::ISODate);
-        list.append(data);
-    }
-    
-    return list;
+    return m_userData.values();
 }
 
 bool Database::deletePackageUserData(const QString& packageName) {
@@ -180,127 +232,127 @@ bool Database::deletePackageUserData(const QString& packageName) {
         return false;
     }
     
-    emit dataChanged(packageName);
+    m_userData.remove(packageName);
+    notifyChanged(packageName);
     return true;
 }
 
 bool Database::setPackageNotes(const QString& packageName, const QString& notes) {
-    PackageUserData data = getPackageUserData(packageName);
+    if (getPackageNotes(packageName) == notes) return m_initialized;
+    if (!writeColumn(packageName, "notes", notes)) return false;
+    
+    PackageUserData& data = m_userData[packageName];
+    data.packageName = packageName;
     data.notes = notes;
-    return savePackageUserData(data);
+    notifyChanged(packageName);
+    return true;
 }
 
 QString Database::getPackageNotes(const QString& packageName) {
-    return getPackageUserData(packageName).notes;
+    return m_userData.value(packageName).notes;
 }
 
 bool Database::setPackageTags(const QString& packageName, const QStringList& tags) {
-    PackageUserData data = getPackageUserData(packageName);
+    if (getPackageTags(packageName) == tags) return m_initialized;
+    if (!writeColumn(packageName, "tags", tags.join(","))) return false;
+    
+    PackageUserData& data = m_userData[packageName];
+    data.packageName = packageName;
     data.tags = tags;
-    return savePackageUserData(data);
+    notifyChanged(packageName);
+    return true;
 }
 
 QStringList Database::getPackageTags(const QString& packageName) {
-    return getPackageUserData(packageName).tags;
+    return m_userData.value(packageName).tags;
 }
 
 bool Database::addPackageTag(const QString& packageName, const QString& tag) {
-    PackageUserData data = getPackageUserData(packageName);
-    if (!data.tags.contains(tag)) {
-        data.tags.append(tag);
-        return savePackageUserData(data);
-    }
-    return true;
+    QStringList tags = getPackageTags(packageName);
+    if (tags.contains(tag)) return true;
+    
+    tags.append(tag);
+    return setPackageTags(packageName, tags);
 }
 
 bool Database::removePackageTag(const QString& packageName, const QString& tag) {
-    PackageUserData data = getPackageUserData(packageName);
-    data.tags.removeAll(tag);
-    return savePackageUserData(data);
+    QStringList tags = getPackageTags(packageName);
+    if (tags.removeAll(tag) == 0) return true;
+    
+    return setPackageTags(packageName, tags);
 }
 
 bool Database::setPackageKeep(const QString& packageName, bool keep) {
-    PackageUserData data = getPackageUserData(packageName);
+    if (isPackageMarkedKeep(packageName) == keep) return m_initialized;
+    if (!writeColumn(packageName, "marked_keep", keep ? 1 : 0)) return false;
+    
+    PackageUserData& data = m_userData[packageName];
+    data.packageName = packageName;
     data.markedKeep = keep;
-    return savePackageUserData(data);
+    notifyChanged(packageName);
+    return true;
 }
 
 bool Database::isPackageMarkedKeep(const QString& packageName) {
-    return getPackageUserData(packageName).markedKeep;
+    return m_userData.value(packageName).markedKeep;
 }
 
 bool Database::setPackageReview(const QString& packageName, bool review) {
-    PackageUserData data = getPackageUserData(packageName);
+    if (isPackageMarkedReview(packageName) == review) return m_initialized;
+    if (!writeColumn(packageName, "marked_review", review ? 1 : 0)) return false;
+    
+    PackageUserData& data = m_userData[packageName];
+    data.packageName = packageName;
     data.markedReview = review;
-    return savePackageUserData(data);
+    notifyChanged(packageName);
+    return true;
 }
 
 bool Database::isPackageMarkedReview(const QString& packageName) {
-    return getPackageUserData(packageName).markedReview;
+    return m_userData.value(packageName).markedReview;
 }
 
 QStringList Database::getAllTags() {
-    QStringList tags;
-    if (!m_initialized) return tags;
-    
-    QSqlQuery query(m_db);
-    query.exec("SELECT DISTINCT tags FROM package_user_data WHERE tags != ''");
-    
     QSet<QString> uniqueTags;
-    while (query.next()) {
-        QStringList pkgTags = query.value(0).toString().split(",");
-        for (const QString& tag : pkgTags) {
+    for (const PackageUserData& data : std::as_const(m_userData)) {
+        for (const QString& tag : data.tags) {
             if (!tag.isEmpty()) {
                 uniqueTags.insert(tag);
             }
         }
     }
     
-    tags = uniqueTags.values();
+    QStringList tags = uniqueTags.values();
     tags.sort();
     return tags;
 }
 
 QStringList Database::getPackagesWithTag(const QString& tag) {
     QStringList packages;
-    if (!m_initialized) return packages;
-    
-    QSqlQuery query(m_db);
-    query.prepare("SELECT package_name, tags FROM package_user_data WHERE tags LIKE ?");
-    query.addBindValue("%" + tag + "%");
-    
-    while (query.exec() && query.next()) {
-        QStringList tags = query.value(1).toString().split(",");
-        if (tags.contains(tag)) {
-            packages.append(query.value(0).toString());
+    for (const PackageUserData& data : std::as_const(m_userData)) {
+        if (data.tags.contains(tag)) {
+            packages.append(data.packageName);
         }
     }
-    
     return packages;
 }
 
 int Database::countPackagesWithNotes() {
-    if (!m_initialized) return 0;
-    
-    QSqlQuery query(m_db);
-    query.exec("SELECT COUNT(*) FROM package_user_data WHERE notes != ''");
-    return query.next() ? query.value(0).toInt() : 0;
+    return std::count_if(m_userData.cbegin(), m_userData.cend(), [](const PackageUserData& data) {
+        return !data.notes.isEmpty();
+    });
 }
 
 int Database::countPackagesMarkedKeep() {
-    if (!m_initialized) return 0;
-    
-    QSqlQuery query(m_db);
-    query.exec("SELECT COUNT(*) FROM package_user_data WHERE marked_keep = 1");
-    return query.next() ? query.value(0).toInt() : 0;
+    return std::count_if(m_userData.cbegin(), m_userData.cend(), [](const PackageUserData& data) {
+        return data.markedKeep;
+    });
 }
 
 int Database::countPackagesMarkedReview() {
-    if (!m_initialized) return 0;
-    
-    QSqlQuery query(m_db);
-    query.exec("SELECT COUNT(*) FROM package_user_data WHERE marked_review = 1");
-    return query.next() ? query.value(0).toInt() : 0;
+    return std::count_if(m_userData.cbegin(), m_userData.cend(), [](const PackageUserData& data) {
+        return data.markedReview;
+    });
 }
 
 bool Database::exportToJson(const QString& filePath) {
@@ -351,6 +403,7 @@ bool Database::importFromJson(const QString& filePath) {
     }
     
     QJsonArray array = doc.array();
+    beginBatch();
     for (const QJsonValue& val : array) {
         QJsonObject obj = val.toObject();
         
@@ -370,7 +423,7 @@ bool Database::importFromJson(const QString& filePath) {
         savePackageUserData(data);
     }
     
-    return true;
+    return commitBatch();
 }
 
 void Database::setError(const QString& error) {
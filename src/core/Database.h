@@ -5,6 +5,7 @@
 #include <QString>
 #include <QStringList>
 #include <QSqlDatabase>
+#include <QHash>
 #include <QMap>
 #include "models/Package.h"
 
@@ -17,6 +18,12 @@ struct PackageUserData {
     QDateTime lastViewed;
 };
 
+// Notes, tags and marks per package, in SQLite.
+//
+// Every row is read into memory once by initialize() and all reads are
+// served from there. Writes change only the column they're about (an
+// upsert per call, one transaction per batch), update the in-memory copy
+// and announce the packages through userDataChanged.
 class Database : public QObject {
     Q_OBJECT
     
@@ -27,6 +34,12 @@ public:
     bool initialize(const QString& path = QString());
     bool isInitialized() const { return m_initialized; }
     QString lastError() const { return m_lastError; }
+    QString path() const { return m_dbPath; }
+    
+    // Writes between these share one transaction, and userDataChanged is
+    // emitted once for all of them at the end. Batches nest.
+    void beginBatch();
+    bool commitBatch();
     
     // User data operations
     bool savePackageUserData(const PackageUserData& data);
@@ -63,13 +76,19 @@ public:
     bool importFromJson(const QString& filePath);
     
 signals:
-    void dataChanged(const QString& packageName);
+    void userDataChanged(const QStringList& packageNames);
     
 private:
     bool createTables();
+    bool loadUserData();
+    bool writeColumn(const QString& packageName, const QString& column, const QVariant& value);
+    void notifyChanged(const QString& packageName);
     void setError(const QString& error);
     
     QSqlDatabase m_db;
+    QHash<QString, PackageUserData> m_userData;  // every stored row, by package
+    int m_batchDepth = 0;
+    QStringList m_pendingChanges;               // packages written in the open batch
     bool m_initialized = false;
     QString m_lastError;
     QString m_dbPath;
@@ -0,0 +1,105 @@
+#include "DependencyGraph.h"
+#include "ReverseDependencyIndex.h"
+
+void DependencyGraph::build(const ReverseDependencyIndex& index) {
+    // Implicitly shared with the index, no copy
+    m_reverse.offsets = index.m_requiredBy.offsets;
+    m_reverse.items = index.m_requiredBy.items;
+    const int count = m_reverse.offsets.isEmpty() ? 0 : m_reverse.offsets.size() - 1;
+    
+    // Transpose. Providers are visited in id order, so every forward list
+    // comes out sorted.
+    m_forward.offsets = QVector<int>(count + 1, 0);
+    for (PackageId dependant : m_reverse.items) {
+        ++m_forward.offsets[dependant + 1];
+    }
+    for (int i = 0; i < count; ++i) {
+        m_forward.offsets[i + 1] += m_forward.offsets[i];
+    }
+    
+    m_forward.items = QVector<PackageId>(m_reverse.items.size());
+    QVector<int> cursor = m_forward.offsets;
+    for (PackageId provider = 0; provider < count; ++provider) {
+        for (PackageId dependant : slice(m_reverse, provider)) {
+            m_forward.items[cursor[dependant]++] = provider;
+        }
+    }
+}
+
+void DependencyGraph::clear() {
+    m_forward = Adjacency();
+    m_reverse = Adjacency();
+}
+
+QBitArray DependencyGraph::closure(const QVector<PackageId>& roots, Direction direction) const {
+    const Adjacency& adj = adjacency(direction);
+    QBitArray visited(size());
+    QVector<PackageId> stack;
+    
+    for (PackageId root : roots) {
+        if (root >= 0 && root < size() && !visited.testBit(root)) {
+            visited.setBit(root);
+            stack.append(root);
+        }
+    }
+    
+    while (!stack.isEmpty()) {
+        PackageId id = stack.takeLast();
+        for (PackageId next : slice(adj, id)) {
+            if (!visited.testBit(next)) {
+                visited.setBit(next);
+                stack.append(next);
+            }
+        }
+    }
+    return visited;
+}
+
+QVector<PackageId> DependencyGraph::traverse(PackageId root, Direction direction, int maxDepth,
+                                             QVector<int>* depths) const {
+    QVector<PackageId> order;
+    QVector<int> level;
+    if (root < 0 || root >= size()) {
+        if (depths) depths->clear();
+        return order;
+    }
+    
+    const Adjacency& adj = adjacency(direction);
+    QBitArray visited(size());
+    visited.setBit(root);
+    order.append(root);
+    level.append(0);
+    
+    // order doubles as the BFS queue
+    for (qsizetype i = 0; i < order.size(); ++i) {
+        if (level[i] >= maxDepth) continue;
+        const int nextLevel = level[i] + 1;
+        for (PackageId next : slice(adj, order[i])) {
+            if (visited.testBit(next)) continue;
+            visited.setBit(next);
+            order.append(next);
+            level.append(nextLevel);
+        }
+    }
+    
+    if (depths) *depths = level;
+    return order;
+}
+
+QVector<PackageId> DependencyGraph::toIds(const QBitArray& set) {
+    QVector<PackageId> ids;
+    const uchar* bytes = reinterpret_cast<const uchar*>(set.bits());
+    const qsizetype byteCount = (set.size() + 7) / 8;
+    
+    // Skip empty bytes; closures are usually sparse
+    for (qsizetype byte = 0; byte < byteCount; ++byte) {
+        if (!bytes[byte]) continue;
+        for (int bit = 0; bit < 8; ++bit) {
+            PackageId id = static_cast<PackageId>(byte * 8 + bit);
+            if ((bytes[byte] & (1 << bit)) && id < set.size()) {
+                ids.append(id);
+            }
+        }
+    }
+    return ids;
+}
@@ -0,0 +1,77 @@
+#ifndef DEPENDENCYGRAPH_H
+#define DEPENDENCYGRAPH_H
+
+#include <QBitArray>
+#include <QVector>
+#include "models/Package.h"
+
+class ReverseDependencyIndex;
+
+// Hard dependency graph of the local database over package ids.
+//
+// Edges are the ones ReverseDependencyIndex resolved against names and
+// provides (so "sh" lands on bash), kept CSR style in both directions.
+// Closures use a worklist and a visited bitset, so a query touches every
+// reachable package and edge once and allocates two arrays.
+class DependencyGraph {
+public:
+    enum Direction {
+        Dependencies,  // what a package pulls in
+        Dependants     // what requires a package
+    };
+    
+    // A run of ids inside one of the adjacency arrays
+    struct Neighbours {
+        const PackageId* first = nullptr;
+        const PackageId* last = nullptr;
+        const PackageId* begin() const { return first; }
+        const PackageId* end() const { return last; }
+        int size() const { return static_cast<int>(last - first); }
+        bool isEmpty() const { return first == last; }
+    };
+    
+    // Shares the index's reverse edges and builds the forward ones from them
+    void build(const ReverseDependencyIndex& index);
+    void clear();
+    
+    int size() const { return m_forward.offsets.isEmpty() ? 0 : m_forward.offsets.size() - 1; }
+    
+    Neighbours dependencies(PackageId id) const { return slice(m_forward, id); }
+    Neighbours dependants(PackageId id) const { return slice(m_reverse, id); }
+    Neighbours neighbours(PackageId id, Direction direction) const { return slice(adjacency(direction), id); }
+    
+    // Everything reachable from roots, roots included, as a bitset over ids
+    QBitArray closure(const QVector<PackageId>& roots, Direction direction) const;
+    QBitArray closure(PackageId root, Direction direction) const {
+        return closure(QVector<PackageId>{root}, direction);
+    }
+    
+    // Breadth-first from root (depth 0) up to maxDepth edges away. depths,
+    // if given, receives the distance of each returned package.
+    QVector<PackageId> traverse(PackageId root, Direction direction, int maxDepth,
+                                QVector<int>* depths = nullptr) const;
+    
+    // Set bits in ascending order
+    static QVector<PackageId> toIds(const QBitArray& set);
+
+private:
+    // Neighbours of package i are items[offsets[i] .. offsets[i + 1])
+    struct Adjacency {
+        QVector<int> offsets;
+        QVector<PackageId> items;
+    };
+    
+    const Adjacency& adjacency(Direction direction) const {
+        return direction == Dependencies ? m_forward : m_reverse;
+    }
+    static Neighbours slice(const Adjacency& adj, PackageId id) {
+        if (id < 0 || id + 1 >= adj.offsets.size()) return Neighbours();
+        const PackageId* base = adj.items.constData();
+        return {base + adj.offsets[id], base + adj.offsets[id + 1]};
+    }
+    
+    Adjacency m_forward;  // package -> providers of its depends
+    Adjacency m_reverse;  // package -> packages that depend on it
+};
+
+#endif // DEPENDENCYGRAPH_H
@@ -0,0 +1,98 @@
+#include "DominatorTree.h"
+#include "PackageStore.h"
+#include <QPair>
+
+void DominatorTree::build(const PackageStore& store) {
+    clear();
+    const DependencyGraph& graph = store.graph();
+    const int count = graph.size();
+    const int root = count;  // virtual node above the entry points
+
+    // Entry points: explicit packages and anything nothing depends on
+    QVector<bool> isEntry(count);
+    QVector<PackageId> entries;
+    for (PackageId id = 0; id < count; ++id) {
+        isEntry[id] = store.isExplicit(id) || graph.dependants(id).isEmpty();
+        if (isEntry[id]) {
+            entries.append(id);
+        }
+    }
+    const DependencyGraph::Neighbours rootChildren = {entries.constData(), entries.constData() + entries.size()};
+
+    // Iterative DFS for a postorder numbering; a dominator always finishes
+    // after the packages it dominates
+    QVector<int> postorder(count + 1, -1);
+    QVector<int> order;  // nodes in postorder
+    order.reserve(count + 1);
+    {
+        QVector<bool> visited(count + 1);
+        QVector<QPair<int, int>> stack;  // (node, next child)
+        visited[root] = true;
+        stack.append(qMakePair(root, 0));
+        while (!stack.isEmpty()) {
+            const int node = stack.last().first;
+            const DependencyGraph::Neighbours children = node == root ? rootChildren : graph.dependencies(node);
+            if (stack.last().second < children.size()) {
+                const int child = children.first[stack.last().second++];
+                if (!visited[child]) {
+                    visited[child] = true;
+                    stack.append(qMakePair(child, 0));
+                }
+            } else {
+                postorder[node] = order.size();
+                order.append(node);
+                stack.removeLast();
+            }
+        }
+    }
+
+    QVector<int> idom(count + 1, -1);
+    idom[root] = root;
+    auto intersect = [&](int a, int b) {
+        while (a != b) {
+            while (postorder[a] < postorder[b]) a = idom[a];
+            while (postorder[b] < postorder[a]) b = idom[b];
+        }
+        return a;
+    };
+
+    // Reverse postorder, root (last) excluded, until nothing changes
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int i = order.size() - 2; i >= 0; --i) {
+            const int node = order[i];
+            int dominator = isEntry[node] ? root : -1;
+            for (PackageId pred : graph.dependants(node)) {
+                if (idom[pred] < 0) continue;  // not reached yet, or unreachable
+                dominator = dominator < 0 ? pred : intersect(pred, dominator);
+            }
+            if (dominator != idom[node]) {
+                idom[node] = dominator;
+                changed = true;
+            }
+        }
+    }
+
+    m_idom.resize(count);
+    m_exclusiveSize.resize(count);
+    for (PackageId id = 0; id < count; ++id) {
+        m_idom[id] = idom[id] == root ? -1 : idom[id];
+        m_exclusiveSize[id] = store.installedSize(id);
+    }
+
+    // Postorder hands every subtree total to its dominator before the
+    // dominator passes its own on
+    for (int node : order) {
+        if (node == root) continue;
+        const int dominator = idom[node];
+        if (dominator >= 0 && dominator != root) {
+            m_exclusiveSize[dominator] += m_exclusiveSize[node];
+        }
+    }
+}
+
+void DominatorTree::clear() {
+    m_idom.clear();
+    m_exclusiveSize.clear();
+}
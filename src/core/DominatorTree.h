@@ -0,0 +1,33 @@
+#ifndef DOMINATORTREE_H
+#define DOMINATORTREE_H
+
+#include <QVector>
+#include "models/Package.h"
+
+class PackageStore;
+
+// Dominator tree of the hard dependency graph, answering "how much would
+// removing this package really free".
+//
+// A virtual root sits above every package nothing depends on, plus every
+// explicitly installed one. Package p dominates d if every dependency chain
+// from the root down to d passes through p, i.e. d is only installed
+// because of p. A package's exclusive size is its own installed size plus
+// that of everything it dominates; shared dependencies are attributed to
+// nobody. Built with the Cooper-Harvey-Kennedy iterative algorithm, which
+// converges in a couple of passes on dependency graphs.
+class DominatorTree {
+public:
+    void build(const PackageStore& store);
+    void clear();
+
+    // -1 for packages hanging directly off the root and for unreachable ones
+    PackageId immediateDominator(PackageId id) const { return m_idom.value(id, -1); }
+    qint64 exclusiveSize(PackageId id) const { return m_exclusiveSize.value(id, 0); }
+
+private:
+    QVector<PackageId> m_idom;
+    QVector<qint64> m_exclusiveSize;
+};
+
+#endif // DOMINATORTREE_H
@@ -0,0 +1,307 @@
+#include "FileOwnerIndex.h"
+#include <QPair>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+void putVarint(QByteArray& out, quint32 value) {
+    while (value >= 0x80) {
+        out.append(char(value | 0x80));
+        value >>= 7;
+    }
+    out.append(char(value));
+}
+
+quint32 getVarint(const char* data, int& pos) {
+    quint32 value = 0;
+    for (int shift = 0;; shift += 7) {
+        uchar byte = uchar(data[pos++]);
+        value |= quint32(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return value;
+    }
+}
+
+// Plain byte order, which is what pacman sorts file lists by
+int comparePaths(QByteArrayView a, QByteArrayView b) {
+    const qsizetype common = qMin(a.size(), b.size());
+    int c = common ? std::memcmp(a.data(), b.data(), common) : 0;
+    if (c != 0) return c;
+    return a.size() < b.size() ? -1 : (a.size() > b.size() ? 1 : 0);
+}
+
+int sharedPrefix(QByteArrayView a, QByteArrayView b) {
+    const qsizetype common = qMin(a.size(), b.size());
+    qsizetype n = 0;
+    while (n < common && a[n] == b[n]) {
+        ++n;
+    }
+    return static_cast<int>(n);
+}
+
+} // namespace
+
+void FileOwnerIndex::Builder::reserve(int entries, qint64 bytes) {
+    m_entries.reserve(entries);
+    m_arena.reserve(bytes);
+}
+
+void FileOwnerIndex::Builder::add(QByteArrayView path, PackageId owner) {
+    while (path.startsWith('/')) {
+        path = path.sliced(1);
+    }
+    if (path.isEmpty() || owner < 0) return;
+
+    m_entries.append({quint32(m_arena.size()), quint32(path.size()), owner});
+    m_arena.append(path.data(), path.size());
+}
+
+void FileOwnerIndex::Builder::merge(Builder&& other, PackageId ownerOffset) {
+    const quint32 base = quint32(m_arena.size());
+    m_arena.append(other.m_arena);
+    m_entries.reserve(m_entries.size() + other.m_entries.size());
+    for (const Entry& entry : other.m_entries) {
+        m_entries.append({entry.offset + base, entry.length, entry.owner + ownerOffset});
+    }
+    other.m_arena.clear();
+    other.m_entries.clear();
+}
+
+FileOwnerIndex FileOwnerIndex::Builder::build(quint64 generation) {
+    const char* arena = m_arena.constData();
+    auto pathOf = [arena](const Entry& e) { return QByteArrayView(arena + e.offset, e.length); };
+
+    std::sort(m_entries.begin(), m_entries.end(), [&pathOf](const Entry& a, const Entry& b) {
+        int c = comparePaths(pathOf(a), pathOf(b));
+        return c != 0 ? c < 0 : a.owner < b.owner;
+    });
+
+    FileOwnerIndex index;
+    index.m_generation = generation;
+    QVector<PackageId> owners;
+    QVector<quint32> blockOffsets;
+    owners.reserve(m_entries.size());
+    blockOffsets.reserve(m_entries.size() / BlockSize + 1);
+
+    QByteArrayView previous;
+    int count = 0;
+    for (const Entry& entry : m_entries) {
+        QByteArrayView path = pathOf(entry);
+        if (count > 0 && comparePaths(path, previous) == 0 && entry.owner == owners.last()) {
+            continue;  // listed twice
+        }
+
+        if (count % BlockSize == 0) {
+            blockOffsets.append(index.m_data.size());
+            putVarint(index.m_data, path.size());
+            index.m_data.append(path.data(), path.size());
+        } else {
+            int shared = sharedPrefix(previous, path);
+            putVarint(index.m_data, shared);
+            putVarint(index.m_data, path.size() - shared);
+            index.m_data.append(path.data() + shared, path.size() - shared);
+        }
+        owners.append(entry.owner);
+        previous = path;
+        ++count;
+    }
+
+    index.m_data.squeeze();
+    index.m_blockOffsets = QByteArray(reinterpret_cast<const char*>(blockOffsets.constData()),
+                                      blockOffsets.size() * qsizetype(sizeof(quint32)));
+    index.m_owners = QByteArray(reinterpret_cast<const char*>(owners.constData()),
+                                owners.size() * qsizetype(sizeof(PackageId)));
+    m_entries.clear();
+    m_arena.clear();
+    return index;
+}
+
+qint64 FileOwnerIndex::memoryUsage() const {
+    return m_data.capacity() + m_blockOffsets.capacity() + m_owners.capacity();
+}
+
+FileOwnerIndex FileOwnerIndex::fromRawData(quint64 generation, const QByteArray& data,
+                                           const QByteArray& blockOffsets, const QByteArray& owners) {
+    FileOwnerIndex index;
+    if (owners.size() % qsizetype(sizeof(PackageId)) != 0 || blockOffsets.size() % qsizetype(sizeof(quint32)) != 0) {
+        return index;
+    }
+    index.m_data = data;
+    index.m_blockOffsets = blockOffsets;
+    index.m_owners = owners;
+
+    // One block head per BlockSize entries, each inside the data
+    const int blocks = index.blockCount();
+    bool valid = blocks == (index.size() + BlockSize - 1) / BlockSize;
+    for (int block = 0; valid && block < blocks; ++block) {
+        valid = index.blockOffset(block) < quint32(data.size())
+                && (block == 0 || index.blockOffset(block) > index.blockOffset(block - 1));
+    }
+    if (!valid) return FileOwnerIndex();
+    index.m_generation = generation;
+    return index;
+}
+
+QByteArray FileOwnerIndex::path(int entry) const {
+    Cursor cursor;
+    load(cursor, entry - entry % BlockSize);
+    while (cursor.index < entry) {
+        next(cursor);
+    }
+    return cursor.path;
+}
+
+QByteArray FileOwnerIndex::normalize(const QString& path) {
+    QByteArray key = path.toUtf8();
+    qsizetype slashes = 0;
+    while (slashes < key.size() && key[slashes] == '/') {
+        ++slashes;
+    }
+    return key.mid(slashes);
+}
+
+QByteArrayView FileOwnerIndex::blockHead(int block) const {
+    int pos = blockOffset(block);
+    int length = getVarint(m_data.constData(), pos);
+    return QByteArrayView(m_data.constData() + pos, length);
+}
+
+int FileOwnerIndex::findBlock(QByteArrayView key, int firstBlock) const {
+    int lo = firstBlock;
+    int hi = blockCount() - 1;
+    int found = firstBlock;
+    while (lo <= hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (comparePaths(blockHead(mid), key) <= 0) {
+            found = mid;
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return found;
+}
+
+void FileOwnerIndex::load(Cursor& cursor, int index) const {
+    int pos = blockOffset(index / BlockSize);
+    int length = getVarint(m_data.constData(), pos);
+    cursor.index = index;
+    cursor.path = QByteArray(m_data.constData() + pos, length);
+    cursor.pos = pos + length;
+}
+
+bool FileOwnerIndex::next(Cursor& cursor) const {
+    int index = cursor.index + 1;
+    if (index >= size()) return false;
+    if (index % BlockSize == 0) {
+        load(cursor, index);
+        return true;
+    }
+
+    const char* data = m_data.constData();
+    int shared = getVarint(data, cursor.pos);
+    int suffix = getVarint(data, cursor.pos);
+    cursor.path.truncate(shared);
+    cursor.path.append(data + cursor.pos, suffix);
+    cursor.pos += suffix;
+    cursor.index = index;
+    return true;
+}
+
+bool FileOwnerIndex::seek(Cursor& cursor, QByteArrayView key, int firstBlock) const {
+    if (isEmpty() || firstBlock >= blockCount()) return false;
+
+    load(cursor, findBlock(key, firstBlock) * BlockSize);
+    // At most the rest of this block; the next head is already > key
+    while (comparePaths(cursor.path, key) < 0) {
+        if (!next(cursor)) return false;
+    }
+    return true;
+}
+
+PackageId FileOwnerIndex::exactOwner(QByteArrayView key, int* block) const {
+    Cursor cursor;
+    if (!seek(cursor, key, block ? *block : 0)) return -1;
+    if (block) *block = cursor.index / BlockSize;
+    return comparePaths(cursor.path, key) == 0 ? ownerAt(cursor.index) : -1;
+}
+
+PackageId FileOwnerIndex::owner(const QString& path) const {
+    QByteArray key = normalize(path);
+    if (key.isEmpty()) return -1;
+
+    PackageId id = exactOwner(key);
+    if (id < 0 && !key.endsWith('/')) {
+        id = exactOwner(key + '/');
+    }
+    return id;
+}
+
+QVector<PackageId> FileOwnerIndex::owners(const QString& path) const {
+    QVector<PackageId> result;
+    QByteArray key = normalize(path);
+    if (key.isEmpty()) return result;
+
+    for (int attempt = 0; attempt < 2 && result.isEmpty(); ++attempt) {
+        if (attempt == 1) {
+            if (key.endsWith('/')) break;
+            key += '/';  // a directory given without its slash
+        }
+        Cursor cursor;
+        if (!seek(cursor, key)) continue;
+        do {
+            if (comparePaths(cursor.path, key) != 0) break;
+            result.append(ownerAt(cursor.index));
+        } while (next(cursor));
+    }
+    return result;
+}
+
+QVector<PackageId> FileOwnerIndex::owners(const QStringList& paths) const {
+    QVector<PackageId> result(paths.size(), -1);
+
+    QVector<QPair<QByteArray, int>> queries;
+    queries.reserve(paths.size());
+    for (int i = 0; i < paths.size(); ++i) {
+        queries.append(qMakePair(normalize(paths[i]), i));
+    }
+    std::sort(queries.begin(), queries.end());
+
+    // Each query starts searching where the previous one landed
+    int block = 0;
+    for (const auto& query : queries) {
+        if (query.first.isEmpty()) continue;
+        PackageId id = exactOwner(query.first, &block);
+        if (id < 0 && !query.first.endsWith('/')) {
+            int dirBlock = block;
+            id = exactOwner(query.first + '/', &dirBlock);
+        }
+        result[query.second] = id;
+    }
+    return result;
+}
+
+void FileOwnerIndex::forEachUnder(const QString& directory, const Visitor& visit) const {
+    QByteArray prefix = normalize(directory);
+    if (!prefix.isEmpty() && !prefix.endsWith('/')) {
+        prefix += '/';
+    }
+
+    Cursor cursor;
+    if (!seek(cursor, prefix)) return;
+    do {
+        if (!cursor.path.startsWith(prefix)) break;
+        if (!visit(cursor.path, ownerAt(cursor.index))) break;
+    } while (next(cursor));
+}
+
+QVector<PackageId> FileOwnerIndex::ownersUnder(const QString& directory) const {
+    QVector<PackageId> result;
+    forEachUnder(directory, [&result](QByteArrayView, PackageId owner) {
+        result.append(owner);
+        return true;
+    });
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
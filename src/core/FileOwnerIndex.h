@@ -0,0 +1,108 @@
+#ifndef FILEOWNERINDEX_H
+#define FILEOWNERINDEX_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <functional>
+#include "models/Package.h"
+
+// Maps every installed path to the package that owns it.
+//
+// Paths are kept sorted and front-coded in blocks of BlockSize: the first
+// path of a block is stored whole, the rest as (shared prefix length,
+// suffix). With ~1M paths that share long directory prefixes this is a
+// fraction of the raw size, and lookups binary search the block heads and
+// then decode at most one block. Paths are stored the way pacman lists
+// them: no leading '/', directories end in '/'. A path owned by several
+// packages (shared directories) has one entry per owner. The encoded
+// arrays are plain bytes, so an index written to disk can be used straight
+// from a memory mapping (see fromRawData()).
+class FileOwnerIndex {
+public:
+    static constexpr int BlockSize = 16;
+    
+    // Collects (path, owner) pairs in any order; build() sorts and encodes
+    class Builder {
+    public:
+        void reserve(int entries, qint64 bytes);
+        void add(QByteArrayView path, PackageId owner);
+        // Moves everything collected by other in, shifting its owners by ownerOffset
+        void merge(Builder&& other, PackageId ownerOffset);
+        bool isEmpty() const { return m_entries.isEmpty(); }
+        FileOwnerIndex build(quint64 generation);
+    
+    private:
+        struct Entry {
+            quint32 offset;
+            quint32 length;
+            PackageId owner;
+        };
+        QByteArray m_arena;  // all paths back to back
+        QVector<Entry> m_entries;
+    };
+    
+    FileOwnerIndex() = default;
+    
+    quint64 generation() const { return m_generation; }
+    int size() const { return static_cast<int>(m_owners.size() / qsizetype(sizeof(PackageId))); }
+    bool isEmpty() const { return m_owners.isEmpty(); }
+    qint64 memoryUsage() const;
+    
+    // Encoded arrays, for writing the index out. fromRawData() takes them
+    // back without copying (QByteArray::fromRawData over a mapping that
+    // outlives the index); the result is empty if they don't fit together.
+    const QByteArray& rawData() const { return m_data; }
+    const QByteArray& rawBlockOffsets() const { return m_blockOffsets; }
+    const QByteArray& rawOwners() const { return m_owners; }
+    static FileOwnerIndex fromRawData(quint64 generation, const QByteArray& data,
+                                      const QByteArray& blockOffsets, const QByteArray& owners);
+    
+    // Entries in path order, by index
+    QByteArray path(int entry) const;  // without the leading '/'
+    PackageId ownerAt(int entry) const {
+        return reinterpret_cast<const PackageId*>(m_owners.constData())[entry];
+    }
+    
+    // Owner of a file or directory, -1 if none. Accepts paths with or
+    // without the leading '/' and directories with or without the trailing one.
+    PackageId owner(const QString& path) const;
+    QVector<PackageId> owners(const QString& path) const;  // every owner
+    
+    // owner() for many paths at once; sorted queries reuse the search range
+    QVector<PackageId> owners(const QStringList& paths) const;
+    
+    // Every entry below a directory, in path order. visit returns false to stop.
+    using Visitor = std::function<bool(QByteArrayView path, PackageId owner)>;
+    void forEachUnder(const QString& directory, const Visitor& visit) const;  // "" visits all
+    QVector<PackageId> ownersUnder(const QString& directory) const;  // distinct, ascending
+
+private:
+    // Sequential decoder positioned at one entry
+    struct Cursor {
+        int index = 0;       // entry index
+        int pos = 0;         // byte offset of the next entry in m_data
+        QByteArray path;     // decoded current path
+    };
+    
+    static QByteArray normalize(const QString& path);
+    int findBlock(QByteArrayView key, int firstBlock = 0) const;  // last block whose head <= key
+    bool seek(Cursor& cursor, QByteArrayView key, int firstBlock = 0) const;  // first entry >= key
+    void load(Cursor& cursor, int index) const;  // index must be a block head
+    bool next(Cursor& cursor) const;
+    QByteArrayView blockHead(int block) const;
+    int blockCount() const { return static_cast<int>(m_blockOffsets.size() / qsizetype(sizeof(quint32))); }
+    quint32 blockOffset(int block) const {
+        return reinterpret_cast<const quint32*>(m_blockOffsets.constData())[block];
+    }
+    PackageId exactOwner(QByteArrayView key, int* block = nullptr) const;
+    
+    quint64 m_generation = 0;
+    QByteArray m_data;           // encoded paths
+    QByteArray m_blockOffsets;   // quint32 start of each block in m_data
+    QByteArray m_owners;         // PackageId per entry
+};
+
+#endif // FILEOWNERINDEX_H
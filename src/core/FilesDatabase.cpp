@@ -0,0 +1,480 @@
+#include "FilesDatabase.h"
+#include "LocalDbReader.h"
+#include "utils/BlockFile.h"
+#include "utils/SubstringSearch.h"
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QtConcurrent>
+#include <algorithm>
+#include <archive.h>
+#include <archive_entry.h>
+#include <cstring>
+
+namespace {
+
+constexpr char Magic[8] = {'A', 'M', 'F', 'I', 'L', 'E', 'S', '\0'};
+constexpr quint32 FormatVersion = 1;
+constexpr quint32 ByteOrderMark = 0x01020304;
+constexpr size_t ReadBlockSize = 128 * 1024;
+
+struct Header {
+    char magic[8];
+    quint32 version;
+    quint32 byteOrder;
+    quint32 packageCount;
+    quint32 entryCount;
+};
+
+// FNV-1a; stored in the index, so it must not depend on the Qt version
+quint32 hashName(QByteArrayView name) {
+    quint32 hash = 2166136261u;
+    for (char c : name) {
+        hash = (hash ^ uchar(c)) * 16777619u;
+    }
+    return hash;
+}
+
+QByteArrayView baseName(QByteArrayView path) {
+    return path.sliced(path.lastIndexOf('/') + 1);
+}
+
+// One repository's .files db, read on its own thread
+struct RepoFiles {
+    QString path;
+    QVector<FilesDatabase::Package> packages;
+    FileOwnerIndex::Builder paths;  // owners index packages
+    QString error;
+};
+
+// Appends the "%FILES%" list of one package, skipping directories
+void addFileList(QByteArrayView list, PackageId owner, FileOwnerIndex::Builder& paths) {
+    bool inFiles = false;
+    const char* pos = list.data();
+    const char* end = pos + list.size();
+    while (pos < end) {
+        const char* eol = static_cast<const char*>(std::memchr(pos, '\n', end - pos));
+        if (!eol) eol = end;
+        QByteArrayView line(pos, eol - pos);
+        pos = eol + 1;
+
+        if (line.isEmpty()) {
+            inFiles = false;
+        } else if (line.front() == '%' && line.back() == '%') {
+            inFiles = line == "%FILES%";
+        } else if (inFiles && !line.endsWith('/')) {
+            paths.add(line, owner);
+        }
+    }
+}
+
+void readRepository(RepoFiles& repo) {
+    archive* reader = archive_read_new();
+    archive_read_support_filter_all(reader);
+    archive_read_support_format_all(reader);
+    if (archive_read_open_filename(reader, QFile::encodeName(repo.path).constData(), ReadBlockSize) != ARCHIVE_OK) {
+        repo.error = QString::fromUtf8(archive_error_string(reader));
+        archive_read_free(reader);
+        return;
+    }
+
+    const QString repository = QFileInfo(repo.path).completeBaseName();
+    QByteArray entryDir;
+    QByteArray desc;
+    QByteArray buffer;
+
+    // Files are added as they are read, owned by the package not yet
+    // appended; its name and version come from desc
+    auto flush = [&]() {
+        if (entryDir.isEmpty()) return;
+        PackageStore::Record record;
+        FilesDatabase::Package package;
+        package.repository = repository;
+        if (LocalDbReader::parseDesc(desc, record)) {
+            package.name = QString::fromUtf8(record.name);
+            package.version = QString::fromUtf8(record.version);
+        } else {
+            package.name = LocalDbReader::packageName(QString::fromUtf8(entryDir));
+        }
+        repo.packages.append(package);
+        desc.clear();
+    };
+
+    archive_entry* entry = nullptr;
+    int status = ARCHIVE_OK;
+    while ((status = archive_read_next_header(reader, &entry)) == ARCHIVE_OK) {
+        if (archive_entry_filetype(entry) != AE_IFREG) continue;
+
+        const QByteArrayView path(archive_entry_pathname(entry));
+        const qsizetype slash = path.lastIndexOf('/');
+        if (slash <= 0) continue;
+        const QByteArrayView file = path.sliced(slash + 1);
+        if (file != "desc" && file != "files") continue;
+
+        const QByteArrayView dir = path.first(slash);
+        if (dir != QByteArrayView(entryDir)) {
+            flush();
+            entryDir = dir.toByteArray();
+        }
+
+        const la_int64_t size = archive_entry_size(entry);
+        buffer.resize(qMax<la_int64_t>(size, 0));
+        la_ssize_t read = 0;
+        while (read < size) {
+            la_ssize_t n = archive_read_data(reader, buffer.data() + read, size - read);
+            if (n <= 0) break;
+            read += n;
+        }
+        buffer.truncate(read);
+
+        if (file == "desc") {
+            desc = buffer;
+        } else {
+            addFileList(buffer, repo.packages.size(), repo.paths);
+        }
+    }
+    flush();
+
+    if (status != ARCHIVE_EOF) {
+        repo.error = QString::fromUtf8(archive_error_string(reader));
+    }
+    archive_read_free(reader);
+}
+
+// Longest run of characters every match must contain, as UTF-8; used to
+// skip most paths before running the pattern. Empty when there is none
+// worth checking.
+QByteArray requiredLiteral(const QString& pattern, bool regex) {
+    // Alternatives and groups may make any part optional
+    if (regex && (pattern.contains(u'|') || pattern.contains(u'('))) return QByteArray();
+
+    QString best;
+    QString run;
+    auto endRun = [&]() {
+        if (run.size() > best.size()) best = run;
+        run.clear();
+    };
+
+    for (int i = 0; i < pattern.size(); ++i) {
+        QChar c = pattern[i];
+        if (c == u'[') {
+            endRun();
+            const int close = pattern.indexOf(u']', i + 2);
+            if (close < 0) break;
+            i = close;
+            continue;
+        }
+        if (!regex) {
+            if (c == u'*' || c == u'?') {
+                endRun();
+                continue;
+            }
+        } else if (c == u'\\') {
+            if (i + 1 >= pattern.size()) break;
+            c = pattern[++i];
+            if (c.isLetterOrNumber()) {  // \d, \w, \b...
+                endRun();
+                continue;
+            }
+        } else if (c == u'*' || c == u'?' || c == u'{') {
+            run.chop(1);  // the quantified character is optional
+            endRun();
+            if (c == u'{') {
+                const int close = pattern.indexOf(u'}', i);
+                if (close < 0) break;
+                i = close;
+            }
+            continue;
+        } else if (c == u'+' || c == u'.' || c == u'^' || c == u'$' || c == u')') {
+            endRun();
+            continue;
+        }
+        run += c;
+    }
+    endRun();
+    return best.size() >= 2 ? best.toUtf8() : QByteArray();
+}
+
+} // namespace
+
+QString FilesDatabase::defaultPath() {
+    QString dataDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    return dataDir + "/files.index";
+}
+
+QVector<FilesDatabase::Source> FilesDatabase::sources(const QString& syncPath, const QStringList& order) {
+    QDir sync(syncPath);
+    QStringList paths;
+    if (order.isEmpty()) {
+        for (const QString& file : sync.entryList({"*.files"}, QDir::Files, QDir::Name)) {
+            paths << sync.filePath(file);
+        }
+    } else {
+        for (const QString& repo : order) {
+            paths << sync.filePath(repo + ".files");
+        }
+    }
+
+    QVector<Source> result;
+    for (const QString& path : paths) {
+        QFileInfo info(path);
+        if (info.exists()) {
+            result.append({path, info.lastModified().toMSecsSinceEpoch(), info.size()});
+        }
+    }
+    return result;
+}
+
+std::shared_ptr<const FilesDatabase> FilesDatabase::open(const QString& syncPath, const QStringList& order,
+                                                         const QString& indexPath, QString* error) {
+    const QVector<Source> current = sources(syncPath, order);
+    if (current.isEmpty()) {
+        if (error) *error = "No file databases in " + syncPath + "; run pacman -Fy to download them";
+        return nullptr;
+    }
+
+    std::shared_ptr<FilesDatabase> files(new FilesDatabase);
+    files->m_syncPath = syncPath;
+    files->m_order = order;
+    files->m_sources = current;
+    if (files->map(indexPath, current)) return files;
+
+    if (!build(current, indexPath, error)) return nullptr;
+    if (!files->map(indexPath, current)) {
+        if (error) *error = "Cannot read the file index " + indexPath;
+        return nullptr;
+    }
+    return files;
+}
+
+bool FilesDatabase::isCurrent() const {
+    return sources(m_syncPath, m_order) == m_sources;
+}
+
+bool FilesDatabase::build(const QVector<Source>& sources, const QString& indexPath, QString* error) {
+    // Decompression dominates, so every repository gets its own thread
+    std::vector<RepoFiles> repos(sources.size());
+    for (int i = 0; i < sources.size(); ++i) {
+        repos[i].path = sources[i].path;
+    }
+    QtConcurrent::blockingMap(repos, readRepository);
+
+    QVector<Package> packages;
+    FileOwnerIndex::Builder builder;
+    for (RepoFiles& repo : repos) {
+        if (!repo.error.isEmpty()) {
+            qWarning() << "FilesDatabase: skipping" << repo.path << repo.error;
+            continue;
+        }
+        builder.merge(std::move(repo.paths), packages.size());
+        packages += repo.packages;
+    }
+    repos.clear();
+    const FileOwnerIndex paths = builder.build(0);
+
+    QVector<quint64> basenames;
+    basenames.reserve(paths.size());
+    paths.forEachUnder(QString(), [&basenames](QByteArrayView path, PackageId) {
+        const quint64 entry = basenames.size();
+        basenames.append(quint64(hashName(baseName(path))) << 32 | entry);
+        return true;
+    });
+    std::sort(basenames.begin(), basenames.end());
+
+    QByteArray sourceList;
+    for (const Source& source : sources) {
+        sourceList += source.path.toUtf8() + '\t' + QByteArray::number(source.modified) + '\t'
+                      + QByteArray::number(source.size) + '\n';
+    }
+    QByteArray packageList;
+    for (const Package& package : packages) {
+        packageList += package.repository.toUtf8() + '\t' + package.name.toUtf8() + '\t'
+                       + package.version.toUtf8() + '\n';
+    }
+
+    Header header;
+    std::memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = FormatVersion;
+    header.byteOrder = ByteOrderMark;
+    header.packageCount = packages.size();
+    header.entryCount = paths.size();
+
+    QDir().mkpath(QFileInfo(indexPath).absolutePath());
+    QSaveFile file(indexPath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        if (error) *error = "Cannot write " + indexPath + ": " + file.errorString();
+        return false;
+    }
+    BlockWriter out(&file);
+    out.block(&header, sizeof(header));
+    out.block(sourceList.constData(), sourceList.size());
+    out.block(packageList.constData(), packageList.size());
+    for (const QByteArray* raw : {&paths.rawData(), &paths.rawBlockOffsets(), &paths.rawOwners()}) {
+        out.block(raw->constData(), raw->size());
+    }
+    out.array(basenames);
+
+    if (!out.ok() || !file.commit()) {
+        if (error) *error = "Cannot write " + indexPath + ": " + file.errorString();
+        file.cancelWriting();
+        return false;
+    }
+    return true;
+}
+
+bool FilesDatabase::map(const QString& indexPath, const QVector<Source>& expected) {
+    auto file = std::make_unique<QFile>(indexPath);
+    if (!file->open(QIODevice::ReadOnly)) return false;
+    const qint64 size = file->size();
+    uchar* mapped = size > 0 ? file->map(0, size) : nullptr;
+    if (!mapped) return false;
+
+    BlockReader in(reinterpret_cast<const char*>(mapped), size);
+    Header header;
+    const QByteArrayView headerBlock = in.block();
+    if (headerBlock.size() != qsizetype(sizeof(header))) return false;
+    std::memcpy(&header, headerBlock.data(), sizeof(header));
+    if (std::memcmp(header.magic, Magic, sizeof(Magic)) != 0
+        || header.version != FormatVersion || header.byteOrder != ByteOrderMark) {
+        return false;
+    }
+
+    // Built from exactly the .files dbs there are now?
+    QVector<Source> built;
+    for (const QByteArray& line : in.block().toByteArray().split('\n')) {
+        const QList<QByteArray> fields = line.split('\t');
+        if (fields.size() == 3) {
+            built.append({QString::fromUtf8(fields[0]), fields[1].toLongLong(), fields[2].toLongLong()});
+        }
+    }
+    if (!in.ok() || built != expected) return false;
+
+    QVector<Package> packages;
+    packages.reserve(header.packageCount);
+    for (const QByteArray& line : in.block().toByteArray().split('\n')) {
+        const QList<QByteArray> fields = line.split('\t');
+        if (fields.size() == 3) {
+            packages.append({QString::fromUtf8(fields[0]), QString::fromUtf8(fields[1]), QString::fromUtf8(fields[2])});
+        }
+    }
+    if (packages.size() != qsizetype(header.packageCount)) return false;
+
+    // The path arrays and the basename table stay in the mapping
+    QByteArray raw[3];
+    for (QByteArray& block : raw) {
+        const QByteArrayView view = in.block();
+        block = QByteArray::fromRawData(view.data(), view.size());
+    }
+    const QByteArrayView basenames = in.block();
+    if (!in.ok()) return false;
+
+    FileOwnerIndex paths = FileOwnerIndex::fromRawData(0, raw[0], raw[1], raw[2]);
+    if (paths.size() != qsizetype(header.entryCount)
+        || basenames.size() != paths.size() * qsizetype(sizeof(quint64))) {
+        return false;
+    }
+    for (int i = 0; i < paths.size(); i += FileOwnerIndex::BlockSize) {
+        if (paths.ownerAt(i) < 0 || paths.ownerAt(i) >= packages.size()) return false;
+    }
+
+    m_file = std::move(file);
+    m_packages = packages;
+    m_paths = paths;
+    m_basenames = reinterpret_cast<const quint64*>(basenames.data());
+    m_basenameCount = paths.size();
+    return true;
+}
+
+QVector<FilesDatabase::Match> FilesDatabase::search(const QString& query, Mode mode, int limit,
+                                                    bool* truncated, QString* error) const {
+    if (truncated) *truncated = false;
+    const QString text = query.trimmed();
+    if (text.isEmpty()) return {};
+
+    if (mode == Regex) {
+        QRegularExpression pattern(text);
+        if (!pattern.isValid()) {
+            if (error) *error = pattern.errorString();
+            return {};
+        }
+        return byPattern(pattern, true, QString(), requiredLiteral(text, true), limit, truncated);
+    }
+
+    const bool glob = text.contains(u'*') || text.contains(u'?') || text.contains(u'[');
+    const bool wholePath = text.contains(u'/');
+    if (!glob && !wholePath) return byName(text, limit, truncated);
+
+    if (!glob) {
+        // One exact path, possibly in several repositories
+        QVector<Match> matches;
+        const QString path = text.startsWith(u'/') ? text : "/" + text;
+        for (PackageId owner : m_paths.owners(path)) {
+            matches.append({owner, path});
+        }
+        return matches;
+    }
+
+    // A glob over the whole path only needs the directory before its first wildcard
+    QString under;
+    if (wholePath) {
+        const qsizetype wildcard = text.indexOf(QRegularExpression(R"([*?\[])"));
+        under = text.left(text.lastIndexOf(u'/', wildcard) + 1);
+    }
+    const QString absolute = wholePath && !text.startsWith(u'/') ? "/" + text : text;
+    QRegularExpression pattern = QRegularExpression::fromWildcard(absolute, Qt::CaseSensitive);
+    if (!pattern.isValid()) {
+        if (error) *error = pattern.errorString();
+        return {};
+    }
+    return byPattern(pattern, wholePath, under, requiredLiteral(text, false), limit, truncated);
+}
+
+QVector<FilesDatabase::Match> FilesDatabase::byName(const QString& name, int limit, bool* truncated) const {
+    QVector<Match> matches;
+    const QByteArray key = name.toUtf8();
+    const quint64 first = quint64(hashName(key)) << 32;
+    const quint64* begin = std::lower_bound(m_basenames, m_basenames + m_basenameCount, first);
+    const quint64* end = std::upper_bound(begin, m_basenames + m_basenameCount, first | 0xffffffffu);
+
+    // Entries ascend within one hash, so matches come out in path order
+    for (const quint64* it = begin; it != end; ++it) {
+        const int entry = int(*it & 0xffffffffu);
+        const QByteArray path = m_paths.path(entry);
+        if (baseName(path) != QByteArrayView(key)) continue;  // hash collision
+        if (matches.size() == limit) {
+            if (truncated) *truncated = true;
+            break;
+        }
+        matches.append({m_paths.ownerAt(entry), "/" + QString::fromUtf8(path)});
+    }
+    return matches;
+}
+
+QVector<FilesDatabase::Match> FilesDatabase::byPattern(const QRegularExpression& pattern, bool wholePath,
+                                                       const QString& under, const QByteArray& literal,
+                                                       int limit, bool* truncated) const {
+    QVector<Match> matches;
+    QString subject;
+    // Stored paths lack the leading '/' that whole-path patterns see
+    const QByteArray rootedLiteral = wholePath && literal.startsWith('/') ? literal.mid(1) : QByteArray();
+    m_paths.forEachUnder(under, [&](QByteArrayView path, PackageId owner) {
+        // Cheap byte test first; only candidates are decoded
+        if (!literal.isEmpty() && !SubstringSearch::contains(path, literal)
+            && (rootedLiteral.isEmpty() || !path.startsWith(rootedLiteral))) {
+            return true;
+        }
+
+        subject = wholePath ? "/" + QString::fromUtf8(path) : QString::fromUtf8(baseName(path));
+        if (!pattern.match(subject).hasMatch()) return true;
+
+        if (matches.size() == limit) {
+            if (truncated) *truncated = true;
+            return false;
+        }
+        matches.append({owner, wholePath ? subject : "/" + QString::fromUtf8(path)});
+        return true;
+    });
+    return matches;
+}
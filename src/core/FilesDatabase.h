@@ -0,0 +1,96 @@
+#ifndef FILESDATABASE_H
+#define FILESDATABASE_H
+
+#include <QFile>
+#include <QRegularExpression>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <memory>
+#include "FileOwnerIndex.h"
+
+// Which repository packages contain a file, answered like pacman -F but
+// without running it.
+//
+// The sync .files dbs are tar archives with a file list per package. They
+// are streamed once through libarchive, one repository per thread, into an
+// index file holding the package table, every file path front-coded in a
+// FileOwnerIndex (owners are package table rows) and (basename hash, entry)
+// pairs sorted by hash. The index is memory-mapped, so opening it only
+// reads the package table and lookups only touch the pages they need. It is
+// rebuilt when a .files db is added, removed or rewritten (pacman -Fy).
+// Directories are left out; every query is about files.
+class FilesDatabase {
+public:
+    enum Mode {
+        Auto,   // "/usr/bin/ls": that path, "ls": any file of that name, '*' '?' '[': glob
+        Regex   // regular expression over the whole path, like pacman -Fx
+    };
+
+    struct Package {
+        QString repository;
+        QString name;
+        QString version;
+    };
+
+    struct Match {
+        int package = -1;  // into packages()
+        QString path;      // with the leading '/'
+    };
+
+    static QString defaultPath();
+
+    // Opens the index at indexPath, rebuilding it first if the .files dbs in
+    // syncPath changed. order lists repositories as pacman.conf does; when
+    // it's empty every .files db is used. nullptr if there is no .files db
+    // or the index can't be written; see error.
+    static std::shared_ptr<const FilesDatabase> open(const QString& syncPath, const QStringList& order,
+                                                     const QString& indexPath, QString* error = nullptr);
+
+    FilesDatabase(const FilesDatabase&) = delete;
+    FilesDatabase& operator=(const FilesDatabase&) = delete;
+
+    // False once a .files db changed since the index was opened
+    bool isCurrent() const;
+
+    const QVector<Package>& packages() const { return m_packages; }
+    int pathCount() const { return m_paths.size(); }
+
+    // At most limit matches; truncated tells whether there were more. A
+    // malformed pattern sets error and matches nothing.
+    QVector<Match> search(const QString& query, Mode mode, int limit,
+                          bool* truncated = nullptr, QString* error = nullptr) const;
+
+private:
+    // A .files db the index was built from
+    struct Source {
+        QString path;
+        qint64 modified = 0;  // ms since epoch
+        qint64 size = 0;
+        bool operator==(const Source& other) const {
+            return path == other.path && modified == other.modified && size == other.size;
+        }
+    };
+
+    FilesDatabase() = default;
+
+    static QVector<Source> sources(const QString& syncPath, const QStringList& order);
+    static bool build(const QVector<Source>& sources, const QString& indexPath, QString* error);
+    bool map(const QString& indexPath, const QVector<Source>& expected);
+
+    QVector<Match> byName(const QString& name, int limit, bool* truncated) const;
+    QVector<Match> byPattern(const QRegularExpression& pattern, bool wholePath, const QString& under,
+                             const QByteArray& literal, int limit, bool* truncated) const;
+
+    QString m_syncPath;
+    QStringList m_order;
+    QVector<Source> m_sources;
+
+    std::unique_ptr<QFile> m_file;  // keeps the mapping alive
+    QVector<Package> m_packages;
+    FileOwnerIndex m_paths;
+    const quint64* m_basenames = nullptr;  // (hash << 32 | entry), ascending
+    qsizetype m_basenameCount = 0;
+};
+
+#endif // FILESDATABASE_H
@@ -0,0 +1,64 @@
+#include "FoldedText.h"
+#include "PackageStore.h"
+#include "utils/SubstringSearch.h"
+#include <algorithm>
+
+void FoldedText::build(const PackageStore& store) {
+    clear();
+    m_offsets.reserve(store.size() + 1);
+    m_descriptionOffsets.reserve(store.size());
+    
+    for (PackageId id = 0; id < store.size(); ++id) {
+        m_blob += SubstringSearch::fold(store.name(id));
+        m_blob += '\n';
+        m_descriptionOffsets.append(m_blob.size());
+        m_blob += SubstringSearch::fold(store.description(id));
+        m_blob += '\n';
+        m_offsets.append(m_blob.size());
+    }
+    m_blob.squeeze();
+}
+
+void FoldedText::clear() {
+    m_blob.clear();
+    m_offsets = {0};
+    m_descriptionOffsets.clear();
+}
+
+qint64 FoldedText::memoryUsage() const {
+    return m_blob.capacity()
+        + (m_offsets.capacity() + m_descriptionOffsets.capacity()) * qint64(sizeof(quint32));
+}
+
+QByteArrayView FoldedText::name(PackageId id) const {
+    const quint32 first = m_offsets[id];
+    return QByteArrayView(m_blob.constData() + first, m_descriptionOffsets[id] - first - 1);
+}
+
+QByteArrayView FoldedText::description(PackageId id) const {
+    const quint32 first = m_descriptionOffsets[id];
+    return QByteArrayView(m_blob.constData() + first, m_offsets[id + 1] - first - 1);
+}
+
+QBitArray FoldedText::matching(const QString& needle, int fields) const {
+    QBitArray result(size());
+    const QByteArray key = SubstringSearch::fold(needle);
+    // Fields end in '\n', so a needle without one never spans two of them
+    if (key.isEmpty() || key.contains('\n')) return result;
+    
+    qsizetype pos = 0;
+    while ((pos = SubstringSearch::indexOf(m_blob, key, pos)) >= 0) {
+        const PackageId id = PackageId(std::upper_bound(m_offsets.begin(), m_offsets.end(), quint32(pos))
+                                       - m_offsets.begin()) - 1;
+        const bool inName = pos < qsizetype(m_descriptionOffsets[id]);
+        if (fields & (inName ? NameField : DescriptionField)) {
+            result.setBit(id);
+            pos = m_offsets[id + 1];  // one hit per package is enough
+        } else if (inName) {
+            pos = m_descriptionOffsets[id];
+        } else {
+            pos = m_offsets[id + 1];
+        }
+    }
+    return result;
+}
@@ -0,0 +1,43 @@
+#ifndef FOLDEDTEXT_H
+#define FOLDEDTEXT_H
+
+#include <QBitArray>
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QString>
+#include <QVector>
+#include "models/Package.h"
+
+class PackageStore;
+
+// Names and descriptions of a store, case-folded into one contiguous UTF-8
+// blob ("name\ndescription\n" per package) with per-package offsets.
+// Case-insensitive substring search becomes one vectorized byte scan over
+// the blob instead of a folding compare per string.
+class FoldedText {
+public:
+    enum Field {
+        NameField = 0x1,
+        DescriptionField = 0x2,
+        AllFields = NameField | DescriptionField
+    };
+    
+    void build(const PackageStore& store);
+    void clear();
+    
+    int size() const { return m_descriptionOffsets.size(); }
+    qint64 memoryUsage() const;
+    
+    QByteArrayView name(PackageId id) const;
+    QByteArrayView description(PackageId id) const;
+    
+    // Bitset over package ids whose fields contain needle, ignoring case
+    QBitArray matching(const QString& needle, int fields = AllFields) const;
+
+private:
+    QByteArray m_blob;
+    QVector<quint32> m_offsets{0};          // start of each package, then the end
+    QVector<quint32> m_descriptionOffsets;  // start of each description
+};
+
+#endif // FOLDEDTEXT_H
@@ -0,0 +1,294 @@
+#include "LocalDbReader.h"
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QtConcurrent>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+// Entries parsed in parallel per round; bounds open files and mappings
+constexpr int BatchSize = 256;
+
+// What parseEntry() reads
+enum Part {
+    ReadDesc = 0x1,
+    ReadBackup = 0x2,
+    ReadPaths = 0x4
+};
+
+// One file of an entry, mapped if possible
+struct Mapping {
+    std::unique_ptr<QFile> file;  // keeps the mapping alive
+    QByteArray contents;          // used when the file can't be mapped
+
+    QByteArrayView open(const QString& path) {
+        file = std::make_unique<QFile>(path);
+        if (!file->open(QIODevice::ReadOnly)) return QByteArrayView();
+
+        qint64 size = file->size();
+        if (size <= 0) return QByteArrayView();
+        if (uchar* map = file->map(0, size)) {
+            return QByteArrayView(reinterpret_cast<const char*>(map), size);
+        }
+        contents = file->readAll();
+        return contents;
+    }
+};
+
+struct Entry {
+    QString dirPath;
+    Mapping desc;
+    Mapping files;
+    PackageStore::Record record;
+    FileOwnerIndex::Builder paths;  // owned by 0 until merged under the real id
+    bool valid = false;
+};
+
+void parseEntry(Entry& entry, int parts) {
+    if (parts & ReadDesc) {
+        entry.valid = LocalDbReader::parseDesc(entry.desc.open(entry.dirPath + "/desc"), entry.record);
+        if (!entry.valid) return;
+    } else {
+        entry.valid = true;
+    }
+
+    if (parts & (ReadBackup | ReadPaths)) {
+        LocalDbReader::parseFiles(entry.files.open(entry.dirPath + "/files"), entry.record.backup,
+                                  (parts & ReadPaths) ? &entry.paths : nullptr);
+    }
+}
+
+// Parses dirPaths BatchSize at a time and hands each batch, with the
+// index of its first entry, to consume while its mappings are open
+template <typename Consume>
+bool parseInBatches(const QStringList& dirPaths, int parts, const PackageStore::Progress& progress,
+                    Consume consume) {
+    const int total = dirPaths.size();
+    std::vector<Entry> batch;
+    for (int first = 0; first < total; first += BatchSize) {
+        int count = qMin(BatchSize, total - first);
+        batch.clear();
+        batch.resize(count);
+        for (int i = 0; i < count; ++i) {
+            batch[i].dirPath = dirPaths[first + i];
+        }
+
+        QtConcurrent::blockingMap(batch, [parts](Entry& entry) { parseEntry(entry, parts); });
+        consume(batch, first);
+
+        if (progress && !progress(first + count, total)) return false;
+    }
+    return true;
+}
+
+qint64 toNumber(QByteArrayView value) {
+    qint64 n = 0;
+    for (char c : value) {
+        if (c < '0' || c > '9') break;
+        n = n * 10 + (c - '0');
+    }
+    return n;
+}
+
+} // namespace
+
+LocalDbReader::LocalDbReader(const QString& localPath)
+    : m_localPath(localPath)
+{
+}
+
+QString LocalDbReader::packageName(const QString& entry) {
+    // "name-pkgver-pkgrel"; pkgver and pkgrel never contain '-'
+    int relDash = entry.lastIndexOf('-');
+    int verDash = relDash > 0 ? entry.lastIndexOf('-', relDash - 1) : -1;
+    return verDash > 0 ? entry.left(verDash) : entry;
+}
+
+bool LocalDbReader::parseDesc(QByteArrayView data, PackageStore::Record& record) {
+    record.clear();
+    record.isExplicit = true;  // %REASON% is only written for dependencies
+
+    enum Section {
+        Ignored, Name, Version, Description, Url, Arch, Packager,
+        BuildDate, InstallDate, Size, CompressedSize, InstalledSize, Reason,
+        Licenses, Groups, Depends, OptDepends, Conflicts, Provides, Replaces
+    };
+    static const QHash<QByteArray, Section> sections = {
+        {"%NAME%", Name}, {"%VERSION%", Version}, {"%DESC%", Description},
+        {"%URL%", Url}, {"%ARCH%", Arch}, {"%PACKAGER%", Packager},
+        {"%BUILDDATE%", BuildDate}, {"%INSTALLDATE%", InstallDate},
+        {"%SIZE%", Size}, {"%CSIZE%", CompressedSize}, {"%ISIZE%", InstalledSize},
+        {"%REASON%", Reason},
+        {"%LICENSE%", Licenses}, {"%GROUPS%", Groups}, {"%DEPENDS%", Depends},
+        {"%OPTDEPENDS%", OptDepends}, {"%CONFLICTS%", Conflicts},
+        {"%PROVIDES%", Provides}, {"%REPLACES%", Replaces},
+    };
+
+    // "%KEY%" on its own line, then one value per line up to a blank line
+    Section section = Ignored;
+    const char* pos = data.data();
+    const char* end = pos + data.size();
+    while (pos < end) {
+        const char* eol = static_cast<const char*>(std::memchr(pos, '\n', end - pos));
+        if (!eol) eol = end;
+        QByteArrayView line(pos, eol - pos);
+        pos = eol + 1;
+
+        if (line.isEmpty()) {
+            section = Ignored;
+            continue;
+        }
+        if (line.front() == '%' && line.back() == '%' && line.size() > 2) {
+            const QByteArray key = QByteArray::fromRawData(line.data(), line.size());
+            section = sections.value(key, Ignored);
+            continue;
+        }
+
+        switch (section) {
+            case Ignored: break;
+            case Name: record.name = line; break;
+            case Version: record.version = line; break;
+            case Description: record.description = line; break;
+            case Url: record.url = line; break;
+            case Arch: record.architecture = line; break;
+            case Packager: record.packager = line; break;
+            case BuildDate: record.buildDate = toNumber(line); break;
+            case InstallDate: record.installDate = toNumber(line); break;
+            // Local entries carry the installed size, sync entries both
+            case Size: record.installedSize = toNumber(line); break;
+            case CompressedSize: record.downloadSize = toNumber(line); break;
+            case InstalledSize: record.installedSize = toNumber(line); break;
+            case Reason: record.isExplicit = line != "1"; break;
+            case Licenses: record.licenses.append(line); break;
+            case Groups: record.groups.append(line); break;
+            case Depends: record.depends.append(PackageStore::dependencyName(line)); break;
+            case OptDepends: record.optDepends.append(line); break;
+            case Conflicts: record.conflicts.append(PackageStore::dependencyName(line)); break;
+            case Provides: record.provides.append(PackageStore::dependencyName(line)); break;
+            case Replaces: record.replaces.append(PackageStore::dependencyName(line)); break;
+        }
+    }
+
+    return !record.name.isEmpty();
+}
+
+void LocalDbReader::parseFiles(QByteArrayView data, QList<QByteArrayView>& backup,
+                               FileOwnerIndex::Builder* paths, PackageId owner) {
+    enum Section { Ignored, Files, Backup };
+    Section section = Ignored;
+    const char* pos = data.data();
+    const char* end = pos + data.size();
+    while (pos < end) {
+        const char* eol = static_cast<const char*>(std::memchr(pos, '\n', end - pos));
+        if (!eol) eol = end;
+        QByteArrayView line(pos, eol - pos);
+        pos = eol + 1;
+
+        if (line.isEmpty()) {
+            section = Ignored;
+        } else if (line.front() == '%' && line.back() == '%') {
+            section = line == "%FILES%" ? Files : (line == "%BACKUP%" ? Backup : Ignored);
+        } else if (section == Files) {
+            if (paths) paths->add(line, owner);
+        } else if (section == Backup) {
+            // "path\tmd5sum"
+            qsizetype tab = line.indexOf('\t');
+            backup.append(tab >= 0 ? line.first(tab) : line);
+        }
+    }
+}
+
+std::shared_ptr<PackageStore> LocalDbReader::load(quint64 generation, const PackageStore::Progress& progress,
+                                                  FileOwnerIndex::Builder* files) {
+    m_lastError.clear();
+    m_canceled = false;
+
+    QDir local(m_localPath);
+    if (!local.exists()) {
+        setError("Local database not found: " + m_localPath);
+        return nullptr;
+    }
+
+    // libalpm's package cache is sorted by name; keep ids in the same order
+    QList<QPair<QString, QString>> entries;  // (package name, directory)
+    for (const QString& dir : local.entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+        entries.append(qMakePair(packageName(dir), dir));
+    }
+    std::sort(entries.begin(), entries.end());
+
+    QStringList dirPaths;
+    dirPaths.reserve(entries.size());
+    for (const auto& entry : entries) {
+        dirPaths.append(local.filePath(entry.second));
+    }
+
+    const int total = entries.size();
+    auto store = std::make_shared<PackageStore>(generation);
+    store->reserve(total);
+    if (progress && !progress(0, total)) {
+        m_canceled = true;
+        return nullptr;
+    }
+
+    // Interning is serial; the views are still backed by this batch's mappings
+    const int parts = ReadDesc | ReadBackup | (files ? ReadPaths : 0);
+    bool completed = parseInBatches(dirPaths, parts, progress, [&](std::vector<Entry>& batch, int) {
+        for (Entry& entry : batch) {
+            if (!entry.valid) {
+                qWarning() << "LocalDbReader: skipping unreadable entry" << entry.dirPath;
+                continue;
+            }
+            PackageId id = store->append(entry.record);
+            if (files) {
+                files->merge(std::move(entry.paths), id);
+            }
+        }
+    });
+    if (!completed) {
+        m_canceled = true;
+        return nullptr;
+    }
+
+    store->finalize();
+    return store;
+}
+
+bool LocalDbReader::loadFiles(const PackageStore& store, FileOwnerIndex::Builder& files,
+                              const PackageStore::Progress& progress) {
+    m_lastError.clear();
+    m_canceled = false;
+
+    QDir local(m_localPath);
+    if (!local.exists()) {
+        setError("Local database not found: " + m_localPath);
+        return false;
+    }
+
+    // Entry directories are "name-version"
+    QStringList dirPaths;
+    dirPaths.reserve(store.size());
+    for (PackageId id = 0; id < store.size(); ++id) {
+        dirPaths.append(local.filePath(store.name(id) + '-' + store.version(id)));
+    }
+
+    if (progress && !progress(0, store.size())) {
+        m_canceled = true;
+        return false;
+    }
+
+    bool completed = parseInBatches(dirPaths, ReadPaths, progress, [&files](std::vector<Entry>& batch, int first) {
+        for (int i = 0; i < int(batch.size()); ++i) {
+            files.merge(std::move(batch[i].paths), first + i);
+        }
+    });
+    m_canceled = !completed;
+    return completed;
+}
+
+void LocalDbReader::setError(const QString& error) {
+    m_lastError = error;
+    qWarning() << "LocalDbReader error:" << error;
+}
@@ -0,0 +1,59 @@
+#ifndef LOCALDBREADER_H
+#define LOCALDBREADER_H
+
+#include <QString>
+#include <memory>
+#include "PackageStore.h"
+#include "FileOwnerIndex.h"
+
+// Loads a PackageStore straight from /var/lib/pacman/local without libalpm.
+//
+// libalpm parses the local db single-threaded and converts every field as
+// it goes. Here each entry's desc and files are memory-mapped and parsed in
+// parallel into views over the mappings; only appending to the store (which
+// interns the strings) and collecting paths are serial. Entries are
+// processed in batches so the number of open mappings stays bounded.
+// libalpm is still used for transactions.
+//
+// mtree is not read: it is gzip-compressed and only holds per-file modes,
+// sizes and checksums for pacman -Qkk, which nothing here shows, and
+// inflating it for every package would cost more than the rest of the load.
+class LocalDbReader {
+public:
+    explicit LocalDbReader(const QString& localPath);
+
+    // nullptr on failure or cancellation; see lastError() / isCanceled().
+    // With files, every installed path is added to it in the same pass,
+    // owned by the package's id in the returned store.
+    std::shared_ptr<PackageStore> load(quint64 generation,
+                                       const PackageStore::Progress& progress = PackageStore::Progress(),
+                                       FileOwnerIndex::Builder* files = nullptr);
+
+    // Reads only the file lists, for a store that is already loaded (from
+    // a snapshot, say). False on failure or cancellation.
+    bool loadFiles(const PackageStore& store, FileOwnerIndex::Builder& files,
+                   const PackageStore::Progress& progress = PackageStore::Progress());
+
+    QString lastError() const { return m_lastError; }
+    bool isCanceled() const { return m_canceled; }
+
+    // Package name of a "name-pkgver-pkgrel" entry directory
+    static QString packageName(const QString& entry);
+
+    // Parses the text of a desc file, local or sync. Views point into data.
+    static bool parseDesc(QByteArrayView data, PackageStore::Record& record);
+
+    // Parses the text of a local files entry: %BACKUP% paths into backup,
+    // %FILES% into paths (if given) owned by owner. Views point into data.
+    static void parseFiles(QByteArrayView data, QList<QByteArrayView>& backup,
+                           FileOwnerIndex::Builder* paths = nullptr, PackageId owner = 0);
+
+private:
+    void setError(const QString& error);
+
+    QString m_localPath;
+    QString m_lastError;
+    bool m_canceled = false;
+};
+
+#endif // LOCALDBREADER_H
@@ -0,0 +1,144 @@
+#include "LocalDbWatcher.h"
+#include "LocalDbReader.h"
+#include "PackageStore.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QSet>
+
+namespace {
+// Quiet period after the last notification before rescanning; a transaction
+// touches local/ many times in a row.
+constexpr int SettleIntervalMs = 300;
+}
+
+LocalDbChanges LocalDbChanges::between(const PackageStore& before, const PackageStore& after) {
+    LocalDbChanges changes;
+    for (PackageId id = 0; id < before.size(); ++id) {
+        PackageId current = after.find(before.name(id));
+        if (current < 0) {
+            changes.removed.append(before.name(id));
+        } else if (before.version(id) != after.version(current)
+                   || before.installDateSecs(id) != after.installDateSecs(current)
+                   || before.isExplicit(id) != after.isExplicit(current)) {
+            changes.changed.append(before.name(id));
+        }
+    }
+    for (PackageId id = 0; id < after.size(); ++id) {
+        if (!before.contains(after.name(id))) {
+            changes.added.append(after.name(id));
+        }
+    }
+    return changes;
+}
+
+LocalDbWatcher::LocalDbWatcher(const QString& dbPath, QObject* parent)
+    : QObject(parent)
+    , m_dbPath(QDir(dbPath).absolutePath())
+    , m_localPath(QDir(dbPath).filePath("local"))
+{
+    m_settleTimer.setSingleShot(true);
+    m_settleTimer.setInterval(SettleIntervalMs);
+    connect(&m_settleTimer, &QTimer::timeout, this, &LocalDbWatcher::onSettled);
+
+    // db.lck is created and removed in the db directory, so watch the
+    // directory rather than the (usually absent) lock file itself
+    connect(&m_watcher, &QFileSystemWatcher::directoryChanged, this, &LocalDbWatcher::onPathChanged);
+}
+
+void LocalDbWatcher::start() {
+    m_snapshot = scan();
+
+    QStringList paths = {m_dbPath, m_localPath};
+    for (const QString& path : m_watcher.directories()) {
+        paths.removeAll(path);
+    }
+    if (!paths.isEmpty()) {
+        m_watcher.addPaths(paths);
+    }
+}
+
+LocalDbChanges LocalDbWatcher::poll() {
+    if (isLocked()) return LocalDbChanges();
+
+    m_settleTimer.stop();
+    Snapshot current = scan();
+    LocalDbChanges changes = diff(m_snapshot, current);
+    m_snapshot = std::move(current);
+    return changes;
+}
+
+bool LocalDbWatcher::isLocked() const {
+    return QFileInfo::exists(m_dbPath + "/db.lck");
+}
+
+void LocalDbWatcher::onPathChanged() {
+    // Restarting pushes the scan past the end of a burst of notifications
+    m_settleTimer.start();
+}
+
+void LocalDbWatcher::onSettled() {
+    if (isLocked()) {
+        // Transaction still running; removing the lock notifies us again,
+        // the timer is only a fallback
+        m_settleTimer.start();
+        return;
+    }
+
+    LocalDbChanges changes = poll();
+    if (!changes.isEmpty()) {
+        emit changed(changes);
+    }
+}
+
+LocalDbWatcher::Snapshot LocalDbWatcher::scan() const {
+    Snapshot snapshot;
+    QDir local(m_localPath);
+    const QStringList entries = local.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    snapshot.reserve(entries.size());
+
+    for (const QString& entry : entries) {
+        QFileInfo desc(local.filePath(entry + "/desc"));
+        if (!desc.exists()) continue;  // half-written entry
+        snapshot.insert(entry, desc.lastModified().toMSecsSinceEpoch());
+    }
+    return snapshot;
+}
+
+LocalDbChanges LocalDbWatcher::diff(const Snapshot& before, const Snapshot& after) {
+    QSet<QString> removed;
+    QSet<QString> added;
+    QSet<QString> changed;
+
+    for (auto it = before.constBegin(); it != before.constEnd(); ++it) {
+        auto current = after.constFind(it.key());
+        if (current == after.constEnd()) {
+            removed.insert(LocalDbReader::packageName(it.key()));
+        } else if (current.value() != it.value()) {
+            changed.insert(LocalDbReader::packageName(it.key()));
+        }
+    }
+    for (auto it = after.constBegin(); it != after.constEnd(); ++it) {
+        if (!before.contains(it.key())) {
+            added.insert(LocalDbReader::packageName(it.key()));
+        }
+    }
+
+    // An upgrade replaces "foo-1.0-1" with "foo-1.1-1"
+    for (auto it = removed.begin(); it != removed.end();) {
+        if (added.remove(*it)) {
+            changed.insert(*it);
+            it = removed.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    LocalDbChanges changes;
+    changes.added = added.values();
+    changes.removed = removed.values();
+    changes.changed = changed.values();
+    changes.added.sort();
+    changes.removed.sort();
+    changes.changed.sort();
+    return changes;
+}
@@ -0,0 +1,68 @@
+#ifndef LOCALDBWATCHER_H
+#define LOCALDBWATCHER_H
+
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+
+class PackageStore;
+
+// Package-level difference between two scans of the local database
+struct LocalDbChanges {
+    QStringList added;    // package names
+    QStringList removed;
+    QStringList changed;  // upgraded, downgraded, reinstalled or desc rewritten (pacman -D)
+
+    bool isEmpty() const { return added.isEmpty() && removed.isEmpty() && changed.isEmpty(); }
+
+    // The same difference between two loaded stores, matched by name
+    static LocalDbChanges between(const PackageStore& before, const PackageStore& after);
+};
+
+// Watches /var/lib/pacman/local and db.lck and reports which packages a
+// pacman transaction touched once it has finished.
+//
+// Each package is a "name-pkgver-pkgrel" directory in local/, so installs
+// and removals show up as directory entries. Rewrites inside an entry (e.g.
+// install reason changes) do not notify local/ itself, but they always run
+// under db.lck, so lock changes trigger a rescan too. The scan compares
+// entry names and desc mtimes against the previous snapshot.
+class LocalDbWatcher : public QObject {
+    Q_OBJECT
+
+public:
+    explicit LocalDbWatcher(const QString& dbPath, QObject* parent = nullptr);
+
+    // Takes the baseline snapshot and starts watching
+    void start();
+
+    // Rescans immediately and returns the changes since the last scan.
+    // Empty while a transaction still holds the lock.
+    LocalDbChanges poll();
+
+    bool isLocked() const;
+
+signals:
+    void changed(const LocalDbChanges& changes);
+
+private slots:
+    void onPathChanged();
+    void onSettled();
+
+private:
+    using Snapshot = QHash<QString, qint64>;  // entry directory -> desc mtime (ms)
+
+    Snapshot scan() const;
+    static LocalDbChanges diff(const Snapshot& before, const Snapshot& after);
+
+    QString m_dbPath;
+    QString m_localPath;
+    QFileSystemWatcher m_watcher;
+    QTimer m_settleTimer;
+    Snapshot m_snapshot;
+};
+
+#endif // LOCALDBWATCHER_H
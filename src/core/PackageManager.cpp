@@ -1,27 +1,92 @@
 #include "PackageManager.h"
+#include "LocalDbReader.h"
+#include "PacmanConfig.h"
 #include <QDebug>
 #include <QDir>
 #include <QFileInfo>
+#include <QtConcurrent>
 #include <algorithm>
 
+namespace {
+
+// Waits for a single-result future; canceled futures yield the fallback
+template <typename T>
+T resultOf(QFuture<T> future, T fallback = T()) {
+    future.waitForFinished();
+    return future.resultCount() > 0 ? future.result() : fallback;
+}
+
+// Forwards store loading progress to a promise and reports cancellation
+template <typename T>
+PackageStore::Progress progressOf(QPromise<T>& promise) {
+    return [&promise](int done, int total) {
+        if (done == 0) {
+            promise.setProgressRange(0, total);
+        }
+        promise.setProgressValue(done);
+        return !promise.isCanceled();
+    };
+}
+
+} // namespace
+
 PackageManager::PackageManager(QObject* parent)
     : QObject(parent)
 {
+    // libalpm is not thread-safe; one thread owns the handle
+    m_alpmThread.setMaxThreadCount(1);
+    m_alpmThread.setExpiryTimeout(-1);
+    m_alpmThread.setObjectName("alpm");
+    
+    // The baseline is taken once; later reloads are driven by its deltas
+    m_watcher = new LocalDbWatcher(m_dbPath, this);
+    connect(m_watcher, &LocalDbWatcher::changed, this, &PackageManager::onLocalDbChanged);
+    m_watcher->start();
 }
 
 PackageManager::~PackageManager() {
-    if (m_handle) {
-        alpm_release(m_handle);
-        m_handle = nullptr;
-    }
+    m_alpmThread.clear();
+    m_alpmThread.waitForDone();
+    
+    QMutexLocker locker(&m_alpmMutex);
+    releaseLocked();
+}
+
+template <typename T>
+QFuture<T> PackageManager::runOnAlpmThread(std::function<void(QPromise<T>&)> task) {
+    // A plain runnable fulfilling a promise: unlike QtConcurrent::run, a
+    // thread waiting on the future can't steal it, so every task runs on
+    // the alpm thread in submission order. A task still queued when the
+    // pool is cleared drops its promise, which cancels the future.
+    auto promise = std::make_shared<QPromise<T>>();
+    QFuture<T> future = promise->future();
+    m_alpmThread.start([this, promise, task]() {
+        promise->start();
+        if (!promise->isCanceled()) {
+            QMutexLocker locker(&m_alpmMutex);
+            task(*promise);
+        }
+        promise->finish();
+    });
+    return future;
 }
 
 bool PackageManager::initialize() {
+    return resultOf(initializeAsync(), false);
+}
+
+QFuture<bool> PackageManager::initializeAsync() {
+    return runOnAlpmThread<bool>([this](QPromise<bool>& promise) {
+        promise.addResult(initializeLocked());
+    });
+}
+
+bool PackageManager::initializeLocked() {
     if (m_initialized) return true;
     
     alpm_errno_t err;
-    m_handle = alpm_initialize(m_rootDir.toUtf8().constData(), 
-                                m_dbPath.toUtf8().constData(), 
+    m_handle = alpm_initialize(m_rootDir.toUtf8().constData(),
+                                m_dbPath.toUtf8().constData(),
                                 &err);
     
     if (!m_handle) {
@@ -38,244 +103,393 @@ bool PackageManager::initialize() {
     }
     
     m_initialized = true;
+    ++m_generation;
     qDebug() << "PackageManager initialized successfully";
     return true;
 }
 
-void PackageManager::refresh() {
-    // Re-initialize to get fresh data from the database
+void PackageManager::releaseLocked() {
     if (m_handle) {
         alpm_release(m_handle);
         m_handle = nullptr;
         m_localDb = nullptr;
-        m_initialized = false;
     }
-    
-    initialize();
+    m_initialized = false;
+}
+
+void PackageManager::refresh() {
+    refreshAsync().waitForFinished();
     // Note: Don't emit packagesChanged here - caller handles UI updates
 }
 
-Package PackageManager::alpmPackageToPackage(alpm_pkg_t* pkg) {
-    Package p;
-    
-    p.name = QString::fromUtf8(alpm_pkg_get_name(pkg));
-    p.version = QString::fromUtf8(alpm_pkg_get_version(pkg));
-    p.description = QString::fromUtf8(alpm_pkg_get_desc(pkg));
-    p.url = QString::fromUtf8(alpm_pkg_get_url(pkg));
-    p.packager = QString::fromUtf8(alpm_pkg_get_packager(pkg));
-    p.architecture = QString::fromUtf8(alpm_pkg_get_arch(pkg));
-    
-    p.installedSize = alpm_pkg_get_isize(pkg);
-    p.downloadSize = alpm_pkg_get_size(pkg);
-    
-    p.installDate = QDateTime::fromSecsSinceEpoch(alpm_pkg_get_installdate(pkg));
-    p.buildDate = QDateTime::fromSecsSinceEpoch(alpm_pkg_get_builddate(pkg));
+QFuture<void> PackageManager::refreshAsync() {
+    return runOnAlpmThread<void>([this](QPromise<void>& promise) {
+        // Re-initialize to get fresh data from the database
+        releaseLocked();
+        initializeLocked();
+    
+        // Views ask for the new store right away; have it ready
+        loadStoreLocked(progressOf(promise));
+    });
+}
+
+LocalDbChanges PackageManager::syncLocalChanges() {
+    LocalDbChanges changes = m_watcher->poll();
+    if (!changes.isEmpty()) {
+        onLocalDbChanged(changes);
+    }
+    return changes;
+}
+
+void PackageManager::onLocalDbChanged(const LocalDbChanges& changes) {
+    // libalpm has no per-package reload, so the handle is re-opened on the
+    // alpm thread; views apply the deltas once the new store is loaded
+    refreshAsync().then(this, [this, changes]() {
+        emit localPackagesChanged(changes);
+    });
+}
+
+bool PackageManager::loadSnapshot(const QString& path, qint64* userDataStamp, QVector<PackageUserData>* userData) {
+    if (!m_initialized) return false;
     
-    alpm_pkgreason_t reason = alpm_pkg_get_reason(pkg);
-    p.installReason = (reason == ALPM_PKG_REASON_EXPLICIT) ? "explicit" : "dependency";
+    StoreSnapshot::Key key;
+    std::shared_ptr<const PackageStore> loaded = StoreSnapshot::load(path, m_generation, &key, userDataStamp, userData);
+    if (!loaded) return false;
     
-    // Groups
-    alpm_list_t* groups = alpm_pkg_get_groups(pkg);
-    for (alpm_list_t* i = groups; i; i = alpm_list_next(i)) {
-        p.groups << QString::fromUtf8(static_cast<const char*>(i->data));
+    QMutexLocker locker(&m_stateMutex);
+    if (m_store && m_store->generation() == m_generation) {
+        return false;  // the real thing is already loaded
     }
+    m_store = loaded;
+    m_storeKey = key;
+    return true;
+}
+
+void PackageManager::validateSnapshot() {
+    QFuture<LocalDbChanges> future = runOnAlpmThread<LocalDbChanges>([this](QPromise<LocalDbChanges>& promise) {
+        std::shared_ptr<const PackageStore> before;
+        StoreSnapshot::Key key;
+        {
+            QMutexLocker locker(&m_stateMutex);
+            before = m_store;
+            key = m_storeKey;
+        }
+        if (!before || StoreSnapshot::currentKey(m_dbPath) == key) {
+            promise.addResult(LocalDbChanges());
+            return;
+        }
     
-    // Licenses
-    alpm_list_t* licenses = alpm_pkg_get_licenses(pkg);
-    for (alpm_list_t* i = licenses; i; i = alpm_list_next(i)) {
-        p.licenses << QString::fromUtf8(static_cast<const char*>(i->data));
-    }
+        // Packages changed while we weren't running; load the db for real
+        releaseLocked();
+        initializeLocked();
+        std::shared_ptr<const PackageStore> after = loadStoreLocked(progressOf(promise));
+        promise.addResult(after ? LocalDbChanges::between(*before, *after) : LocalDbChanges());
+    });
     
-    // Dependencies
-    alpm_list_t* depends = alpm_pkg_get_depends(pkg);
-    for (alpm_list_t* i = depends; i; i = alpm_list_next(i)) {
-        alpm_depend_t* dep = static_cast<alpm_depend_t*>(i->data);
-        p.depends << QString::fromUtf8(dep->name);
+    future.then(this, [this](const LocalDbChanges& changes) {
+        if (!changes.isEmpty()) {
+            emit localPackagesChanged(changes);
+        }
+    });
+}
+
+bool PackageManager::saveSnapshot(const QString& path, qint64 userDataStamp, const QList<PackageUserData>& userData) {
+    std::shared_ptr<const PackageStore> pkgs;
+    StoreSnapshot::Key key;
+    {
+        QMutexLocker locker(&m_stateMutex);
+        pkgs = m_store;
+        key = m_storeKey;
     }
+    if (!pkgs || key.isNull()) return false;
     
-    // Optional dependencies
-    alpm_list_t* optdeps = alpm_pkg_get_optdepends(pkg);
-    for (alpm_list_t* i = optdeps; i; i = alpm_list_next(i)) {
-        alpm_depend_t* dep = static_cast<alpm_depend_t*>(i->data);
-        QString optdep = QString::fromUtf8(dep->name);
-        if (dep->desc) {
-            optdep += QString(": %1").arg(QString::fromUtf8(dep->desc));
+    QVector<PackageUserData> byId(pkgs->size());
+    for (const PackageUserData& data : userData) {
+        PackageId id = pkgs->find(data.packageName);
+        if (id >= 0) {
+            byId[id] = data;
         }
-        p.optDepends << optdep;
     }
-    
-    // Required by (reverse dependencies)
-    alpm_list_t* requiredby = alpm_pkg_compute_requiredby(pkg);
-    for (alpm_list_t* i = requiredby; i; i = alpm_list_next(i)) {
-        p.requiredBy << QString::fromUtf8(static_cast<const char*>(i->data));
+    return StoreSnapshot::save(path, *pkgs, key, userDataStamp, byId);
+}
+
+std::shared_ptr<const PackageStore> PackageManager::cachedStore() const {
+    QMutexLocker locker(&m_stateMutex);
+    if (m_store && m_store->generation() == m_generation) {
+        return m_store;
     }
-    FREELIST(requiredby);
-    
-    // Optional for
-    alpm_list_t* optionalfor = alpm_pkg_compute_optionalfor(pkg);
-    for (alpm_list_t* i = optionalfor; i; i = alpm_list_next(i)) {
-        p.optionalFor << QString::fromUtf8(static_cast<const char*>(i->data));
+    return nullptr;
+}
+
+std::shared_ptr<const PackageStatistics> PackageManager::cachedStatistics() const {
+    QMutexLocker locker(&m_stateMutex);
+    if (m_statistics && m_statistics->generation == m_generation) {
+        return m_statistics;
     }
-    FREELIST(optionalfor);
-    
-    // Provides
-    alpm_list_t* provides = alpm_pkg_get_provides(pkg);
-    for (alpm_list_t* i = provides; i; i = alpm_list_next(i)) {
-        alpm_depend_t* prov = static_cast<alpm_depend_t*>(i->data);
-        p.provides << QString::fromUtf8(prov->name);
+    return nullptr;
+}
+
+std::shared_ptr<const PackageStore> PackageManager::loadStoreLocked(const PackageStore::Progress& progress,
+                                                                    FileOwnerIndex::Builder* files) {
+    if (std::shared_ptr<const PackageStore> cached = cachedStore()) {
+        return cached;
     }
     
-    // Conflicts
-    alpm_list_t* conflicts = alpm_pkg_get_conflicts(pkg);
-    for (alpm_list_t* i = conflicts; i; i = alpm_list_next(i)) {
-        alpm_depend_t* conf = static_cast<alpm_depend_t*>(i->data);
-        p.conflicts << QString::fromUtf8(conf->name);
+    if (!m_initialized) {
+        return std::make_shared<const PackageStore>(m_generation);
     }
     
-    // Replaces
-    alpm_list_t* replaces = alpm_pkg_get_replaces(pkg);
-    for (alpm_list_t* i = replaces; i; i = alpm_list_next(i)) {
-        alpm_depend_t* rep = static_cast<alpm_depend_t*>(i->data);
-        p.replaces << QString::fromUtf8(rep->name);
+    // Taken first: a change during the load then shows up as a stale key
+    StoreSnapshot::Key key = StoreSnapshot::currentKey(m_dbPath);
+    
+    // Parse the local db directly, in parallel; libalpm is the fallback
+    LocalDbReader reader(QDir(m_dbPath).filePath("local"));
+    std::shared_ptr<const PackageStore> loaded = reader.load(m_generation, progress, files);
+    if (!loaded) {
+        if (reader.isCanceled()) return nullptr;
+        loaded = PackageStore::fromAlpm(m_localDb, m_generation, progress);
+        if (!loaded) return nullptr;  // canceled
     }
     
-    return p;
+    QMutexLocker locker(&m_stateMutex);
+    m_store = loaded;
+    m_storeKey = key;
+    return loaded;
 }
 
-QList<Package> PackageManager::getAllPackages() {
-    QList<Package> packages;
-    if (!m_initialized) return packages;
-    
-    alpm_list_t* pkgcache = alpm_db_get_pkgcache(m_localDb);
-    for (alpm_list_t* i = pkgcache; i; i = alpm_list_next(i)) {
-        alpm_pkg_t* pkg = static_cast<alpm_pkg_t*>(i->data);
-        packages.append(alpmPackageToPackage(pkg));
+std::shared_ptr<const PackageStatistics> PackageManager::loadStatisticsLocked(const PackageStore::Progress& progress) {
+    if (std::shared_ptr<const PackageStatistics> cached = cachedStatistics()) {
+        return cached;
     }
     
-    return packages;
+    std::shared_ptr<const PackageStore> pkgs = loadStoreLocked(progress);
+    if (!pkgs) return nullptr;  // canceled
+    
+    auto stats = std::make_shared<const PackageStatistics>(PackageStatistics::compute(*pkgs));
+    QMutexLocker locker(&m_stateMutex);
+    m_statistics = stats;
+    return stats;
 }
 
-QList<Package> PackageManager::getExplicitPackages() {
-    QList<Package> packages;
-    if (!m_initialized) return packages;
-    
-    alpm_list_t* pkgcache = alpm_db_get_pkgcache(m_localDb);
-    for (alpm_list_t* i = pkgcache; i; i = alpm_list_next(i)) {
-        alpm_pkg_t* pkg = static_cast<alpm_pkg_t*>(i->data);
-        if (alpm_pkg_get_reason(pkg) == ALPM_PKG_REASON_EXPLICIT) {
-            packages.append(alpmPackageToPackage(pkg));
-        }
+std::shared_ptr<const PackageStore> PackageManager::store() {
+    if (std::shared_ptr<const PackageStore> cached = cachedStore()) {
+        return cached;
     }
     
-    return packages;
+    std::shared_ptr<const PackageStore> pkgs = resultOf(storeAsync());
+    return pkgs ? pkgs : std::make_shared<const PackageStore>(m_generation);
 }
 
-QList<Package> PackageManager::getDependencyPackages() {
-    QList<Package> packages;
-    if (!m_initialized) return packages;
-    
-    alpm_list_t* pkgcache = alpm_db_get_pkgcache(m_localDb);
-    for (alpm_list_t* i = pkgcache; i; i = alpm_list_next(i)) {
-        alpm_pkg_t* pkg = static_cast<alpm_pkg_t*>(i->data);
-        if (alpm_pkg_get_reason(pkg) == ALPM_PKG_REASON_DEPEND) {
-            packages.append(alpmPackageToPackage(pkg));
+QFuture<std::shared_ptr<const PackageStore>> PackageManager::storeAsync() {
+    using Result = std::shared_ptr<const PackageStore>;
+    return runOnAlpmThread<Result>([this](QPromise<Result>& promise) {
+        Result pkgs = loadStoreLocked(progressOf(promise));
+        if (pkgs) {
+            promise.addResult(pkgs);
         }
+    });
+}
+
+std::shared_ptr<const PackageStatistics> PackageManager::statistics() {
+    if (std::shared_ptr<const PackageStatistics> cached = cachedStatistics()) {
+        return cached;
     }
     
-    return packages;
+    std::shared_ptr<const PackageStatistics> stats = resultOf(statisticsAsync());
+    return stats ? stats : std::make_shared<const PackageStatistics>();
+}
+
+QFuture<std::shared_ptr<const PackageStatistics>> PackageManager::statisticsAsync() {
+    using Result = std::shared_ptr<const PackageStatistics>;
+    return runOnAlpmThread<Result>([this](QPromise<Result>& promise) {
+        Result stats = loadStatisticsLocked(progressOf(promise));
+        if (stats) {
+            promise.addResult(stats);
+        }
+    });
 }
 
-QList<Package> PackageManager::getOrphanPackages() {
-    QList<Package> packages;
-    if (!m_initialized) return packages;
+QFuture<QList<PackageSummary>> PackageManager::filterPackagesAsync(PackageFilter accept) {
+    return runOnAlpmThread<QList<PackageSummary>>([this, accept](QPromise<QList<PackageSummary>>& promise) {
+        QList<PackageSummary> packages;
+        if (!m_initialized) {
+            promise.addResult(packages);
+            return;
+        }
     
-    alpm_list_t* pkgcache = alpm_db_get_pkgcache(m_localDb);
-    for (alpm_list_t* i = pkgcache; i; i = alpm_list_next(i)) {
-        alpm_pkg_t* pkg = static_cast<alpm_pkg_t*>(i->data);
-        
-        // Orphan = installed as dependency but nothing requires it
-        if (alpm_pkg_get_reason(pkg) == ALPM_PKG_REASON_DEPEND) {
-            alpm_list_t* requiredby = alpm_pkg_compute_requiredby(pkg);
-            alpm_list_t* optionalfor = alpm_pkg_compute_optionalfor(pkg);
-            
-            if (!requiredby && !optionalfor) {
-                packages.append(alpmPackageToPackage(pkg));
+        std::shared_ptr<const PackageStore> pkgs = loadStoreLocked(progressOf(promise));
+        if (!pkgs) return;  // canceled
+    
+        // Second pass over the same range: materializing matches
+        promise.setProgressRange(0, pkgs->size());
+        for (PackageId id = 0; id < pkgs->size(); ++id) {
+            if ((id & 0xff) == 0) {
+                if (promise.isCanceled()) return;
+                promise.setProgressValue(id);
+            }
+            if (accept(*pkgs, id)) {
+                packages.append(pkgs->summary(id));
             }
-            
-            FREELIST(requiredby);
-            FREELIST(optionalfor);
         }
+        promise.setProgressValue(pkgs->size());
+        promise.addResult(packages);
+    });
+}
+
+QFuture<QList<PackageSummary>> PackageManager::getAllPackagesAsync() {
+    return filterPackagesAsync([](const PackageStore&, PackageId) {
+        return true;
+    });
+}
+
+QFuture<QList<PackageSummary>> PackageManager::getExplicitPackagesAsync() {
+    return filterPackagesAsync([](const PackageStore& pkgs, PackageId id) {
+        return pkgs.isExplicit(id);
+    });
+}
+
+QFuture<QList<PackageSummary>> PackageManager::getDependencyPackagesAsync() {
+    return filterPackagesAsync([](const PackageStore& pkgs, PackageId id) {
+        return !pkgs.isExplicit(id);
+    });
+}
+
+QFuture<QList<PackageSummary>> PackageManager::getOrphanPackagesAsync() {
+    // Orphan = installed as dependency but nothing requires it
+    return filterPackagesAsync([](const PackageStore& pkgs, PackageId id) {
+        return pkgs.isOrphan(id);
+    });
+}
+
+QFuture<QList<PackageSummary>> PackageManager::searchPackagesAsync(const QString& query) {
+    if (query.isEmpty()) {
+        return QtFuture::makeReadyFuture(QList<PackageSummary>());
     }
     
-    return packages;
+    return runOnAlpmThread<QList<PackageSummary>>([this, query](QPromise<QList<PackageSummary>>& promise) {
+        QList<PackageSummary> packages;
+        if (!m_initialized) {
+            promise.addResult(packages);
+            return;
+        }
+    
+        std::shared_ptr<const PackageStore> pkgs = loadStoreLocked(progressOf(promise));
+        std::shared_ptr<const TrigramIndex> index = pkgs ? loadSearchIndexLocked(progressOf(promise)) : nullptr;
+        if (!index) return;  // canceled
+    
+        for (PackageId id : index->search(query)) {
+            packages.append(pkgs->summary(id));
+        }
+        promise.addResult(packages);
+    });
 }
 
-QList<Package> PackageManager::searchPackages(const QString& query) {
-    QList<Package> packages;
-    if (!m_initialized || query.isEmpty()) return packages;
+std::shared_ptr<const TrigramIndex> PackageManager::loadSearchIndexLocked(const PackageStore::Progress& progress) {
+    std::shared_ptr<const TrigramIndex> previous;
+    {
+        QMutexLocker locker(&m_stateMutex);
+        if (m_searchIndex && m_searchIndex->generation() == m_generation) {
+            return m_searchIndex;
+        }
+        previous = m_searchIndex;
+    }
     
-    QString lowerQuery = query.toLower();
+    std::shared_ptr<const PackageStore> pkgs = loadStoreLocked(progress);
+    if (!pkgs) return nullptr;  // canceled
     
-    alpm_list_t* pkgcache = alpm_db_get_pkgcache(m_localDb);
-    for (alpm_list_t* i = pkgcache; i; i = alpm_list_next(i)) {
-        alpm_pkg_t* pkg = static_cast<alpm_pkg_t*>(i->data);
-        
-        QString name = QString::fromUtf8(alpm_pkg_get_name(pkg)).toLower();
-        QString desc = QString::fromUtf8(alpm_pkg_get_desc(pkg)).toLower();
-        
-        if (name.contains(lowerQuery) || desc.contains(lowerQuery)) {
-            packages.append(alpmPackageToPackage(pkg));
+    // Published indexes are immutable; the copy shares posting lists with
+    // the previous one and update() only touches packages that changed
+    auto index = previous ? std::make_shared<TrigramIndex>(*previous) : std::make_shared<TrigramIndex>();
+    index->update(*pkgs);
+    
+    QMutexLocker locker(&m_stateMutex);
+    m_searchIndex = index;
+    return index;
+}
+
+QFuture<Package> PackageManager::getPackageInfoAsync(const QString& name) {
+    return runOnAlpmThread<Package>([this, name](QPromise<Package>& promise) {
+        if (!m_initialized) {
+            promise.addResult(Package());
+            return;
         }
-    }
     
-    return packages;
+        std::shared_ptr<const PackageStore> pkgs = loadStoreLocked(progressOf(promise));
+        if (pkgs) {
+            promise.addResult(pkgs->package(pkgs->find(name)));
+        }
+    });
+}
+
+QList<PackageSummary> PackageManager::getAllPackages() {
+    return resultOf(getAllPackagesAsync());
+}
+
+QList<PackageSummary> PackageManager::getExplicitPackages() {
+    return resultOf(getExplicitPackagesAsync());
+}
+
+QList<PackageSummary> PackageManager::getDependencyPackages() {
+    return resultOf(getDependencyPackagesAsync());
+}
+
+QList<PackageSummary> PackageManager::getOrphanPackages() {
+    return resultOf(getOrphanPackagesAsync());
+}
+
+QList<PackageSummary> PackageManager::searchPackages(const QString& query) {
+    return resultOf(searchPackagesAsync(query));
 }
 
 Package PackageManager::getPackageInfo(const QString& name) {
-    Package p;
-    if (!m_initialized) return p;
+    if (!m_initialized) return Package();
     
-    alpm_pkg_t* pkg = alpm_db_get_pkg(m_localDb, name.toUtf8().constData());
-    if (pkg) {
-        p = alpmPackageToPackage(pkg);
-    }
-    
-    return p;
+    // Reads the immutable store on the calling thread
+    std::shared_ptr<const PackageStore> pkgs = store();
+    return pkgs->package(pkgs->find(name));
 }
 
 bool PackageManager::packageExists(const QString& name) {
     if (!m_initialized) return false;
-    return alpm_db_get_pkg(m_localDb, name.toUtf8().constData()) != nullptr;
+    return store()->contains(name);
 }
 
 QStringList PackageManager::getDependencies(const QString& packageName) {
-    Package pkg = getPackageInfo(packageName);
-    return pkg.depends;
+    if (!m_initialized) return QStringList();
+    
+    std::shared_ptr<const PackageStore> pkgs = store();
+    PackageId id = pkgs->find(packageName);
+    return id >= 0 ? pkgs->depends(id) : QStringList();
 }
 
 QStringList PackageManager::getReverseDependencies(const QString& packageName) {
-    Package pkg = getPackageInfo(packageName);
-    return pkg.requiredBy;
+    if (!m_initialized) return QStringList();
+    
+    std::shared_ptr<const PackageStore> pkgs = store();
+    PackageId id = pkgs->find(packageName);
+    return id >= 0 ? pkgs->requiredBy(id) : QStringList();
 }
 
 QMap<QString, QStringList> PackageManager::getDependencyTree(const QString& packageName, int depth) {
     QMap<QString, QStringList> tree;
     if (!m_initialized || depth <= 0) return tree;
     
-    QStringList deps = getDependencies(packageName);
-    tree[packageName] = deps;
-    
-    if (depth > 1) {
-        for (const QString& dep : deps) {
-            if (!tree.contains(dep)) {
-                QMap<QString, QStringList> subtree = getDependencyTree(dep, depth - 1);
-                for (auto it = subtree.begin(); it != subtree.end(); ++it) {
-                    if (!tree.contains(it.key())) {
-                        tree[it.key()] = it.value();
-                    }
-                }
-            }
+    std::shared_ptr<const PackageStore> pkgs = store();
+    PackageId root = pkgs->find(packageName);
+    if (root < 0) {
+        tree.insert(packageName, QStringList());
+        return tree;
+    }
+    
+    // Every package up to depth - 1 edges away lists its direct
+    // dependencies, resolved through provides ("sh" -> bash)
+    const DependencyGraph& graph = pkgs->graph();
+    for (PackageId id : graph.traverse(root, DependencyGraph::Dependencies, depth - 1)) {
+        QStringList deps;
+        for (PackageId dep : graph.dependencies(id)) {
+            deps.append(pkgs->name(dep));
         }
+        tree.insert(pkgs->name(id), deps);
     }
     
     return tree;
@@ -283,82 +497,210 @@ QMap<QString, QStringList> PackageManager::getDependencyTree(const QString& pack
 
 int PackageManager::totalPackageCount() {
     if (!m_initialized) return 0;
-    return alpm_list_count(alpm_db_get_pkgcache(m_localDb));
+    return statistics()->totalCount;
 }
 
 int PackageManager::explicitPackageCount() {
-    return getExplicitPackages().size();
+    if (!m_initialized) return 0;
+    return statistics()->explicitCount;
 }
 
 int PackageManager::dependencyPackageCount() {
-    return getDependencyPackages().size();
+    if (!m_initialized) return 0;
+    return statistics()->dependencyCount;
 }
 
 int PackageManager::orphanPackageCount() {
-    return getOrphanPackages().size();
+    if (!m_initialized) return 0;
+    return statistics()->orphanCount;
 }
 
 qint64 PackageManager::totalInstalledSize() {
-    qint64 total = 0;
-    if (!m_initialized) return total;
-    
-    alpm_list_t* pkgcache = alpm_db_get_pkgcache(m_localDb);
-    for (alpm_list_t* i = pkgcache; i; i = alpm_list_next(i)) {
-        alpm_pkg_t* pkg = static_cast<alpm_pkg_t*>(i->data);
-        total += alpm_pkg_get_isize(pkg);
-    }
-    
-    return total;
+    if (!m_initialized) return 0;
+    return statistics()->totalSize;
 }
 
 QMap<QString, qint64> PackageManager::getSizeByPackage() {
     QMap<QString, qint64> sizes;
     if (!m_initialized) return sizes;
     
-    alpm_list_t* pkgcache = alpm_db_get_pkgcache(m_localDb);
-    for (alpm_list_t* i = pkgcache; i; i = alpm_list_next(i)) {
-        alpm_pkg_t* pkg = static_cast<alpm_pkg_t*>(i->data);
-        QString name = QString::fromUtf8(alpm_pkg_get_name(pkg));
-        sizes[name] = alpm_pkg_get_isize(pkg);
+    std::shared_ptr<const PackageStore> pkgs = store();
+    for (PackageId id = 0; id < pkgs->size(); ++id) {
+        sizes[pkgs->name(id)] = pkgs->installedSize(id);
     }
     
     return sizes;
 }
 
 QString PackageManager::getPackageOwningFile(const QString& filePath) {
-    if (!m_initialized) return QString();
+    return resultOf(getPackageOwningFileAsync(filePath));
+}
+
+QFuture<QString> PackageManager::getPackageOwningFileAsync(const QString& filePath) {
+    return runOnAlpmThread<QString>([this, filePath](QPromise<QString>& promise) {
+        if (!m_initialized) {
+            promise.addResult(QString());
+            return;
+        }
+    
+        std::shared_ptr<const PackageStore> pkgs = loadStoreLocked(progressOf(promise));
+        std::shared_ptr<const FileOwnerIndex> index = pkgs ? loadFileIndexLocked(progressOf(promise)) : nullptr;
+        if (!index) return;  // canceled
+    
+        PackageId owner = index->owner(filePath);
+        promise.addResult(owner >= 0 ? pkgs->name(owner) : QString());
+    });
+}
+
+QFuture<std::shared_ptr<const FileOwnerIndex>> PackageManager::fileIndexAsync() {
+    using Result = std::shared_ptr<const FileOwnerIndex>;
+    return runOnAlpmThread<Result>([this](QPromise<Result>& promise) {
+        Result index = loadFileIndexLocked(progressOf(promise));
+        if (index) {
+            promise.addResult(index);
+        }
+    });
+}
+
+std::shared_ptr<const FileOwnerIndex> PackageManager::loadFileIndexLocked(const PackageStore::Progress& progress) {
+    {
+        QMutexLocker locker(&m_stateMutex);
+        if (m_fileIndex && m_fileIndex->generation() == m_generation) {
+            return m_fileIndex;
+        }
+    }
     
+    // A store that isn't loaded yet collects the paths in the same pass
+    // over the local db
+    FileOwnerIndex::Builder builder;
+    std::shared_ptr<const PackageStore> pkgs = loadStoreLocked(progress, &builder);
+    if (!pkgs) return nullptr;  // canceled
+    
+    if (builder.isEmpty() && m_initialized) {
+        // Already loaded, or from a snapshot or libalpm: read just the file
+        // lists, in parallel, and fall back to libalpm's
+        LocalDbReader reader(QDir(m_dbPath).filePath("local"));
+        if (!reader.loadFiles(*pkgs, builder, progress)) {
+            if (reader.isCanceled()) return nullptr;
+            if (!loadAlpmFilesLocked(*pkgs, builder, progress)) return nullptr;  // canceled
+        }
+    }
+    
+    auto index = std::make_shared<const FileOwnerIndex>(builder.build(pkgs->generation()));
+    QMutexLocker locker(&m_stateMutex);
+    m_fileIndex = index;
+    return index;
+}
+
+bool PackageManager::loadAlpmFilesLocked(const PackageStore& pkgs, FileOwnerIndex::Builder& builder,
+                                         const PackageStore::Progress& progress) {
+    // One pass over libalpm's file lists; paths are copied into a single
+    // arena and only turned into QStrings when a caller asks
     alpm_list_t* pkgcache = alpm_db_get_pkgcache(m_localDb);
+    const int total = static_cast<int>(alpm_list_count(pkgcache));
+    builder.reserve(total * 400, qint64(total) * 400 * 48);
+    if (progress && !progress(0, total)) return false;
+    
+    int done = 0;
     for (alpm_list_t* i = pkgcache; i; i = alpm_list_next(i)) {
         alpm_pkg_t* pkg = static_cast<alpm_pkg_t*>(i->data);
+        PackageId owner = pkgs.find(QString::fromUtf8(alpm_pkg_get_name(pkg)));
         alpm_filelist_t* filelist = alpm_pkg_get_files(pkg);
-        
-        for (size_t j = 0; j < filelist->count; j++) {
-            QString pkgFile = QString("/") + QString::fromUtf8(filelist->files[j].name);
-            if (pkgFile == filePath) {
-                return QString::fromUtf8(alpm_pkg_get_name(pkg));
-            }
+        for (size_t j = 0; filelist && j < filelist->count; j++) {
+            builder.add(QByteArrayView(filelist->files[j].name), owner);
         }
-    }
     
-    return QString();
+        ++done;
+        if (progress && (done & 0xff) == 0 && !progress(done, total)) return false;
+    }
+    if (progress) progress(total, total);
+    return true;
 }
 
-QStringList PackageManager::getPackageFiles(const QString& packageName) {
-    QStringList files;
-    if (!m_initialized) return files;
+QFuture<std::shared_ptr<const SyncCatalogue>> PackageManager::syncCatalogueAsync() {
+    using Result = std::shared_ptr<const SyncCatalogue>;
+    return runOnAlpmThread<Result>([this](QPromise<Result>& promise) {
+        promise.addResult(loadSyncCatalogueLocked());
+    });
+}
+
+std::shared_ptr<const SyncCatalogue> PackageManager::loadSyncCatalogueLocked() {
+    std::shared_ptr<const SyncCatalogue> previous;
+    {
+        QMutexLocker locker(&m_stateMutex);
+        previous = m_syncCatalogue;
+    }
+    // A few stat() calls; pacman -Sy rewrites the db files it updates
+    if (previous && previous->isCurrent()) {
+        return previous;
+    }
+    
+    QString error;
+    std::shared_ptr<const SyncCatalogue> catalogue = SyncCatalogue::load(
+        QDir(m_dbPath).filePath("sync"), PacmanConfig::getRepositories(), previous.get(), &error);
+    if (!error.isEmpty()) {
+        setError(error);  // some or all repositories unreadable
+    }
+    if (!catalogue) {
+        return nullptr;
+    }
     
-    alpm_pkg_t* pkg = alpm_db_get_pkg(m_localDb, packageName.toUtf8().constData());
-    if (!pkg) return files;
+    QMutexLocker locker(&m_stateMutex);
+    m_syncCatalogue = catalogue;
+    return catalogue;
+}
+
+QFuture<std::shared_ptr<const FilesDatabase>> PackageManager::filesDatabaseAsync() {
+    using Result = std::shared_ptr<const FilesDatabase>;
+    return runOnAlpmThread<Result>([this](QPromise<Result>& promise) {
+        promise.addResult(loadFilesDatabaseLocked());
+    });
+}
+
+std::shared_ptr<const FilesDatabase> PackageManager::loadFilesDatabaseLocked() {
+    {
+        QMutexLocker locker(&m_stateMutex);
+        if (m_filesDatabase && m_filesDatabase->isCurrent()) {
+            return m_filesDatabase;
+        }
+    }
     
-    alpm_filelist_t* filelist = alpm_pkg_get_files(pkg);
-    for (size_t i = 0; i < filelist->count; i++) {
-        files << QString("/") + QString::fromUtf8(filelist->files[i].name);
+    // Maps the index left by an earlier run, or rebuilds it after pacman -Fy
+    QString error;
+    std::shared_ptr<const FilesDatabase> files = FilesDatabase::open(
+        QDir(m_dbPath).filePath("sync"), PacmanConfig::getRepositories(), FilesDatabase::defaultPath(), &error);
+    if (!files) {
+        setError(error);
+        return nullptr;
     }
     
+    QMutexLocker locker(&m_stateMutex);
+    m_filesDatabase = files;
     return files;
 }
 
+QStringList PackageManager::getPackageFiles(const QString& packageName) {
+    return resultOf(getPackageFilesAsync(packageName));
+}
+
+QFuture<QStringList> PackageManager::getPackageFilesAsync(const QString& packageName) {
+    return runOnAlpmThread<QStringList>([this, packageName](QPromise<QStringList>& promise) {
+        QStringList files;
+        alpm_pkg_t* pkg = m_initialized
+            ? alpm_db_get_pkg(m_localDb, packageName.toUtf8().constData())
+            : nullptr;
+    
+        if (pkg) {
+            alpm_filelist_t* filelist = alpm_pkg_get_files(pkg);
+            for (size_t i = 0; i < filelist->count; i++) {
+                files << QString("/") + QString::fromUtf8(filelist->files[i].name);
+            }
+        }
+    
+        promise.addResult(files);
+    });
+}
+
 bool PackageManager::removePackage(const QString& name, bool cascade) {
     // This requires root privileges - implement with polkit or pkexec
     emit operationError("Package removal requires root privileges. Use 'sudo pacman -R " + name + "'");
@@ -375,7 +717,15 @@ bool PackageManager::cleanCache(bool keepInstalled) {
     return false;
 }
 
+QString PackageManager::lastError() const {
+    QMutexLocker locker(&m_stateMutex);
+    return m_lastError;
+}
+
 void PackageManager::setError(const QString& error) {
-    m_lastError = error;
+    {
+        QMutexLocker locker(&m_stateMutex);
+        m_lastError = error;
+    }
     qWarning() << "PackageManager error:" << error;
 }
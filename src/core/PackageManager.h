@@ -2,16 +2,38 @@
 #define PACKAGEMANAGER_H
 
 #include <QObject>
+#include <QFuture>
 #include <QList>
 #include <QMap>
+#include <QMutex>
+#include <QPromise>
 #include <QString>
+#include <QThreadPool>
+#include <atomic>
+#include <functional>
 #include <memory>
 #include <alpm.h>
 #include "models/Package.h"
+#include "PackageStore.h"
+#include "PackageStatistics.h"
+#include "LocalDbWatcher.h"
+#include "StoreSnapshot.h"
+#include "FileOwnerIndex.h"
+#include "TrigramIndex.h"
+#include "SyncCatalogue.h"
+#include "FilesDatabase.h"
 
+// Owns the libalpm handle. libalpm is not thread-safe, so all access to it
+// runs on one dedicated worker thread, in submission order. The *Async
+// methods return immediately; their futures report progress in packages
+// processed and stop early when canceled. The blocking methods are thin
+// wrappers that wait for the same work.
+//
+// PackageStore and PackageStatistics snapshots are immutable, so once
+// loaded they can be read from any thread without going through the worker.
 class PackageManager : public QObject {
     Q_OBJECT
-    
+
 public:
     explicit PackageManager(QObject* parent = nullptr);
     ~PackageManager();
@@ -20,20 +42,73 @@ public:
     bool initialize();
     void refresh();  // Re-read database
     bool isInitialized() const { return m_initialized; }
-    QString lastError() const { return m_lastError; }
-    
-    // Package queries
-    QList<Package> getAllPackages();
-    QList<Package> getExplicitPackages();
-    QList<Package> getDependencyPackages();
-    QList<Package> getOrphanPackages();
-    QList<Package> searchPackages(const QString& query);
+    QString lastError() const;
+    
+    // Bumped every time the database is (re)loaded; derived caches key on it
+    quint64 generation() const { return m_generation; }
+    
+    // Columnar snapshot of the local database for the current generation.
+    // Views hold on to the pointer and read packages by id.
+    std::shared_ptr<const PackageStore> store();
+    
+    // Counts, sizes, install histogram and largest packages, computed in one
+    // pass over store() and cached for the generation
+    std::shared_ptr<const PackageStatistics> statistics();
+    
+    // Returns what the watcher saw change since the last load. If anything
+    // did, the reload runs on the alpm thread and localPackagesChanged is
+    // emitted once it's done. Cheap to call after any transaction.
+    LocalDbChanges syncLocalChanges();
+    
+    // Startup snapshot. loadSnapshot() adopts a store saved by a previous
+    // session as the current one, so views can render before the local db
+    // is read; userData comes back indexed by package id. validateSnapshot()
+    // then checks it against the db on the alpm thread and, if packages
+    // changed meanwhile, reloads and emits localPackagesChanged.
+    bool loadSnapshot(const QString& path, qint64* userDataStamp, QVector<PackageUserData>* userData);
+    void validateSnapshot();
+    bool saveSnapshot(const QString& path, qint64 userDataStamp, const QList<PackageUserData>& userData);
+    
+    // Asynchronous API
+    QFuture<bool> initializeAsync();
+    QFuture<void> refreshAsync();  // also preloads the new store
+    QFuture<std::shared_ptr<const PackageStore>> storeAsync();
+    QFuture<std::shared_ptr<const PackageStatistics>> statisticsAsync();
+    QFuture<QList<PackageSummary>> getAllPackagesAsync();
+    QFuture<QList<PackageSummary>> getExplicitPackagesAsync();
+    QFuture<QList<PackageSummary>> getDependencyPackagesAsync();
+    QFuture<QList<PackageSummary>> getOrphanPackagesAsync();
+    QFuture<QList<PackageSummary>> searchPackagesAsync(const QString& query);
+    QFuture<Package> getPackageInfoAsync(const QString& name);
+    QFuture<QString> getPackageOwningFileAsync(const QString& filePath);
+    QFuture<QStringList> getPackageFilesAsync(const QString& packageName);
+    
+    // Path -> owner index over every installed file, built on first use per
+    // generation. Ids refer to store() of the same generation.
+    QFuture<std::shared_ptr<const FileOwnerIndex>> fileIndexAsync();
+    
+    // Every package in the sync databases, read without pacman and kept
+    // until a db file changes. nullptr result if no db could be read.
+    QFuture<std::shared_ptr<const SyncCatalogue>> syncCatalogueAsync();
+    
+    // Which repo packages contain which files, from the .files dbs. The
+    // index is built on first use after pacman -Fy, then only mapped.
+    QFuture<std::shared_ptr<const FilesDatabase>> filesDatabaseAsync();
+    
+    // Package queries. Lists carry summaries; getPackageInfo() has everything.
+    QList<PackageSummary> getAllPackages();
+    QList<PackageSummary> getExplicitPackages();
+    QList<PackageSummary> getDependencyPackages();
+    QList<PackageSummary> getOrphanPackages();
+    QList<PackageSummary> searchPackages(const QString& query);
     Package getPackageInfo(const QString& name);
     bool packageExists(const QString& name);
     
     // Dependency information
     QStringList getDependencies(const QString& packageName);
     QStringList getReverseDependencies(const QString& packageName);
+    // Installed packages within depth levels of packageName, each mapped to
+    // its direct dependencies; unsatisfied dependencies are left out
     QMap<QString, QStringList> getDependencyTree(const QString& packageName, int depth = 3);
     
     // Statistics
@@ -52,24 +127,70 @@ public:
     // File ownership
     QString getPackageOwningFile(const QString& filePath);
     QStringList getPackageFiles(const QString& packageName);
-    
+
 signals:
     void packagesChanged();
+    void localPackagesChanged(const LocalDbChanges& changes);  // store() is already reloaded
     void operationProgress(const QString& message, int percent);
     void operationError(const QString& error);
     void operationCompleted(bool success, const QString& message);
-    
+
+private slots:
+    void onLocalDbChanged(const LocalDbChanges& changes);
+
 private:
-    Package alpmPackageToPackage(alpm_pkg_t* pkg);
+    using PackageFilter = std::function<bool(const PackageStore&, PackageId)>;
+    
+    // Runs task(promise) on the alpm thread
+    template <typename T>
+    QFuture<T> runOnAlpmThread(std::function<void(QPromise<T>&)> task);
+    QFuture<QList<PackageSummary>> filterPackagesAsync(PackageFilter accept);
+    
+    // Worker side; callers hold m_alpmMutex
+    bool initializeLocked();
+    void releaseLocked();
+    // A store read from the local db here also adds its paths to files
+    std::shared_ptr<const PackageStore> loadStoreLocked(const PackageStore::Progress& progress,
+                                                        FileOwnerIndex::Builder* files = nullptr);
+    std::shared_ptr<const PackageStatistics> loadStatisticsLocked(const PackageStore::Progress& progress);
+    std::shared_ptr<const FileOwnerIndex> loadFileIndexLocked(const PackageStore::Progress& progress);
+    bool loadAlpmFilesLocked(const PackageStore& pkgs, FileOwnerIndex::Builder& builder,
+                             const PackageStore::Progress& progress);
+    std::shared_ptr<const TrigramIndex> loadSearchIndexLocked(const PackageStore::Progress& progress);
+    std::shared_ptr<const SyncCatalogue> loadSyncCatalogueLocked();
+    std::shared_ptr<const FilesDatabase> loadFilesDatabaseLocked();
+    
+    std::shared_ptr<const PackageStore> cachedStore() const;
+    std::shared_ptr<const PackageStatistics> cachedStatistics() const;
+    
     alpm_list_t* getLocalDatabase();
     void setError(const QString& error);
     
+    // Single thread that owns the handle; runOnAlpmThread() tasks never run
+    // anywhere else. The mutex is held for each task and by the destructor.
+    QThreadPool m_alpmThread;
+    QMutex m_alpmMutex;
+    
     alpm_handle_t* m_handle = nullptr;
     alpm_db_t* m_localDb = nullptr;
-    bool m_initialized = false;
-    QString m_lastError;
+    std::atomic<bool> m_initialized{false};
     QString m_rootDir = "/";
     QString m_dbPath = "/var/lib/pacman/";
+    
+    std::atomic<quint64> m_generation{0};
+    
+    // Published results, read from any thread
+    mutable QMutex m_stateMutex;
+    QString m_lastError;
+    std::shared_ptr<const PackageStore> m_store;
+    StoreSnapshot::Key m_storeKey;  // db state m_store was read from
+    std::shared_ptr<const PackageStatistics> m_statistics;
+    std::shared_ptr<const FileOwnerIndex> m_fileIndex;
+    std::shared_ptr<const TrigramIndex> m_searchIndex;
+    std::shared_ptr<const SyncCatalogue> m_syncCatalogue;
+    std::shared_ptr<const FilesDatabase> m_filesDatabase;
+    
+    LocalDbWatcher* m_watcher = nullptr;
 };
 
 #endif // PACKAGEMANAGER_H
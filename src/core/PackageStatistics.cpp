@@ -0,0 +1,91 @@
+#include "PackageStatistics.h"
+#include "PackageStore.h"
+#include <QDateTime>
+#include <algorithm>
+
+namespace {
+
+// Keeps the topCount best ids seen so far as a heap whose front is the
+// first to be evicted
+template <typename Better>
+void offerTop(QVector<PackageId>& top, PackageId id, int topCount, Better better) {
+    if (topCount <= 0) return;
+    if (top.size() < topCount) {
+        top.append(id);
+        std::push_heap(top.begin(), top.end(), better);
+    } else if (better(id, top.front())) {
+        std::pop_heap(top.begin(), top.end(), better);
+        top.back() = id;
+        std::push_heap(top.begin(), top.end(), better);
+    }
+}
+
+} // namespace
+
+PackageStatistics PackageStatistics::compute(const PackageStore& store, int topCount) {
+    PackageStatistics stats;
+    stats.generation = store.generation();
+    stats.totalCount = store.size();
+
+    // Larger size first, then lower id, so ties keep cache (name) order
+    auto bigger = [&store](PackageId a, PackageId b) {
+        qint64 sa = store.installedSize(a);
+        qint64 sb = store.installedSize(b);
+        return sa != sb ? sa > sb : a < b;
+    };
+
+    auto biggerExclusive = [&store](PackageId a, PackageId b) {
+        qint64 sa = store.exclusiveSize(a);
+        qint64 sb = store.exclusiveSize(b);
+        return sa != sb ? sa > sb : a < b;
+    };
+
+    // Min-heaps of the topCount largest seen so far
+    stats.largest.reserve(topCount + 1);
+    stats.largestExclusive.reserve(topCount + 1);
+
+    // Packages from one transaction share an install date, so the month
+    // of the previous package is usually the right one
+    qint64 lastDate = -1;
+    int lastMonth = 0;
+
+    for (PackageId id = 0; id < store.size(); ++id) {
+        qint64 size = store.installedSize(id);
+        stats.totalSize += size;
+
+        if (store.isExplicit(id)) {
+            ++stats.explicitCount;
+            stats.explicitSize += size;
+        } else {
+            ++stats.dependencyCount;
+            stats.dependencySize += size;
+            if (!store.isRequired(id)) {
+                ++stats.orphanCount;
+                stats.orphanSize += size;
+                stats.orphans.append(id);
+            }
+        }
+
+        qint64 date = store.installDateSecs(id);
+        if (date != lastDate) {
+            QDate day = QDateTime::fromSecsSinceEpoch(date).date();
+            lastDate = date;
+            lastMonth = monthKey(day.year(), day.month());
+        }
+        ++stats.installsByMonth[lastMonth];
+
+        offerTop(stats.largest, id, topCount, bigger);
+        if (store.dominators().immediateDominator(id) < 0) {
+            offerTop(stats.largestExclusive, id, topCount, biggerExclusive);
+        }
+    }
+
+    std::sort_heap(stats.largest.begin(), stats.largest.end(), bigger);
+    std::sort_heap(stats.largestExclusive.begin(), stats.largestExclusive.end(), biggerExclusive);
+    std::sort(stats.orphans.begin(), stats.orphans.end(), bigger);
+    return stats;
+}
+
+QString PackageStatistics::monthLabel(int key) {
+    return QString("%1-%2").arg(key / 100, 4, 10, QChar('0')).arg(key % 100, 2, 10, QChar('0'));
+}
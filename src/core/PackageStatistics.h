@@ -0,0 +1,46 @@
+#ifndef PACKAGESTATISTICS_H
+#define PACKAGESTATISTICS_H
+
+#include <QMap>
+#include <QVector>
+#include "models/Package.h"
+
+class PackageStore;
+
+// Dashboard and status bar numbers for one PackageStore generation.
+//
+// Everything is filled in by a single pass over the store's columns, so
+// reading any count is free once PackageManager has cached the result.
+struct PackageStatistics {
+    quint64 generation = 0;
+
+    // Counts
+    int totalCount = 0;
+    int explicitCount = 0;
+    int dependencyCount = 0;
+    int orphanCount = 0;
+
+    // Installed sizes in bytes, per install reason
+    qint64 totalSize = 0;
+    qint64 explicitSize = 0;
+    qint64 dependencySize = 0;
+    qint64 orphanSize = 0;
+
+    // Installs per month, keyed yyyymm in local time (e.g. 202401)
+    QMap<int, int> installsByMonth;
+
+    // Package ids by installed size, largest first
+    QVector<PackageId> largest;   // top topCount packages
+    QVector<PackageId> orphans;   // every orphan
+
+    // Top topCount by exclusive size (PackageStore::exclusiveSize), among
+    // packages nothing dominates, so no bytes are counted twice
+    QVector<PackageId> largestExclusive;
+
+    static PackageStatistics compute(const PackageStore& store, int topCount = 10);
+
+    static int monthKey(int year, int month) { return year * 100 + month; }
+    static QString monthLabel(int key);  // "yyyy-MM"
+};
+
+#endif // PACKAGESTATISTICS_H
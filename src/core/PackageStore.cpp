@@ -0,0 +1,298 @@
+#include "PackageStore.h"
+
+namespace {
+
+QByteArrayView view(const char* str) {
+    return str ? QByteArrayView(str) : QByteArrayView();
+}
+
+void appendStrings(alpm_list_t* list, QList<QByteArrayView>& out) {
+    for (alpm_list_t* i = list; i; i = alpm_list_next(i)) {
+        out.append(view(static_cast<const char*>(i->data)));
+    }
+}
+
+void appendDependNames(alpm_list_t* list, QList<QByteArrayView>& out) {
+    for (alpm_list_t* i = list; i; i = alpm_list_next(i)) {
+        out.append(view(static_cast<alpm_depend_t*>(i->data)->name));
+    }
+}
+
+} // namespace
+
+void PackageStore::Record::clear() {
+    name = version = description = url = packager = architecture = QByteArrayView();
+    installedSize = downloadSize = installDate = buildDate = 0;
+    isExplicit = false;
+
+    // QList::clear() keeps the capacity, so reusing a Record avoids reallocating
+    for (QList<QByteArrayView>* list : {&groups, &licenses, &depends, &optDepends,
+                                        &provides, &conflicts, &replaces, &backup}) {
+        list->clear();
+    }
+}
+
+PackageStore::PackageStore(quint64 generation)
+    : m_generation(generation)
+{
+}
+
+std::shared_ptr<PackageStore> PackageStore::fromAlpm(alpm_db_t* db, quint64 generation,
+                                                    const Progress& progress) {
+    auto store = std::make_shared<PackageStore>(generation);
+    if (!db) {
+        store->finalize();
+        return store;
+    }
+
+    alpm_list_t* pkgcache = alpm_db_get_pkgcache(db);
+    const int total = static_cast<int>(alpm_list_count(pkgcache));
+    store->reserve(total);
+    if (progress && !progress(0, total)) return nullptr;
+
+    Record record;
+    QList<QByteArray> optDependText;  // backs record.optDepends for one package
+
+    for (alpm_list_t* i = pkgcache; i; i = alpm_list_next(i)) {
+        alpm_pkg_t* pkg = static_cast<alpm_pkg_t*>(i->data);
+        record.clear();
+        optDependText.clear();
+
+        record.name = view(alpm_pkg_get_name(pkg));
+        record.version = view(alpm_pkg_get_version(pkg));
+        record.description = view(alpm_pkg_get_desc(pkg));
+        record.url = view(alpm_pkg_get_url(pkg));
+        record.packager = view(alpm_pkg_get_packager(pkg));
+        record.architecture = view(alpm_pkg_get_arch(pkg));
+
+        record.installedSize = alpm_pkg_get_isize(pkg);
+        record.downloadSize = alpm_pkg_get_size(pkg);
+        record.installDate = alpm_pkg_get_installdate(pkg);
+        record.buildDate = alpm_pkg_get_builddate(pkg);
+        record.isExplicit = alpm_pkg_get_reason(pkg) == ALPM_PKG_REASON_EXPLICIT;
+
+        appendStrings(alpm_pkg_get_groups(pkg), record.groups);
+        appendStrings(alpm_pkg_get_licenses(pkg), record.licenses);
+        appendDependNames(alpm_pkg_get_depends(pkg), record.depends);
+        appendDependNames(alpm_pkg_get_provides(pkg), record.provides);
+        appendDependNames(alpm_pkg_get_conflicts(pkg), record.conflicts);
+        appendDependNames(alpm_pkg_get_replaces(pkg), record.replaces);
+        for (alpm_list_t* j = alpm_pkg_get_backup(pkg); j; j = alpm_list_next(j)) {
+            record.backup.append(view(static_cast<alpm_backup_t*>(j->data)->name));
+        }
+
+        for (alpm_list_t* j = alpm_pkg_get_optdepends(pkg); j; j = alpm_list_next(j)) {
+            alpm_depend_t* dep = static_cast<alpm_depend_t*>(j->data);
+            QByteArray text(dep->name);
+            if (dep->desc) {
+                text += ": ";
+                text += dep->desc;
+            }
+            optDependText.append(text);
+            record.optDepends.append(optDependText.last());
+        }
+
+        store->append(record);
+        
+        // Report every 256 packages
+        int done = store->size();
+        if (progress && (done & 0xff) == 0 && !progress(done, total)) return nullptr;
+    }
+
+    store->finalize();
+    if (progress) progress(total, total);
+    return store;
+}
+
+QByteArrayView PackageStore::dependencyName(QByteArrayView entry) {
+    // "name>=1.0", "name: description", "name=1.0-1" -> "name"
+    qsizetype end = 0;
+    while (end < entry.size()) {
+        char c = entry[end];
+        if (c == ':' || c == '<' || c == '>' || c == '=') break;
+        ++end;
+    }
+    while (end > 0 && entry[end - 1] == ' ') {
+        --end;
+    }
+    return entry.first(end);
+}
+
+void PackageStore::reserve(int packageCount) {
+    m_strings.reserve(packageCount * 4);
+
+    m_name.reserve(packageCount);
+    m_version.reserve(packageCount);
+    m_description.reserve(packageCount);
+    m_url.reserve(packageCount);
+    m_packager.reserve(packageCount);
+    m_architecture.reserve(packageCount);
+
+    m_installedSize.reserve(packageCount);
+    m_downloadSize.reserve(packageCount);
+    m_installDate.reserve(packageCount);
+    m_buildDate.reserve(packageCount);
+    m_flags.reserve(packageCount);
+
+    for (ListColumn* column : {&m_groups, &m_licenses, &m_depends, &m_optDepends,
+                               &m_optDependNames, &m_provides, &m_conflicts, &m_replaces, &m_backup}) {
+        column->offsets.reserve(packageCount + 1);
+    }
+    m_depends.items.reserve(packageCount * 8);
+}
+
+PackageId PackageStore::append(const Record& record) {
+    PackageId id = m_name.size();
+
+    m_name.append(m_strings.intern(record.name));
+    m_version.append(m_strings.intern(record.version));
+    m_description.append(m_strings.add(record.description));
+    m_url.append(m_strings.intern(record.url));
+    m_packager.append(m_strings.intern(record.packager));
+    m_architecture.append(m_strings.intern(record.architecture));
+
+    m_installedSize.append(record.installedSize);
+    m_downloadSize.append(record.downloadSize);
+    m_installDate.append(record.installDate);
+    m_buildDate.append(record.buildDate);
+    m_flags.append(record.isExplicit ? ExplicitFlag : 0);
+
+    appendList(m_groups, record.groups);
+    appendList(m_licenses, record.licenses);
+    appendList(m_depends, record.depends);
+    appendList(m_optDepends, record.optDepends);
+    appendList(m_provides, record.provides);
+    appendList(m_conflicts, record.conflicts);
+    appendList(m_replaces, record.replaces);
+    appendList(m_backup, record.backup);
+
+    for (QByteArrayView entry : record.optDepends) {
+        m_optDependNames.items.append(m_strings.intern(dependencyName(entry)));
+    }
+    m_optDependNames.offsets.append(m_optDependNames.items.size());
+
+    return id;
+}
+
+void PackageStore::appendList(ListColumn& column, const QList<QByteArrayView>& values) {
+    for (QByteArrayView value : values) {
+        column.items.append(m_strings.intern(value));
+    }
+    column.offsets.append(column.items.size());
+}
+
+void PackageStore::finalize() {
+    buildNameIndex();
+    m_reverse.build(*this);
+    m_graph.build(m_reverse);
+    m_dominators.build(*this);
+    m_folded.build(*this);
+    freeze();
+}
+
+void PackageStore::finalizeSync() {
+    buildNameIndex();
+    freeze();
+}
+
+void PackageStore::freeze() {
+    // Nothing is appended after this point
+    m_strings.freeze();
+    for (ListColumn* column : {&m_groups, &m_licenses, &m_depends, &m_optDepends,
+                               &m_optDependNames, &m_provides, &m_conflicts, &m_replaces, &m_backup}) {
+        column->items.squeeze();
+    }
+}
+
+void PackageStore::buildNameIndex() {
+    m_byName.clear();
+    m_byName.reserve(size());
+    for (PackageId id = 0; id < size(); ++id) {
+        m_byName.insert(name(id), id);
+    }
+}
+
+QStringList PackageStore::toStringList(IdRange ids) const {
+    QStringList list;
+    list.reserve(ids.size());
+    for (StringPool::Id id : ids) {
+        list.append(m_strings.at(id));
+    }
+    return list;
+}
+
+QStringList PackageStore::toNameList(const QVector<PackageId>& ids) const {
+    QStringList list;
+    list.reserve(ids.size());
+    for (PackageId id : ids) {
+        list.append(name(id));
+    }
+    return list;
+}
+
+PackageSummary PackageStore::summary(PackageId id) const {
+    PackageSummary s;
+    if (id < 0 || id >= size()) return s;
+
+    s.name = name(id);
+    s.version = version(id);
+    s.description = description(id);
+    s.installedSize = installedSize(id);
+    s.installDate = installDate(id);
+    s.buildDate = buildDate(id);
+    s.isExplicit = isExplicit(id);
+    s.isOrphan = isOrphan(id);
+    return s;
+}
+
+PackageDetails PackageStore::details(PackageId id) const {
+    PackageDetails d;
+    if (id < 0 || id >= size()) return d;
+
+    d.url = url(id);
+    d.packager = packager(id);
+    d.architecture = architecture(id);
+    d.downloadSize = downloadSize(id);
+
+    d.groups = groups(id);
+    d.licenses = licenses(id);
+    d.depends = depends(id);
+    d.optDepends = optDepends(id);
+    d.requiredBy = requiredBy(id);
+    d.optionalFor = optionalFor(id);
+    d.provides = provides(id);
+    d.conflicts = conflicts(id);
+    d.replaces = replaces(id);
+    d.backup = backup(id);
+    return d;
+}
+
+Package PackageStore::package(PackageId id) const {
+    Package p;
+    if (id < 0 || id >= size()) return p;
+
+    p.name = name(id);
+    p.version = version(id);
+    p.description = description(id);
+    p.url = url(id);
+    p.packager = packager(id);
+    p.architecture = architecture(id);
+
+    p.installedSize = installedSize(id);
+    p.downloadSize = downloadSize(id);
+    p.installDate = installDate(id);
+    p.buildDate = buildDate(id);
+    p.installReason = installReason(id);
+
+    p.groups = groups(id);
+    p.licenses = licenses(id);
+    p.depends = depends(id);
+    p.optDepends = optDepends(id);
+    p.requiredBy = requiredBy(id);
+    p.optionalFor = optionalFor(id);
+    p.provides = provides(id);
+    p.conflicts = conflicts(id);
+    p.replaces = replaces(id);
+
+    return p;
+}
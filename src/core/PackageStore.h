@@ -0,0 +1,217 @@
+#ifndef PACKAGESTORE_H
+#define PACKAGESTORE_H
+
+#include <QByteArrayView>
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <alpm.h>
+#include <functional>
+#include <memory>
+#include "StringPool.h"
+#include "ReverseDependencyIndex.h"
+#include "DependencyGraph.h"
+#include "DominatorTree.h"
+#include "FoldedText.h"
+#include "models/Package.h"
+
+// Read-only, column-oriented snapshot of the local package database.
+//
+// Every package gets a dense integer id (cache order, i.e. sorted by name).
+// Scalar fields live in one vector per column; string fields are ids into a
+// shared StringPool; list fields (depends, licenses, ...) are stored CSR
+// style as one flat id array plus per-package offsets. Views iterate ids and
+// read only the columns they need instead of materializing a QList<Package>.
+class PackageStore {
+public:
+    // Raw field views handed to append(). Strings are UTF-8 and only need to
+    // stay valid for the duration of the call.
+    struct Record {
+        QByteArrayView name;
+        QByteArrayView version;
+        QByteArrayView description;
+        QByteArrayView url;
+        QByteArrayView packager;
+        QByteArrayView architecture;
+
+        qint64 installedSize = 0;
+        qint64 downloadSize = 0;
+        qint64 installDate = 0;    // seconds since epoch
+        qint64 buildDate = 0;
+        bool isExplicit = false;
+
+        QList<QByteArrayView> groups;
+        QList<QByteArrayView> licenses;
+        QList<QByteArrayView> depends;      // bare names, no version constraint
+        QList<QByteArrayView> optDepends;   // "name: description"
+        QList<QByteArrayView> provides;     // bare names
+        QList<QByteArrayView> conflicts;
+        QList<QByteArrayView> replaces;
+        QList<QByteArrayView> backup;       // config files pacman keeps .pacnew/.pacsave for
+
+        void clear();
+    };
+
+    // A list column cell: a contiguous run of string ids
+    struct IdRange {
+        const StringPool::Id* first = nullptr;
+        const StringPool::Id* last = nullptr;
+        const StringPool::Id* begin() const { return first; }
+        const StringPool::Id* end() const { return last; }
+        int size() const { return static_cast<int>(last - first); }
+        bool isEmpty() const { return first == last; }
+    };
+
+    explicit PackageStore(quint64 generation = 0);
+
+    // Called as progress(done, total) while loading; returning false cancels
+    // the load and fromAlpm() returns nullptr
+    using Progress = std::function<bool(int, int)>;
+    
+    static std::shared_ptr<PackageStore> fromAlpm(alpm_db_t* db, quint64 generation,
+                                                  const Progress& progress = Progress());
+
+    // Strips a version constraint or ": description" from a dependency entry
+    static QByteArrayView dependencyName(QByteArrayView entry);
+
+    // Loading
+    void reserve(int packageCount);
+    PackageId append(const Record& record);
+    void finalize();  // builds the name index, reverse index, graph, dominators and folded text
+    // For sync stores, which are only looked up by name and read field by
+    // field: the name index alone. Dependency, orphan, exclusive size and
+    // folded text queries are not available on such a store.
+    void finalizeSync();
+
+    quint64 generation() const { return m_generation; }
+    int size() const { return m_name.size(); }
+    bool isEmpty() const { return m_name.isEmpty(); }
+
+    PackageId find(const QString& name) const { return m_byName.value(name, -1); }
+    bool contains(const QString& name) const { return m_byName.contains(name); }
+
+    // Scalar columns
+    const QString& name(PackageId id) const { return m_strings.at(m_name[id]); }
+    const QString& version(PackageId id) const { return m_strings.at(m_version[id]); }
+    const QString& description(PackageId id) const { return m_strings.at(m_description[id]); }
+    const QString& url(PackageId id) const { return m_strings.at(m_url[id]); }
+    const QString& packager(PackageId id) const { return m_strings.at(m_packager[id]); }
+    const QString& architecture(PackageId id) const { return m_strings.at(m_architecture[id]); }
+
+    qint64 installedSize(PackageId id) const { return m_installedSize[id]; }
+    qint64 downloadSize(PackageId id) const { return m_downloadSize[id]; }
+    // Own size plus every dependency only this package pulls in
+    qint64 exclusiveSize(PackageId id) const { return m_dominators.exclusiveSize(id); }
+    qint64 installDateSecs(PackageId id) const { return m_installDate[id]; }
+    qint64 buildDateSecs(PackageId id) const { return m_buildDate[id]; }
+    QDateTime installDate(PackageId id) const { return QDateTime::fromSecsSinceEpoch(m_installDate[id]); }
+    QDateTime buildDate(PackageId id) const { return QDateTime::fromSecsSinceEpoch(m_buildDate[id]); }
+
+    bool isExplicit(PackageId id) const { return m_flags[id] & ExplicitFlag; }
+    bool isRequired(PackageId id) const { return m_reverse.isRequired(id); }
+    bool isOrphan(PackageId id) const { return !isExplicit(id) && !isRequired(id); }
+    QString installReason(PackageId id) const { return isExplicit(id) ? "explicit" : "dependency"; }
+
+    StringPool::Id nameId(PackageId id) const { return m_name[id]; }
+
+    // List columns as string ids
+    IdRange groupIds(PackageId id) const { return range(m_groups, id); }
+    IdRange licenseIds(PackageId id) const { return range(m_licenses, id); }
+    IdRange dependIds(PackageId id) const { return range(m_depends, id); }
+    IdRange optDependIds(PackageId id) const { return range(m_optDepends, id); }
+    IdRange provideIds(PackageId id) const { return range(m_provides, id); }
+    IdRange conflictIds(PackageId id) const { return range(m_conflicts, id); }
+    IdRange replaceIds(PackageId id) const { return range(m_replaces, id); }
+    IdRange backupIds(PackageId id) const { return range(m_backup, id); }
+    IdRange optDependNameIds(PackageId id) const { return range(m_optDependNames, id); }
+
+    // List columns as strings
+    QStringList groups(PackageId id) const { return toStringList(groupIds(id)); }
+    QStringList licenses(PackageId id) const { return toStringList(licenseIds(id)); }
+    QStringList depends(PackageId id) const { return toStringList(dependIds(id)); }
+    QStringList optDepends(PackageId id) const { return toStringList(optDependIds(id)); }
+    QStringList provides(PackageId id) const { return toStringList(provideIds(id)); }
+    QStringList conflicts(PackageId id) const { return toStringList(conflictIds(id)); }
+    QStringList replaces(PackageId id) const { return toStringList(replaceIds(id)); }
+    QStringList backup(PackageId id) const { return toStringList(backupIds(id)); }
+
+    // Reverse dependencies
+    const ReverseDependencyIndex& reverseIndex() const { return m_reverse; }
+    QStringList requiredBy(PackageId id) const { return toNameList(m_reverse.requiredBy(id)); }
+    QStringList optionalFor(PackageId id) const { return toNameList(m_reverse.optionalFor(id)); }
+    
+    // Hard dependencies resolved to installed packages, both directions
+    const DependencyGraph& graph() const { return m_graph; }
+    const DominatorTree& dominators() const { return m_dominators; }
+
+    // Case-folded names and descriptions for substring search
+    const FoldedText& foldedText() const { return m_folded; }
+    
+    const StringPool& strings() const { return m_strings; }
+    QStringList toStringList(IdRange ids) const;
+    QStringList toNameList(const QVector<PackageId>& ids) const;
+
+    // Records for callers outside the store. Bulk queries build summaries;
+    // details only for the package on screen. package() is both, for
+    // legacy callers, with user data left empty.
+    PackageSummary summary(PackageId id) const;
+    PackageDetails details(PackageId id) const;
+    Package package(PackageId id) const;
+
+private:
+    friend class StoreSnapshot;
+
+    enum Flag : quint8 {
+        ExplicitFlag = 0x01
+    };
+
+    struct ListColumn {
+        QVector<quint32> offsets{0};
+        QVector<StringPool::Id> items;
+    };
+
+    static IdRange range(const ListColumn& column, PackageId id) {
+        const StringPool::Id* base = column.items.constData();
+        return {base + column.offsets[id], base + column.offsets[id + 1]};
+    }
+    void appendList(ListColumn& column, const QList<QByteArrayView>& values);
+    void buildNameIndex();
+    void freeze();
+
+    quint64 m_generation;
+    StringPool m_strings;
+
+    QVector<StringPool::Id> m_name;
+    QVector<StringPool::Id> m_version;
+    QVector<StringPool::Id> m_description;
+    QVector<StringPool::Id> m_url;
+    QVector<StringPool::Id> m_packager;
+    QVector<StringPool::Id> m_architecture;
+
+    QVector<qint64> m_installedSize;
+    QVector<qint64> m_downloadSize;
+    QVector<qint64> m_installDate;
+    QVector<qint64> m_buildDate;
+    QVector<quint8> m_flags;
+
+    ListColumn m_groups;
+    ListColumn m_licenses;
+    ListColumn m_depends;
+    ListColumn m_optDepends;
+    ListColumn m_optDependNames;  // name part of each optDepends entry
+    ListColumn m_provides;
+    ListColumn m_conflicts;
+    ListColumn m_replaces;
+    ListColumn m_backup;
+
+    QHash<QString, PackageId> m_byName;
+    ReverseDependencyIndex m_reverse;
+    DependencyGraph m_graph;
+    DominatorTree m_dominators;
+    FoldedText m_folded;
+};
+
+#endif // PACKAGESTORE_H
@@ -43,6 +43,22 @@ bool PacmanConfig::writeConfig(const QString& content) {
     return proc.exitCode() == 0;
 }
 
+QStringList PacmanConfig::getRepositories() {
+    QStringList repos;
+    QString content = readConfig();
+    
+    // Every [section] except [options] is a repository
+    QRegularExpression re(R"(^\s*\[([^\]\s]+)\]\s*$)", QRegularExpression::MultilineOption);
+    QRegularExpressionMatchIterator iter = re.globalMatch(content);
+    while (iter.hasNext()) {
+        QString name = iter.next().captured(1);
+        if (name != "options" && !repos.contains(name)) {
+            repos << name;
+        }
+    }
+    return repos;
+}
+
 QStringList PacmanConfig::getIgnoredPackages() {
     QStringList ignored;
     QString content = readConfig();
@@ -18,6 +18,9 @@ public:
     // Check if a package is pinned
     static bool isPackagePinned(const QString& packageName);
     
+    // Enabled repositories, in the order pacman searches them
+    static QStringList getRepositories();
+    
 private:
     static QString configPath();
     static QString readConfig();
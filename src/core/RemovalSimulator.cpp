@@ -0,0 +1,95 @@
+#include "RemovalSimulator.h"
+#include <QStringList>
+
+RemovalSimulator::RemovalSimulator(const PackageStore& store, const QBitArray& keep)
+    : m_store(store)
+    , m_keep(keep)
+{
+}
+
+RemovalSimulator::Plan RemovalSimulator::simulate(const QVector<PackageId>& targets, Options options) const {
+    Plan plan;
+    plan.options = options;
+    
+    const DependencyGraph& graph = m_store.graph();
+    const int count = graph.size();
+    QBitArray removed(count);
+    QBitArray kept(count);
+    QVector<PackageId> work;  // removed packages whose dependencies are unchecked
+    
+    for (PackageId id : targets) {
+        if (id < 0 || id >= count || removed.testBit(id)) continue;
+        removed.setBit(id);
+        plan.targets.append(id);
+        work.append(id);
+    }
+    
+    // -c: everything that depends on a removed package goes too
+    if (options & Cascade) {
+        QVector<PackageId> stack = work;
+        while (!stack.isEmpty()) {
+            PackageId id = stack.takeLast();
+            for (PackageId dependant : graph.dependants(id)) {
+                if (removed.testBit(dependant)) continue;
+                if (isKept(dependant)) {
+                    kept.setBit(dependant);
+                    continue;
+                }
+                removed.setBit(dependant);
+                stack.append(dependant);
+                work.append(dependant);
+            }
+        }
+    }
+    
+    // -s: a dependency goes once everything that needs it goes, unless it
+    // was installed explicitly. One that still has a dependant left is
+    // looked at again when that dependant is removed.
+    if (options & Recursive) {
+        while (!work.isEmpty()) {
+            PackageId id = work.takeLast();
+            for (PackageId dep : graph.dependencies(id)) {
+                if (removed.testBit(dep) || m_store.isExplicit(dep)) continue;
+    
+                bool needed = false;
+                for (PackageId dependant : graph.dependants(dep)) {
+                    if (!removed.testBit(dependant)) {
+                        needed = true;
+                        break;
+                    }
+                }
+                if (needed) continue;
+    
+                if (isKept(dep)) {
+                    kept.setBit(dep);
+                    continue;
+                }
+                removed.setBit(dep);
+                work.append(dep);
+            }
+        }
+    }
+    
+    QBitArray blockers(count);
+    plan.removed = DependencyGraph::toIds(removed);
+    for (PackageId id : plan.removed) {
+        plan.freedBytes += m_store.installedSize(id);
+        for (PackageId dependant : graph.dependants(id)) {
+            if (!removed.testBit(dependant)) {
+                blockers.setBit(dependant);
+            }
+        }
+    }
+    plan.kept = DependencyGraph::toIds(kept);
+    plan.blockers = DependencyGraph::toIds(blockers);
+    
+    return plan;
+}
+
+QString RemovalSimulator::command(const Plan& plan) const {
+    QStringList args = {"pacman", plan.options.testFlag(NoSave) ? "-Rn" : "-R"};
+    for (PackageId id : plan.removed) {
+        args.append(m_store.name(id));
+    }
+    return args.join(' ');
+}
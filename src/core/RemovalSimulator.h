@@ -0,0 +1,59 @@
+#ifndef REMOVALSIMULATOR_H
+#define REMOVALSIMULATOR_H
+
+#include <QBitArray>
+#include <QFlags>
+#include <QString>
+#include <QVector>
+#include "PackageStore.h"
+
+// Works out what pacman -R would remove, without running it.
+//
+// Follows pacman's rules over the store's dependency graph: -c also
+// removes everything that (transitively) depends on a target, -s also
+// removes dependencies that nothing else needs and that were installed as
+// dependencies. -n only affects .pacsave files, not the set. Packages
+// marked Keep are never pulled in; if one still depends on something in
+// the set it is reported as a blocker, just like any package pacman would
+// refuse to break.
+class RemovalSimulator {
+public:
+    enum Option {
+        NoOptions = 0x0,
+        Recursive = 0x1,  // -s
+        Cascade = 0x2,    // -c
+        NoSave = 0x4      // -n
+    };
+    Q_DECLARE_FLAGS(Options, Option)
+    
+    struct Plan {
+        Options options;
+        QVector<PackageId> targets;
+        QVector<PackageId> removed;   // targets included, ascending
+        QVector<PackageId> kept;      // would have been pulled in but are marked Keep
+        QVector<PackageId> blockers;  // stay installed but depend on something removed
+        qint64 freedBytes = 0;
+    
+        bool canProceed() const { return !removed.isEmpty() && blockers.isEmpty(); }
+    };
+    
+    // keep is a bitset over the store's package ids and may be empty.
+    // The store must outlive the simulator.
+    explicit RemovalSimulator(const PackageStore& store, const QBitArray& keep = QBitArray());
+    
+    Plan simulate(const QVector<PackageId>& targets, Options options) const;
+    
+    // Removes exactly plan.removed, so Keep marks hold even though pacman
+    // doesn't know about them
+    QString command(const Plan& plan) const;
+
+private:
+    bool isKept(PackageId id) const { return id < m_keep.size() && m_keep.testBit(id); }
+    
+    const PackageStore& m_store;
+    QBitArray m_keep;
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(RemovalSimulator::Options)
+
+#endif // REMOVALSIMULATOR_H
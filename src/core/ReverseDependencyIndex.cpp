@@ -0,0 +1,82 @@
+#include "ReverseDependencyIndex.h"
+#include "PackageStore.h"
+#include <QHash>
+
+namespace {
+
+using Edge = QPair<PackageId, PackageId>;  // (provider, dependant)
+
+void collectEdges(PackageId dependant, PackageStore::IdRange targets,
+                  const QHash<StringPool::Id, QVector<PackageId>>& providers,
+                  QVector<PackageId>& lastDependant, QVector<Edge>& edges) {
+    for (StringPool::Id target : targets) {
+        auto it = providers.constFind(target);
+        if (it == providers.constEnd()) continue;
+
+        for (PackageId provider : it.value()) {
+            // Skip self-dependencies and a second dep resolving to the same provider
+            if (provider == dependant || lastDependant[provider] == dependant) continue;
+            lastDependant[provider] = dependant;
+            edges.append(qMakePair(provider, dependant));
+        }
+    }
+}
+
+} // namespace
+
+void ReverseDependencyIndex::build(const PackageStore& store) {
+    clear();
+    const int count = store.size();
+
+    // Every name a dependency can be satisfied by: package names and provides.
+    // Names are interned in the same pool as dependency strings, so resolution
+    // is an integer lookup.
+    QHash<StringPool::Id, QVector<PackageId>> providers;
+    providers.reserve(count * 2);
+    for (PackageId id = 0; id < count; ++id) {
+        providers[store.nameId(id)].append(id);
+        for (StringPool::Id provide : store.provideIds(id)) {
+            QVector<PackageId>& list = providers[provide];
+            if (list.isEmpty() || list.last() != id) {
+                list.append(id);
+            }
+        }
+    }
+
+    // Like alpm's tolerant depcmp, version constraints are not checked here:
+    // anything that installs or provides the name satisfies the dependency.
+    QVector<PackageId> lastHard(count, -1);
+    QVector<PackageId> lastOptional(count, -1);
+    QVector<Edge> hardEdges;
+    QVector<Edge> optionalEdges;
+    for (PackageId id = 0; id < count; ++id) {
+        collectEdges(id, store.dependIds(id), providers, lastHard, hardEdges);
+        collectEdges(id, store.optDependNameIds(id), providers, lastOptional, optionalEdges);
+    }
+
+    fill(m_requiredBy, count, hardEdges);
+    fill(m_optionalFor, count, optionalEdges);
+}
+
+void ReverseDependencyIndex::fill(Adjacency& adj, int packageCount, const QVector<Edge>& edges) {
+    // Counting sort by provider. Edges arrive in dependant order, so every
+    // list comes out in cache order, matching alpm_pkg_compute_requiredby.
+    adj.offsets = QVector<int>(packageCount + 1, 0);
+    for (const Edge& edge : edges) {
+        ++adj.offsets[edge.first + 1];
+    }
+    for (int i = 0; i < packageCount; ++i) {
+        adj.offsets[i + 1] += adj.offsets[i];
+    }
+
+    adj.items = QVector<PackageId>(edges.size());
+    QVector<int> cursor = adj.offsets;
+    for (const Edge& edge : edges) {
+        adj.items[cursor[edge.first]++] = edge.second;
+    }
+}
+
+void ReverseDependencyIndex::clear() {
+    m_requiredBy = Adjacency();
+    m_optionalFor = Adjacency();
+}
@@ -0,0 +1,58 @@
+#ifndef REVERSEDEPENDENCYINDEX_H
+#define REVERSEDEPENDENCYINDEX_H
+
+#include <QPair>
+#include <QVector>
+#include "models/Package.h"
+
+class PackageStore;
+
+// Reverse dependency lookup for the local database.
+//
+// alpm_pkg_compute_requiredby / alpm_pkg_compute_optionalfor scan the whole
+// database for every call, so asking them for every package is O(N^2).
+// This index is built once per PackageStore from a single pass over its
+// dependency columns and answers the same questions with an array lookup.
+// Dependencies are resolved against package names as well as provides
+// (e.g. "sh" -> bash).
+class ReverseDependencyIndex {
+public:
+    void build(const PackageStore& store);
+    void clear();
+
+    QVector<PackageId> requiredBy(PackageId id) const { return slice(m_requiredBy, id); }
+    QVector<PackageId> optionalFor(PackageId id) const { return slice(m_optionalFor, id); }
+
+    // True if anything installed depends on the package, hard or optional
+    bool isRequired(PackageId id) const {
+        return count(m_requiredBy, id) > 0 || count(m_optionalFor, id) > 0;
+    }
+    int requiredByCount(PackageId id) const { return count(m_requiredBy, id); }
+
+private:
+    friend class StoreSnapshot;
+    friend class DependencyGraph;
+
+    // CSR adjacency: dependants of package i are items[offsets[i] .. offsets[i + 1])
+    struct Adjacency {
+        QVector<int> offsets;
+        QVector<PackageId> items;
+    };
+
+    static QVector<PackageId> slice(const Adjacency& adj, PackageId id) {
+        if (id < 0 || id + 1 >= adj.offsets.size()) return QVector<PackageId>();
+        return adj.items.mid(adj.offsets[id], adj.offsets[id + 1] - adj.offsets[id]);
+    }
+    static int count(const Adjacency& adj, PackageId id) {
+        if (id < 0 || id + 1 >= adj.offsets.size()) return 0;
+        return adj.offsets[id + 1] - adj.offsets[id];
+    }
+
+    // edges are (provider, dependant) pairs, already in dependant order
+    static void fill(Adjacency& adj, int packageCount, const QVector<QPair<PackageId, PackageId>>& edges);
+
+    Adjacency m_requiredBy;
+    Adjacency m_optionalFor;
+};
+
+#endif // REVERSEDEPENDENCYINDEX_H
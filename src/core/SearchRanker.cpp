@@ -0,0 +1,242 @@
+#include "SearchRanker.h"
+#include "utils/SubstringSearch.h"
+#include <algorithm>
+#include <cmath>
+#include <queue>
+
+namespace {
+
+// Name match tiers; BM25 and popularity stay well below one tier step
+constexpr double ExactScore = 100.0;
+constexpr double PrefixScore = 60.0;
+constexpr double SubstringScore = 40.0;
+constexpr double TypoScore = 30.0;
+constexpr double PopularityWeight = 2.0;
+
+// BM25 parameters
+constexpr double K1 = 1.2;
+constexpr double B = 0.75;
+
+} // namespace
+
+SearchRanker::SearchRanker(const QVector<Document>& documents) {
+    const int count = documents.size();
+    m_names.reserve(count);
+    m_popularity.reserve(count);
+    m_keep.reserve(count);
+    m_lengths.reserve(count);
+    
+    qint64 totalLength = 0;
+    for (int i = 0; i < count; ++i) {
+        const Document& doc = documents[i];
+        const QByteArray name = SubstringSearch::fold(doc.name);
+        m_names.append(name);
+        m_popularity.append(doc.popularity);
+        m_keep.append(doc.keep);
+    
+        m_nameTree.insert(name, i);
+        const QList<QByteArray> parts = name.split('-');
+        if (parts.size() > 1) {
+            for (const QByteArray& part : parts) {
+                if (!part.isEmpty()) m_nameTree.insert(part, i);
+            }
+        }
+    
+        QHash<QByteArray, int> frequencies;
+        const QVector<QByteArray> words = tokenize(name + ' ' + SubstringSearch::fold(doc.description));
+        for (const QByteArray& word : words) {
+            ++frequencies[word];
+        }
+        for (auto it = frequencies.constBegin(); it != frequencies.constEnd(); ++it) {
+            m_postings[it.key()].append({i, it.value()});
+        }
+        m_lengths.append(words.size());
+        totalLength += words.size();
+    }
+    m_averageLength = count > 0 ? double(totalLength) / count : 0.0;
+}
+
+QVector<QByteArray> SearchRanker::tokenize(const QByteArray& folded) {
+    // Words are runs of letters and digits; anything else separates them.
+    // Bytes >= 0x80 count as letters so non-ASCII words stay whole.
+    QVector<QByteArray> words;
+    qsizetype start = -1;
+    for (qsizetype i = 0; i <= folded.size(); ++i) {
+        const uchar c = i < folded.size() ? uchar(folded[i]) : 0;
+        const bool inWord = (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c >= 0x80;
+        if (inWord && start < 0) {
+            start = i;
+        } else if (!inWord && start >= 0) {
+            words.append(folded.mid(start, i - start));
+            start = -1;
+        }
+    }
+    return words;
+}
+
+int SearchRanker::maxDistance(int length) {
+    if (length <= 3) return 0;
+    return length <= 6 ? 1 : 2;
+}
+
+double SearchRanker::nameScore(const QByteArray& name, const QByteArray& term) {
+    if (name == term) return ExactScore;
+    // Shorter names are closer to what was typed
+    if (name.startsWith(term)) return PrefixScore + 10.0 * term.size() / name.size();
+    if (SubstringSearch::contains(name, term)) return SubstringScore;
+    return 0.0;
+}
+
+double SearchRanker::typoScore(int distance, int maxTypos) {
+    return TypoScore * (1.0 - double(distance) / (maxTypos + 1));
+}
+
+double SearchRanker::idf(int documentFrequency) const {
+    const double count = m_names.size();
+    const double df = documentFrequency;
+    return std::log(1.0 + (count - df + 0.5) / (df + 0.5));
+}
+
+double SearchRanker::bm25(double idf, int frequency, int length) const {
+    const double tf = frequency;
+    const double norm = 1.0 - B + B * length / qMax(m_averageLength, 1.0);
+    return idf * tf * (K1 + 1.0) / (tf + K1 * norm);
+}
+
+QVector<SearchRanker::Hit> SearchRanker::search(const QString& query, int limit) const {
+    const QByteArray term = SubstringSearch::fold(query.trimmed());
+    if (term.isEmpty() || limit <= 0 || m_names.isEmpty()) return {};
+    
+    const int count = m_names.size();
+    QVector<double> scores(count, 0.0);
+    QVector<int> distances(count, -1);
+    QVector<bool> matched = m_keep;
+    
+    // Name tiers
+    for (int i = 0; i < count; ++i) {
+        scores[i] = nameScore(m_names[i], term);
+        if (scores[i] > 0.0) matched[i] = true;
+    }
+    
+    // Typos; a name within distance d of the query (or one of its parts)
+    const int maxTypos = maxDistance(term.size());
+    if (maxTypos > 0) {
+        for (const auto& hit : m_nameTree.find(term, maxTypos)) {
+            const int i = hit.first;
+            const double score = typoScore(hit.second, maxTypos);
+            if (matched[i] && scores[i] >= score) continue;
+            if (distances[i] < 0 || hit.second < distances[i]) {
+                scores[i] = score;
+                distances[i] = hit.second;
+                matched[i] = true;
+            }
+        }
+    }
+    
+    // BM25 over name and description words
+    for (const QByteArray& word : tokenize(term)) {
+        auto it = m_postings.constFind(word);
+        if (it == m_postings.constEnd()) continue;
+    
+        const double weight = idf(it->size());
+        for (const Posting& posting : *it) {
+            scores[posting.document] += bm25(weight, posting.frequency, m_lengths[posting.document]);
+            matched[posting.document] = true;
+        }
+    }
+    
+    return best(m_names, m_popularity, scores, distances, matched, limit);
+}
+
+QVector<SearchRanker::Hit> SearchRanker::searchOthers(const QVector<Document>& documents,
+                                                      const QString& query, int limit) const {
+    const QByteArray term = SubstringSearch::fold(query.trimmed());
+    if (term.isEmpty() || limit <= 0 || documents.isEmpty()) return {};
+    
+    const int count = documents.size();
+    const int maxTypos = maxDistance(term.size());
+    const QVector<QByteArray> terms = tokenize(term);
+    QVector<double> weights;
+    weights.reserve(terms.size());
+    for (const QByteArray& word : terms) {
+        weights.append(idf(m_postings.value(word).size()));
+    }
+    
+    QVector<QByteArray> names;
+    QVector<double> popularity;
+    QVector<double> scores(count, 0.0);
+    QVector<int> distances(count, -1);
+    QVector<bool> matched(count, false);
+    names.reserve(count);
+    popularity.reserve(count);
+    
+    // The same steps as search(), one document at a time; there are few
+    // enough of them that typos are measured directly
+    for (int i = 0; i < count; ++i) {
+        const Document& doc = documents[i];
+        const QByteArray name = SubstringSearch::fold(doc.name);
+        names.append(name);
+        popularity.append(doc.popularity);
+        matched[i] = doc.keep;
+    
+        scores[i] = nameScore(name, term);
+        if (scores[i] > 0.0) {
+            matched[i] = true;
+        } else if (maxTypos > 0) {
+            int distance = BKTree::distance(name, term);
+            const QList<QByteArray> parts = name.split('-');
+            if (parts.size() > 1) {
+                for (const QByteArray& part : parts) {
+                    if (!part.isEmpty()) distance = qMin(distance, BKTree::distance(part, term));
+                }
+            }
+            if (distance <= maxTypos) {
+                scores[i] = typoScore(distance, maxTypos);
+                distances[i] = distance;
+                matched[i] = true;
+            }
+        }
+    
+        if (terms.isEmpty()) continue;
+        const QVector<QByteArray> words = tokenize(name + ' ' + SubstringSearch::fold(doc.description));
+        for (int t = 0; t < terms.size(); ++t) {
+            const int frequency = int(words.count(terms[t]));
+            if (frequency == 0) continue;
+            scores[i] += bm25(weights[t], frequency, words.size());
+            matched[i] = true;
+        }
+    }
+    
+    return best(names, popularity, scores, distances, matched, limit);
+}
+
+QVector<SearchRanker::Hit> SearchRanker::best(const QVector<QByteArray>& names, const QVector<double>& popularity,
+                                              QVector<double>& scores, const QVector<int>& distances,
+                                              const QVector<bool>& matched, int limit) {
+    // Best `limit` in a min-heap: the root is the weakest hit kept so far
+    auto better = [&names, &scores](int a, int b) {
+        if (scores[a] != scores[b]) return scores[a] > scores[b];
+        return names[a] < names[b];
+    };
+    std::priority_queue<int, std::vector<int>, decltype(better)> heap(better);
+    for (int i = 0; i < scores.size(); ++i) {
+        if (!matched[i]) continue;
+        if (popularity[i] > 0.0) {
+            scores[i] += PopularityWeight * std::log1p(popularity[i]);
+        }
+        if (int(heap.size()) < limit) {
+            heap.push(i);
+        } else if (better(i, heap.top())) {
+            heap.pop();
+            heap.push(i);
+        }
+    }
+    
+    QVector<Hit> result(int(heap.size()));
+    for (int slot = result.size() - 1; slot >= 0; --slot) {
+        const int i = heap.top();
+        heap.pop();
+        result[slot] = {i, scores[i], distances[i]};
+    }
+    return result;
+}
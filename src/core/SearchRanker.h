@@ -0,0 +1,82 @@
+#ifndef SEARCHRANKER_H
+#define SEARCHRANKER_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include "BKTree.h"
+
+// Ranks a set of packages (local, sync or AUR) against a query.
+//
+// A package's score adds up:
+//   - how its name matches: exact, prefix, substring, or within a small
+//     edit distance of the query or of one of its '-' separated parts
+//     (typos, found through a BK-tree)
+//   - BM25 of the query words over its name and description words
+//   - AUR popularity, when known, as a tie breaker among similar matches
+// Packages that match neither by name nor by any query word are dropped,
+// unless they are marked kept: a backend that already matched them (the
+// AUR matches description substrings) has the last word on whether they
+// belong, the ranker only on where.
+// Everything the ranking needs is folded and tokenized once when the
+// ranker is built; search() keeps only the best `limit` in a bounded heap.
+class SearchRanker {
+public:
+    struct Document {
+        QString name;
+        QString description;
+        double popularity = -1.0;  // AUR popularity, < 0 when unknown
+        bool keep = false;         // ranked even when nothing matches
+    };
+    
+    struct Hit {
+        int index = -1;      // into the documents
+        double score = 0.0;
+        int distance = -1;   // edit distance of a typo match, -1 otherwise
+    };
+    
+    SearchRanker() = default;
+    explicit SearchRanker(const QVector<Document>& documents);
+    
+    int size() const { return m_names.size(); }
+    
+    // Best first, at most limit hits
+    QVector<Hit> search(const QString& query, int limit) const;
+    
+    // Ranks documents that are not part of this ranker as if they were,
+    // with its word statistics, so the scores compare with search()'s and
+    // the two lists merge by score. Meant for a handful of extra packages
+    // next to a large set, where rebuilding the ranker would cost far more.
+    // Hits index into documents.
+    QVector<Hit> searchOthers(const QVector<Document>& documents, const QString& query, int limit) const;
+    
+    // Longest typo a query of this many bytes may contain
+    static int maxDistance(int length);
+
+private:
+    struct Posting {
+        int document;
+        int frequency;
+    };
+    
+    static QVector<QByteArray> tokenize(const QByteArray& folded);
+    static double nameScore(const QByteArray& name, const QByteArray& term);
+    static double typoScore(int distance, int maxTypos);
+    double idf(int documentFrequency) const;
+    double bm25(double idf, int frequency, int length) const;
+    // Adds popularity to the matched scores and keeps the best limit of them
+    static QVector<Hit> best(const QVector<QByteArray>& names, const QVector<double>& popularity,
+                             QVector<double>& scores, const QVector<int>& distances,
+                             const QVector<bool>& matched, int limit);
+    
+    QVector<QByteArray> m_names;       // folded, also the tie-break key
+    QVector<double> m_popularity;
+    QVector<bool> m_keep;
+    QVector<int> m_lengths;            // words per document
+    double m_averageLength = 0.0;
+    QHash<QByteArray, QVector<Posting>> m_postings;
+    BKTree m_nameTree;                 // names and name parts -> document
+};
+
+#endif // SEARCHRANKER_H
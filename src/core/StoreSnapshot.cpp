@@ -0,0 +1,252 @@
+#include "StoreSnapshot.h"
+#include "utils/BlockFile.h"
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <cstring>
+
+namespace {
+
+constexpr char Magic[8] = {'A', 'M', 'S', 'N', 'A', 'P', '\0', '\0'};
+constexpr quint32 FormatVersion = 2;
+constexpr quint32 ByteOrderMark = 0x01020304;  // reads back differently on the other endianness
+
+struct Header {
+    char magic[8];
+    quint32 version;
+    quint32 byteOrder;
+    qint64 localMtime;
+    qint64 dbDirMtime;
+    qint64 userDataStamp;
+    quint32 packageCount;
+    quint32 stringCount;
+};
+
+template <typename T>
+bool allBelow(const QVector<T>& values, quint64 limit) {
+    for (T value : values) {
+        if (quint64(value) >= limit) return false;
+    }
+    return true;
+}
+
+// CSR offsets must start at 0, never decrease and end at the item count
+template <typename T>
+bool validOffsets(const QVector<T>& offsets, int rows, qsizetype itemCount) {
+    if (offsets.size() != rows + 1 || offsets.first() != 0) return false;
+    for (int i = 0; i < rows; ++i) {
+        if (offsets[i + 1] < offsets[i]) return false;
+    }
+    return qsizetype(offsets.last()) == itemCount;
+}
+
+} // namespace
+
+StoreSnapshot::Key StoreSnapshot::currentKey(const QString& dbPath) {
+    Key key;
+    key.localMtime = fileStamp(QDir(dbPath).filePath("local"));
+    key.dbDirMtime = fileStamp(dbPath);
+    return key;
+}
+
+qint64 StoreSnapshot::fileStamp(const QString& path) {
+    QFileInfo info(path);
+    return info.exists() ? info.lastModified().toMSecsSinceEpoch() : 0;
+}
+
+QString StoreSnapshot::defaultPath() {
+    QString dataDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    return dataDir + "/packages.snapshot";
+}
+
+bool StoreSnapshot::save(const QString& path, const PackageStore& store, const Key& key,
+                         qint64 userDataStamp, const QVector<PackageUserData>& userData) {
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    
+    // QSaveFile renames into place on commit, so readers never see a partial file
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "StoreSnapshot error:" << file.errorString();
+        return false;
+    }
+    
+    const StringPool& pool = store.m_strings;
+    Header header;
+    std::memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = FormatVersion;
+    header.byteOrder = ByteOrderMark;
+    header.localMtime = key.localMtime;
+    header.dbDirMtime = key.dbDirMtime;
+    header.userDataStamp = userDataStamp;
+    header.packageCount = store.size();
+    header.stringCount = pool.size();
+    
+    // String pool: UTF-8 blob plus offsets; decoded once on load
+    QVector<quint32> stringOffsets;
+    stringOffsets.reserve(pool.size() + 1);
+    QByteArray blob;
+    blob.reserve(pool.size() * 16);
+    stringOffsets.append(0);
+    for (const QString& str : pool.m_strings) {
+        blob += str.toUtf8();
+        stringOffsets.append(blob.size());
+    }
+    
+    BlockWriter out(&file);
+    out.block(&header, sizeof(header));
+    out.array(stringOffsets);
+    out.block(blob.constData(), blob.size());
+    
+    for (const QVector<StringPool::Id>* column : {&store.m_name, &store.m_version, &store.m_description,
+                                                  &store.m_url, &store.m_packager, &store.m_architecture}) {
+        out.array(*column);
+    }
+    for (const QVector<qint64>* column : {&store.m_installedSize, &store.m_downloadSize,
+                                          &store.m_installDate, &store.m_buildDate}) {
+        out.array(*column);
+    }
+    out.array(store.m_flags);
+    
+    for (const PackageStore::ListColumn* column : {&store.m_groups, &store.m_licenses, &store.m_depends,
+                                                   &store.m_optDepends, &store.m_optDependNames,
+                                                   &store.m_provides, &store.m_conflicts, &store.m_replaces,
+                                                   &store.m_backup}) {
+        out.array(column->offsets);
+        out.array(column->items);
+    }
+    
+    for (const ReverseDependencyIndex::Adjacency* adj : {&store.m_reverse.m_requiredBy,
+                                                         &store.m_reverse.m_optionalFor}) {
+        out.array(adj->offsets);
+        out.array(adj->items);
+    }
+    
+    // User data is small and variable-length; QDataStream is fine here
+    QByteArray userBlob;
+    {
+        QDataStream stream(&userBlob, QIODevice::WriteOnly);
+        stream << qint32(userData.size());
+        for (const PackageUserData& data : userData) {
+            stream << data.notes << data.tags << data.markedKeep << data.markedReview;
+        }
+    }
+    out.block(userBlob.constData(), userBlob.size());
+    
+    if (!out.ok() || !file.commit()) {
+        qWarning() << "StoreSnapshot error: failed to write" << path << file.errorString();
+        file.cancelWriting();
+        return false;
+    }
+    return true;
+}
+
+std::shared_ptr<PackageStore> StoreSnapshot::load(const QString& path, quint64 generation, Key* key,
+                                                  qint64* userDataStamp, QVector<PackageUserData>* userData) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return nullptr;
+    
+    const qint64 size = file.size();
+    QByteArray contents;
+    const char* data = nullptr;
+    if (uchar* map = size > 0 ? file.map(0, size) : nullptr) {
+        data = reinterpret_cast<const char*>(map);
+    } else {
+        contents = file.readAll();
+        data = contents.constData();
+    }
+    
+    BlockReader in(data, size);
+    Header header;
+    const QByteArrayView headerBlock = in.block();
+    if (headerBlock.size() != qsizetype(sizeof(header))) return nullptr;
+    std::memcpy(&header, headerBlock.data(), sizeof(header));
+    if (std::memcmp(header.magic, Magic, sizeof(Magic)) != 0
+        || header.version != FormatVersion || header.byteOrder != ByteOrderMark) {
+        return nullptr;
+    }
+    
+    const int packages = header.packageCount;
+    const quint32 strings = header.stringCount;
+    auto store = std::make_shared<PackageStore>(generation);
+    
+    QVector<quint32> stringOffsets;
+    in.array(stringOffsets);
+    const QByteArrayView blob = in.block();
+    if (!in.ok() || strings == 0 || !validOffsets(stringOffsets, strings, blob.size())) return nullptr;
+    
+    StringPool& pool = store->m_strings;
+    pool.m_strings.clear();
+    pool.m_strings.reserve(strings);
+    for (quint32 i = 0; i < strings; ++i) {
+        pool.m_strings.append(QString::fromUtf8(blob.sliced(stringOffsets[i], stringOffsets[i + 1] - stringOffsets[i])));
+    }
+    pool.freeze();
+    
+    for (QVector<StringPool::Id>* column : {&store->m_name, &store->m_version, &store->m_description,
+                                            &store->m_url, &store->m_packager, &store->m_architecture}) {
+        if (!in.array(*column) || column->size() != packages || !allBelow(*column, strings)) return nullptr;
+    }
+    for (QVector<qint64>* column : {&store->m_installedSize, &store->m_downloadSize,
+                                    &store->m_installDate, &store->m_buildDate}) {
+        if (!in.array(*column) || column->size() != packages) return nullptr;
+    }
+    if (!in.array(store->m_flags) || store->m_flags.size() != packages) return nullptr;
+    
+    for (PackageStore::ListColumn* column : {&store->m_groups, &store->m_licenses, &store->m_depends,
+                                             &store->m_optDepends, &store->m_optDependNames,
+                                             &store->m_provides, &store->m_conflicts, &store->m_replaces,
+                                             &store->m_backup}) {
+        if (!in.array(column->offsets) || !in.array(column->items)
+            || !validOffsets(column->offsets, packages, column->items.size())
+            || !allBelow(column->items, strings)) {
+            return nullptr;
+        }
+    }
+    
+    for (ReverseDependencyIndex::Adjacency* adj : {&store->m_reverse.m_requiredBy,
+                                                   &store->m_reverse.m_optionalFor}) {
+        if (!in.array(adj->offsets) || !in.array(adj->items)
+            || !validOffsets(adj->offsets, packages, adj->items.size())
+            || !allBelow(adj->items, packages)) {
+            return nullptr;
+        }
+    }
+    
+    const QByteArrayView userBlock = in.block();
+    if (!in.ok()) return nullptr;
+    
+    if (userData) {
+        userData->clear();
+        QByteArray userBlob = QByteArray::fromRawData(userBlock.data(), userBlock.size());
+        QDataStream stream(userBlob);
+        qint32 count = 0;
+        stream >> count;
+        if (count == packages) {
+            userData->resize(count);
+            for (PackageId id = 0; id < count; ++id) {
+                PackageUserData& entry = (*userData)[id];
+                entry.packageName = store->name(id);
+                stream >> entry.notes >> entry.tags >> entry.markedKeep >> entry.markedReview;
+            }
+        }
+        if (stream.status() != QDataStream::Ok) {
+            userData->clear();
+        }
+    }
+    
+    store->m_graph.build(store->m_reverse);
+    store->m_dominators.build(*store);
+    store->buildNameIndex();
+    store->m_folded.build(*store);
+    
+    if (key) {
+        key->localMtime = header.localMtime;
+        key->dbDirMtime = header.dbDirMtime;
+    }
+    if (userDataStamp) *userDataStamp = header.userDataStamp;
+    return store;
+}
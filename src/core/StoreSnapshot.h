@@ -0,0 +1,48 @@
+#ifndef STORESNAPSHOT_H
+#define STORESNAPSHOT_H
+
+#include <QString>
+#include <QVector>
+#include <memory>
+#include "Database.h"
+#include "PackageStore.h"
+
+// Versioned binary image of a PackageStore (string pool, columns, reverse
+// dependency index) plus the user data shown next to it, so the next start
+// can render before the local db has been read.
+//
+// Every array is written as a length-prefixed, 8-byte aligned block in host
+// byte order. Loading maps the file and copies each block into its column
+// in one go; only the string pool is decoded. A snapshot from another
+// format version or byte order is treated as missing.
+class StoreSnapshot {
+public:
+    // Identifies the local db state a snapshot was taken from. local/ changes
+    // when packages come and go; the db directory changes whenever db.lck is
+    // taken, which covers in-place rewrites such as pacman -D.
+    struct Key {
+        qint64 localMtime = 0;
+        qint64 dbDirMtime = 0;
+
+        bool isNull() const { return localMtime == 0 && dbDirMtime == 0; }
+        bool operator==(const Key& other) const {
+            return localMtime == other.localMtime && dbDirMtime == other.dbDirMtime;
+        }
+        bool operator!=(const Key& other) const { return !(*this == other); }
+    };
+
+    static Key currentKey(const QString& dbPath);
+    static qint64 fileStamp(const QString& path);  // mtime in ms, 0 if missing
+    static QString defaultPath();
+
+    // userData is indexed by package id; userDataStamp identifies the user
+    // database it was read from
+    static bool save(const QString& path, const PackageStore& store, const Key& key,
+                     qint64 userDataStamp, const QVector<PackageUserData>& userData);
+
+    // nullptr if the file is missing, truncated or from another format
+    static std::shared_ptr<PackageStore> load(const QString& path, quint64 generation, Key* key,
+                                              qint64* userDataStamp, QVector<PackageUserData>* userData);
+};
+
+#endif // STORESNAPSHOT_H
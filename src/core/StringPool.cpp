@@ -0,0 +1,49 @@
+#include "StringPool.h"
+
+StringPool::StringPool() {
+    m_strings.append(QString());
+    m_ids.insert(QByteArray(), EmptyId);
+}
+
+StringPool::Id StringPool::intern(QByteArrayView utf8) {
+    if (utf8.isEmpty()) return EmptyId;
+    Q_ASSERT(!m_frozen);
+
+    // fromRawData avoids copying the key just to probe the table
+    const QByteArray probe = QByteArray::fromRawData(utf8.data(), utf8.size());
+    auto it = m_ids.constFind(probe);
+    if (it != m_ids.constEnd()) return it.value();
+
+    Id id = static_cast<Id>(m_strings.size());
+    m_strings.append(QString::fromUtf8(utf8));
+    m_ids.insert(utf8.toByteArray(), id);
+    return id;
+}
+
+StringPool::Id StringPool::intern(const QString& str) {
+    return intern(QByteArrayView(str.toUtf8()));
+}
+
+StringPool::Id StringPool::add(QByteArrayView utf8) {
+    if (utf8.isEmpty()) return EmptyId;
+
+    Id id = static_cast<Id>(m_strings.size());
+    m_strings.append(QString::fromUtf8(utf8));
+    return id;
+}
+
+StringPool::Id StringPool::find(const QString& str) const {
+    if (str.isEmpty()) return EmptyId;
+    return m_ids.value(str.toUtf8(), InvalidId);
+}
+
+void StringPool::freeze() {
+    m_ids = QHash<QByteArray, Id>();
+    m_strings.squeeze();
+    m_frozen = true;
+}
+
+void StringPool::reserve(int count) {
+    m_strings.reserve(count);
+    m_ids.reserve(count);
+}
@@ -0,0 +1,50 @@
+#ifndef STRINGPOOL_H
+#define STRINGPOOL_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+// Append-only string table addressed by 32-bit ids.
+//
+// intern() deduplicates, so the thousands of repeated dependency, license
+// and group names share one QString. add() skips the dedup table for values
+// that are unique per package anyway (descriptions, URLs). Lookups are keyed
+// on UTF-8 bytes so loaders can intern straight from libalpm or mmap'd text
+// without building a temporary QString first.
+class StringPool {
+public:
+    using Id = quint32;
+    static constexpr Id EmptyId = 0;  // always the empty string
+    static constexpr Id InvalidId = 0xffffffffu;
+
+    StringPool();
+
+    Id intern(QByteArrayView utf8);
+    Id intern(const QString& str);
+    Id add(QByteArrayView utf8);
+
+    // InvalidId if the string was never interned (add() entries are not found)
+    Id find(const QString& str) const;
+
+    const QString& at(Id id) const { return m_strings[id]; }
+    int size() const { return m_strings.size(); }
+
+    // Drops the dedup table once loading is done; find() and intern() stop
+    // working, at() is unaffected.
+    void freeze();
+    bool isFrozen() const { return m_frozen; }
+
+    void reserve(int count);
+
+private:
+    friend class StoreSnapshot;
+
+    QVector<QString> m_strings;
+    QHash<QByteArray, Id> m_ids;
+    bool m_frozen = false;
+};
+
+#endif // STRINGPOOL_H
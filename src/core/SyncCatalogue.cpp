@@ -0,0 +1,128 @@
+#include "SyncCatalogue.h"
+#include "SyncDbReader.h"
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QtConcurrent>
+
+QStringList SyncCatalogue::databases(const QString& syncPath, const QStringList& order) {
+    QDir sync(syncPath);
+    QStringList paths;
+    if (order.isEmpty()) {
+        for (const QString& file : sync.entryList({"*.db"}, QDir::Files, QDir::Name)) {
+            paths << sync.filePath(file);
+        }
+        return paths;
+    }
+
+    // Repositories that were never synced have no db yet
+    for (const QString& repo : order) {
+        QString path = sync.filePath(repo + ".db");
+        if (QFileInfo::exists(path)) {
+            paths << path;
+        }
+    }
+    return paths;
+}
+
+std::shared_ptr<const SyncCatalogue> SyncCatalogue::load(const QString& syncPath, const QStringList& order,
+                                                         const SyncCatalogue* previous, QString* error) {
+    auto catalogue = std::make_shared<SyncCatalogue>();
+    catalogue->m_syncPath = syncPath;
+    catalogue->m_order = order;
+
+    for (const QString& path : databases(syncPath, order)) {
+        Repository repo;
+        repo.name = SyncDbReader::repositoryName(path);
+        repo.path = path;
+        repo.modified = QFileInfo(path).lastModified();
+        if (previous) {
+            for (const Repository& old : previous->m_repositories) {
+                if (old.path == path && old.modified == repo.modified) {
+                    repo.packages = old.packages;
+                    break;
+                }
+            }
+        }
+        catalogue->m_repositories.append(repo);
+    }
+
+    // Decompression dominates, so each stale repository gets its own thread
+    QtConcurrent::blockingMap(catalogue->m_repositories, [](Repository& repo) {
+        if (!repo.packages) {
+            repo.packages = SyncDbReader(repo.path).load();
+        }
+    });
+
+    // A repository that can't be read stays listed without packages, so
+    // isCurrent() still matches its db; it is read again on the next load,
+    // once some db has changed
+    QStringList failed;
+    QVector<SearchRanker::Document> documents;
+    for (int r = 0; r < catalogue->m_repositories.size(); ++r) {
+        const Repository& repo = catalogue->m_repositories[r];
+        if (!repo.packages) {
+            failed << repo.name;
+            continue;
+        }
+        const PackageStore& pkgs = *repo.packages;
+        for (PackageId id = 0; id < pkgs.size(); ++id) {
+            documents.append({pkgs.name(id), pkgs.description(id)});
+            catalogue->m_entries.append({r, id});
+        }
+    }
+    if (error) {
+        if (catalogue->m_repositories.isEmpty()) {
+            *error = "No sync databases found in " + syncPath;
+        } else if (!failed.isEmpty()) {
+            *error = "Cannot read sync databases: " + failed.join(", ");
+        }
+    }
+    if (failed.size() == catalogue->m_repositories.size()) {
+        return nullptr;
+    }
+
+    catalogue->m_ranker = SearchRanker(documents);
+    return catalogue;
+}
+
+bool SyncCatalogue::isCurrent() const {
+    const QStringList paths = databases(m_syncPath, m_order);
+    if (paths.size() != m_repositories.size()) return false;
+    for (int i = 0; i < paths.size(); ++i) {
+        if (paths[i] != m_repositories[i].path
+            || QFileInfo(paths[i]).lastModified() != m_repositories[i].modified) {
+            return false;
+        }
+    }
+    return true;
+}
+
+SyncCatalogue::Entry SyncCatalogue::find(const QString& name) const {
+    for (int r = 0; r < m_repositories.size(); ++r) {
+        if (!m_repositories[r].packages) continue;
+        PackageId id = m_repositories[r].packages->find(name);
+        if (id >= 0) return {r, id};
+    }
+    return {};
+}
+
+QVector<SyncCatalogue::Entry> SyncCatalogue::search(const QString& query, int limit,
+                                                    const QVector<SearchRanker::Document>& others) const {
+    const QVector<SearchRanker::Hit> own = m_ranker.search(query, limit);
+    const QVector<SearchRanker::Hit> extra = m_ranker.searchOthers(others, query, limit);
+    
+    // Both are best first
+    QVector<Entry> result;
+    result.reserve(qMin(qsizetype(limit), own.size() + extra.size()));
+    int a = 0;
+    int b = 0;
+    while (result.size() < limit && (a < own.size() || b < extra.size())) {
+        if (b == extra.size() || (a < own.size() && own[a].score >= extra[b].score)) {
+            result.append(m_entries[own[a++].index]);
+        } else {
+            result.append({-1, extra[b++].index});
+        }
+    }
+    return result;
+}
@@ -0,0 +1,70 @@
+#ifndef SYNCCATALOGUE_H
+#define SYNCCATALOGUE_H
+
+#include <QDateTime>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <memory>
+#include "PackageStore.h"
+#include "SearchRanker.h"
+
+// Every package of every sync repository, read with SyncDbReader.
+//
+// Each repository keeps its own PackageStore, so names, versions,
+// descriptions, sizes, depends and provides are all there by id. A ranker
+// over all of them answers searches in-process, typos included. The
+// catalogue is immutable; load() reuses the stores of repositories whose db
+// file hasn't changed since the previous catalogue and reads the others in
+// parallel, one repository per thread.
+class SyncCatalogue {
+public:
+    struct Repository {
+        QString name;
+        QString path;
+        QDateTime modified;  // of the db file when it was read
+        std::shared_ptr<const PackageStore> packages;  // null if the db couldn't be read
+    };
+
+    struct Entry {
+        int repository = -1;
+        PackageId id = -1;
+        bool isValid() const { return repository >= 0; }
+    };
+
+    // order lists repositories as pacman.conf does; when it's empty every
+    // db in syncPath is read. previous may be null. Repositories that fail
+    // to read are kept with null packages and named in error; nullptr only
+    // if none could be read.
+    static std::shared_ptr<const SyncCatalogue> load(const QString& syncPath, const QStringList& order,
+                                                     const SyncCatalogue* previous, QString* error = nullptr);
+
+    // False once a db was added, removed or rewritten (e.g. by pacman -Sy)
+    bool isCurrent() const;
+
+    const QVector<Repository>& repositories() const { return m_repositories; }
+    const Repository& repository(const Entry& entry) const { return m_repositories[entry.repository]; }
+    int size() const { return m_entries.size(); }
+
+    // The package pacman would pick: first repository in order that has it
+    Entry find(const QString& name) const;
+
+    // Best first, at most limit; every package takes part, so typos in the
+    // query still find it. Packages from outside the catalogue (installed
+    // ones no repository has) can compete too: others are scored with the
+    // catalogue's word statistics and merged in by score. An entry with no
+    // repository stands for others[entry.id].
+    QVector<Entry> search(const QString& query, int limit,
+                          const QVector<SearchRanker::Document>& others = {}) const;
+
+private:
+    static QStringList databases(const QString& syncPath, const QStringList& order);
+
+    QString m_syncPath;
+    QStringList m_order;
+    QVector<Repository> m_repositories;
+    QVector<Entry> m_entries;  // ranker document -> package
+    SearchRanker m_ranker;
+};
+
+#endif // SYNCCATALOGUE_H
@@ -0,0 +1,102 @@
+#include "SyncDbReader.h"
+#include "LocalDbReader.h"
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <archive.h>
+#include <archive_entry.h>
+
+namespace {
+
+// libarchive's read block size; sync dbs are a few MB compressed
+constexpr size_t ReadBlockSize = 128 * 1024;
+
+} // namespace
+
+SyncDbReader::SyncDbReader(const QString& path)
+    : m_path(path)
+{
+}
+
+QString SyncDbReader::repositoryName(const QString& path) {
+    return QFileInfo(path).completeBaseName();
+}
+
+std::shared_ptr<PackageStore> SyncDbReader::load(quint64 generation) {
+    m_lastError.clear();
+
+    archive* reader = archive_read_new();
+    archive_read_support_filter_all(reader);
+    archive_read_support_format_all(reader);
+    if (archive_read_open_filename(reader, QFile::encodeName(m_path).constData(), ReadBlockSize) != ARCHIVE_OK) {
+        setError(QString("Cannot open %1: %2").arg(m_path, QString::fromUtf8(archive_error_string(reader))));
+        archive_read_free(reader);
+        return nullptr;
+    }
+
+    auto store = std::make_shared<PackageStore>(generation);
+    PackageStore::Record record;
+    QByteArray entryDir;  // "name-pkgver-pkgrel" of the package being read
+    QByteArray text;      // its desc (and depends) files
+
+    // The record's views point into text, so append before reusing it
+    auto flush = [&]() {
+        if (text.isEmpty()) return;
+        if (LocalDbReader::parseDesc(text, record)) {
+            store->append(record);
+        } else {
+            qWarning() << "SyncDbReader: skipping unreadable entry" << entryDir << "in" << m_path;
+        }
+        text.clear();
+    };
+
+    archive_entry* entry = nullptr;
+    int status = ARCHIVE_OK;
+    while ((status = archive_read_next_header(reader, &entry)) == ARCHIVE_OK) {
+        if (archive_entry_filetype(entry) != AE_IFREG) continue;
+
+        // Entries of one package come one after another
+        const QByteArrayView path(archive_entry_pathname(entry));
+        const qsizetype slash = path.lastIndexOf('/');
+        if (slash <= 0) continue;
+        const QByteArrayView file = path.sliced(slash + 1);
+        if (file != "desc" && file != "depends") continue;
+
+        const QByteArrayView dir = path.first(slash);
+        if (dir != QByteArrayView(entryDir)) {
+            flush();
+            entryDir = dir.toByteArray();
+        }
+
+        const la_int64_t size = archive_entry_size(entry);
+        if (size > 0) {
+            const qsizetype start = text.size();
+            text.resize(start + size);
+            la_ssize_t read = 0;
+            while (read < size) {
+                la_ssize_t n = archive_read_data(reader, text.data() + start + read, size - read);
+                if (n <= 0) break;
+                read += n;
+            }
+            text.truncate(start + read);
+        }
+        text.append("\n\n");  // ends the last section of this file
+    }
+    flush();
+
+    if (status != ARCHIVE_EOF) {
+        setError(QString("Cannot read %1: %2").arg(m_path, QString::fromUtf8(archive_error_string(reader))));
+        archive_read_free(reader);
+        return nullptr;
+    }
+    archive_read_free(reader);
+
+    // Catalogue searches only need names and the plain fields
+    store->finalizeSync();
+    return store;
+}
+
+void SyncDbReader::setError(const QString& error) {
+    m_lastError = error;
+    qWarning() << "SyncDbReader error:" << error;
+}
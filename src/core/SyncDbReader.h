@@ -0,0 +1,39 @@
+#ifndef SYNCDBREADER_H
+#define SYNCDBREADER_H
+
+#include <QString>
+#include <memory>
+#include "PackageStore.h"
+
+// Loads a PackageStore from one sync database (/var/lib/pacman/sync/<repo>.db)
+// without libalpm or pacman.
+//
+// A sync db is a compressed tar holding a "name-pkgver-pkgrel/desc" file per
+// package; dbs written by older repo-add keep the dependency fields in a
+// separate "depends" file next to it. libarchive decompresses the tar as a
+// stream, so the db is never unpacked or held whole in memory: each
+// package's files are read into one buffer, parsed with
+// LocalDbReader::parseDesc and appended to the store before the next
+// package is read. Install dates and reasons don't exist for sync packages
+// and are left at zero / explicit. The store is finalized with
+// PackageStore::finalizeSync(): no dependency graph or folded text.
+class SyncDbReader {
+public:
+    explicit SyncDbReader(const QString& path);
+
+    // nullptr on failure; see lastError()
+    std::shared_ptr<PackageStore> load(quint64 generation = 0);
+
+    QString lastError() const { return m_lastError; }
+
+    // "extra" for ".../sync/extra.db"
+    static QString repositoryName(const QString& path);
+
+private:
+    void setError(const QString& error);
+
+    QString m_path;
+    QString m_lastError;
+};
+
+#endif // SYNCDBREADER_H
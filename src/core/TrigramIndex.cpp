@@ -0,0 +1,176 @@
+#include "TrigramIndex.h"
+#include "PackageStore.h"
+#include "utils/SubstringSearch.h"
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+constexpr char Separator = '\n';
+
+} // namespace
+
+QByteArray TrigramIndex::indexedText(const PackageStore& store, PackageId id) {
+    QString text = store.name(id);
+    text += QLatin1Char(Separator);
+    text += store.description(id);
+    for (StringPool::Id provide : store.provideIds(id)) {
+        text += QLatin1Char(Separator);
+        text += store.strings().at(provide);
+    }
+    for (StringPool::Id group : store.groupIds(id)) {
+        text += QLatin1Char(Separator);
+        text += store.strings().at(group);
+    }
+    return SubstringSearch::fold(text);
+}
+
+QVector<TrigramIndex::Trigram> TrigramIndex::trigrams(QByteArrayView text) {
+    QVector<Trigram> result;
+    const uchar* data = reinterpret_cast<const uchar*>(text.data());
+    for (qsizetype i = 0; i + 3 <= text.size(); ++i) {
+        if (data[i] == Separator || data[i + 1] == Separator || data[i + 2] == Separator) continue;
+        result.append(Trigram(data[i]) << 16 | Trigram(data[i + 1]) << 8 | Trigram(data[i + 2]));
+    }
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+void TrigramIndex::insert(int slot) {
+    for (Trigram trigram : trigrams(m_documents[slot].text)) {
+        QVector<int>& slots = m_postings[trigram];
+        // Slots mostly arrive in order while building, making this an append
+        slots.insert(std::lower_bound(slots.begin(), slots.end(), slot), slot);
+    }
+}
+
+void TrigramIndex::erase(int slot) {
+    for (Trigram trigram : trigrams(m_documents[slot].text)) {
+        auto it = m_postings.find(trigram);
+        if (it == m_postings.end()) continue;
+        QVector<int>& slots = *it;
+        auto pos = std::lower_bound(slots.begin(), slots.end(), slot);
+        if (pos != slots.end() && *pos == slot) {
+            slots.erase(pos);
+        }
+        if (slots.isEmpty()) {
+            m_postings.erase(it);
+        }
+    }
+}
+
+void TrigramIndex::update(const PackageStore& store) {
+    QVector<bool> seen(m_documents.size());
+    
+    for (PackageId id = 0; id < store.size(); ++id) {
+        const QString& name = store.name(id);
+        auto it = m_slotByName.constFind(name);
+        if (it != m_slotByName.constEnd()) {
+            const int slot = *it;
+            seen[slot] = true;
+            Document& doc = m_documents[slot];
+            doc.id = id;  // ids shift as packages come and go
+            if (doc.version == store.version(id) && doc.installDate == store.installDateSecs(id)) continue;
+    
+            erase(slot);
+            doc.version = store.version(id);
+            doc.installDate = store.installDateSecs(id);
+            doc.text = indexedText(store, id);
+            insert(slot);
+            continue;
+        }
+    
+        int slot;
+        if (!m_freeSlots.isEmpty()) {
+            slot = m_freeSlots.takeLast();
+            seen[slot] = true;
+        } else {
+            slot = m_documents.size();
+            m_documents.append(Document());
+        }
+        m_documents[slot] = {name, store.version(id), store.installDateSecs(id), indexedText(store, id), id};
+        m_slotByName.insert(name, slot);
+        insert(slot);
+    }
+    
+    // Whatever wasn't seen has been uninstalled
+    for (int slot = 0; slot < seen.size(); ++slot) {
+        if (seen[slot] || m_documents[slot].name.isEmpty()) continue;
+        erase(slot);
+        m_slotByName.remove(m_documents[slot].name);
+        m_documents[slot] = Document();
+        m_freeSlots.append(slot);
+    }
+    
+    m_slotById.fill(-1, store.size());
+    for (int slot = 0; slot < m_documents.size(); ++slot) {
+        if (!m_documents[slot].name.isEmpty()) {
+            m_slotById[m_documents[slot].id] = slot;
+        }
+    }
+    m_generation = store.generation();
+}
+
+bool TrigramIndex::contains(PackageId id, const QByteArray& foldedNeedle) const {
+    const int slot = m_slotById.value(id, -1);
+    return slot >= 0 && SubstringSearch::contains(m_documents[slot].text, foldedNeedle);
+}
+
+void TrigramIndex::clear() {
+    m_generation = 0;
+    m_documents.clear();
+    m_freeSlots.clear();
+    m_slotByName.clear();
+    m_slotById.clear();
+    m_postings.clear();
+}
+
+QVector<PackageId> TrigramIndex::search(const QString& query) const {
+    QVector<PackageId> result;
+    const QByteArray needle = SubstringSearch::fold(query);
+    if (needle.isEmpty()) return result;
+    
+    auto verify = [&](int slot) {
+        const Document& doc = m_documents[slot];
+        if (!doc.name.isEmpty() && SubstringSearch::contains(doc.text, needle)) {
+            result.append(doc.id);
+        }
+    };
+    
+    const QVector<Trigram> keys = trigrams(needle);
+    if (keys.isEmpty()) {
+        // Too short to narrow down (or spans a separator): check every package
+        for (int slot = 0; slot < m_documents.size(); ++slot) {
+            verify(slot);
+        }
+    } else {
+        QVector<const QVector<int>*> lists;
+        lists.reserve(keys.size());
+        for (Trigram key : keys) {
+            auto it = m_postings.constFind(key);
+            if (it == m_postings.constEnd()) return result;
+            lists.append(&*it);
+        }
+        std::sort(lists.begin(), lists.end(), [](const QVector<int>* a, const QVector<int>* b) {
+            return a->size() < b->size();
+        });
+    
+        QVector<int> candidates = *lists.first();
+        QVector<int> next;
+        for (int i = 1; i < lists.size() && !candidates.isEmpty(); ++i) {
+            next.clear();
+            std::set_intersection(candidates.begin(), candidates.end(),
+                                  lists[i]->begin(), lists[i]->end(), std::back_inserter(next));
+            candidates.swap(next);
+        }
+    
+        // Every trigram present doesn't mean they are adjacent
+        for (int slot : candidates) {
+            verify(slot);
+        }
+    }
+    
+    std::sort(result.begin(), result.end());
+    return result;
+}
@@ -0,0 +1,65 @@
+#ifndef TRIGRAMINDEX_H
+#define TRIGRAMINDEX_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include "models/Package.h"
+
+class PackageStore;
+
+// Inverted index from trigrams of case-folded UTF-8 to packages, for
+// substring search over name, description, provides and groups.
+//
+// A query of three or more characters only verifies the packages that
+// contain every one of its trigrams, intersecting the shortest posting
+// lists first; shorter queries scan the folded text without touching the
+// store. Packages are tracked by name, so update() with a reloaded store
+// only reindexes what was installed, removed or changed version.
+class TrigramIndex {
+public:
+    // Brings the index in line with store; ids returned by search() refer
+    // to the store most recently passed here
+    void update(const PackageStore& store);
+    void clear();
+    
+    quint64 generation() const { return m_generation; }
+    int size() const { return m_slotByName.size(); }
+    
+    // Ids of packages whose indexed text contains query, case-insensitively,
+    // ascending. An empty query matches nothing.
+    QVector<PackageId> search(const QString& query) const;
+    
+    // Whether one package's indexed text contains an already folded needle;
+    // cheaper than search() when only a few packages are still in question
+    bool contains(PackageId id, const QByteArray& foldedNeedle) const;
+    
+    // The text a package is indexed under: its fields, folded and joined by '\n'
+    static QByteArray indexedText(const PackageStore& store, PackageId id);
+
+private:
+    using Trigram = quint32;  // three bytes
+    
+    struct Document {
+        QString name;     // empty for a free slot
+        QString version;
+        qint64 installDate = 0;
+        QByteArray text;  // indexedText()
+        PackageId id = -1;
+    };
+    
+    // Distinct trigrams of text, ascending; none span a field separator
+    static QVector<Trigram> trigrams(QByteArrayView text);
+    void insert(int slot);
+    void erase(int slot);
+    
+    quint64 m_generation = 0;
+    QVector<Document> m_documents;        // by slot
+    QVector<int> m_freeSlots;
+    QHash<QString, int> m_slotByName;
+    QVector<int> m_slotById;              // for the store of m_generation
+    QHash<Trigram, QVector<int>> m_postings;  // trigram -> slots, ascending
+};
+
+#endif // TRIGRAMINDEX_H
@@ -6,6 +6,9 @@
 #include <QDateTime>
 #include <QVariant>
 
+// Dense row index into a PackageStore snapshot
+using PackageId = int;
+
 struct Package {
     QString name;
     QString version;
@@ -49,10 +52,14 @@ struct Package {
     }
     
     QString formattedSize() const {
-        if (installedSize < 1024) return QString::number(installedSize) + " B";
-        if (installedSize < 1024 * 1024) return QString::number(installedSize / 1024.0, 'f', 1) + " KB";
-        if (installedSize < 1024 * 1024 * 1024) return QString::number(installedSize / (1024.0 * 1024.0), 'f', 1) + " MB";
-        return QString::number(installedSize / (1024.0 * 1024.0 * 1024.0), 'f', 2) + " GB";
+        return formatSize(installedSize);
+    }
+    
+    static QString formatSize(qint64 bytes) {
+        if (bytes < 1024) return QString::number(bytes) + " B";
+        if (bytes < 1024 * 1024) return QString::number(bytes / 1024.0, 'f', 1) + " KB";
+        if (bytes < 1024 * 1024 * 1024) return QString::number(bytes / (1024.0 * 1024.0), 'f', 1) + " MB";
+        return QString::number(bytes / (1024.0 * 1024.0 * 1024.0), 'f', 2) + " GB";
     }
     
     // For QVariant support
@@ -61,6 +68,45 @@ struct Package {
     }
 };
 
+// The fields lists, filters and sorts work with
+struct PackageSummary {
+    QString name;
+    QString version;
+    QString description;
+    
+    qint64 installedSize = 0;  // in bytes
+    QDateTime installDate;
+    QDateTime buildDate;
+    
+    bool isExplicit = false;
+    bool isOrphan = false;     // a dependency nothing requires any more
+    
+    QString installReason() const { return isExplicit ? "explicit" : "dependency"; }
+    QString formattedSize() const { return Package::formatSize(installedSize); }
+    bool isValid() const { return !name.isEmpty(); }
+};
+
+// Everything else about a package, for the detail pane; fetched for one
+// package at a time
+struct PackageDetails {
+    QString url;
+    QString packager;
+    QString architecture;
+    qint64 downloadSize = 0;   // in bytes
+    
+    QStringList groups;
+    QStringList licenses;
+    QStringList depends;
+    QStringList optDepends;
+    QStringList requiredBy;    // reverse dependencies
+    QStringList optionalFor;
+    QStringList provides;
+    QStringList conflicts;
+    QStringList replaces;
+    QStringList backup;        // protected config files
+};
+
 Q_DECLARE_METATYPE(Package)
+Q_DECLARE_METATYPE(PackageSummary)
 
 #endif // PACKAGE_H
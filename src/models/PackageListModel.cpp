@@ -1,15 +1,29 @@
 #include "PackageListModel.h"
-#include <QFont>
+#include "core/PackageStore.h"
+#include "core/LocalDbWatcher.h"
 #include <QColor>
+#include <algorithm>
+#include <functional>
+
+namespace {
+// Detail records kept; the detail pane shows one package at a time
+constexpr int DetailsCacheSize = 32;
+
+// Changed rows are re-checked one at a time up to this share of the
+// table; past it, evaluating whole columns is cheaper
+constexpr int PatchedRowsDivisor = 8;
+}
 
 PackageListModel::PackageListModel(QObject* parent)
     : QAbstractTableModel(parent)
+    , m_details(DetailsCacheSize)
 {
+    m_boldFont.setBold(true);
 }
 
 int PackageListModel::rowCount(const QModelIndex& parent) const {
     if (parent.isValid()) return 0;
-    return m_packages.size();
+    return m_ids.size();
 }
 
 int PackageListModel::columnCount(const QModelIndex& parent) const {
@@ -18,71 +32,97 @@ int PackageListModel::columnCount(const QModelIndex& parent) const {
 }
 
 QVariant PackageListModel::data(const QModelIndex& index, int role) const {
-    if (!index.isValid() || index.row() >= m_packages.size()) {
+    if (!index.isValid() || index.row() >= m_ids.size()) {
         return QVariant();
     }
     
-    const Package& pkg = m_packages[index.row()];
+    const PackageStore& pkgs = *m_store;
+    PackageId id = m_ids[index.row()];
     
     if (role == Qt::DisplayRole) {
         switch (index.column()) {
             case NameColumn:
-                return pkg.name;
+                return pkgs.name(id);
             case VersionColumn:
-                return pkg.version;
+                return pkgs.version(id);
             case SizeColumn:
-                return pkg.formattedSize();
+                return displayText(index.row()).size;
+            case ExclusiveSizeColumn:
+                return displayText(index.row()).exclusiveSize;
             case InstallDateColumn:
-                return pkg.installDate.toString("yyyy-MM-dd");
+                return displayText(index.row()).installDate;
             case ReasonColumn:
-                return pkg.installReason;
+                return pkgs.installReason(id);
             case DescriptionColumn:
-                return pkg.description;
+                return pkgs.description(id);
         }
     }
     else if (role == SortRole) {
         switch (index.column()) {
             case NameColumn:
-                return pkg.name.toLower();
+                return m_sortKeys.name(id);
             case VersionColumn:
-                return pkg.version;
+                return m_sortKeys.version(id);
             case SizeColumn:
-                return pkg.installedSize;
+                return pkgs.installedSize(id);
+            case ExclusiveSizeColumn:
+                return pkgs.exclusiveSize(id);
             case InstallDateColumn:
-                return pkg.installDate;
+                return pkgs.installDate(id);
             case ReasonColumn:
-                return pkg.installReason;
+                return pkgs.installReason(id);
             case DescriptionColumn:
-                return pkg.description.toLower();
+                return m_sortKeys.description(id);
         }
     }
     else if (role == PackageRole) {
-        return QVariant::fromValue(pkg);
+        return QVariant::fromValue(summary(index.row()));
     }
     else if (role == Qt::ForegroundRole) {
-        if (pkg.isOrphan()) {
+        if (pkgs.isOrphan(id)) {
             return QColor(255, 165, 0);  // Orange for orphans
         }
     }
     else if (role == Qt::FontRole) {
-        if (pkg.isExplicit()) {
-            QFont font;
-            font.setBold(true);
-            return font;
+        if (pkgs.isExplicit(id)) {
+            return m_boldFont;
         }
     }
     else if (role == Qt::ToolTipRole) {
-        return QString("<b>%1</b> %2<br><br>%3<br><br>Installed: %4<br>Size: %5")
-            .arg(pkg.name)
-            .arg(pkg.version)
-            .arg(pkg.description)
-            .arg(pkg.installDate.toString("yyyy-MM-dd hh:mm"))
-            .arg(pkg.formattedSize());
+        return toolTip(index.row());
     }
     
     return QVariant();
 }
 
+const PackageListModel::DisplayText& PackageListModel::displayText(int row) const {
+    DisplayText& text = m_display[row];
+    if (text.size.isNull()) {
+        const PackageStore& pkgs = *m_store;
+        PackageId id = m_ids[row];
+        text.size = Package::formatSize(pkgs.installedSize(id));
+        text.exclusiveSize = Package::formatSize(pkgs.exclusiveSize(id));
+        text.installDate = pkgs.installDate(id).toString("yyyy-MM-dd");
+    }
+    return text;
+}
+
+const QString& PackageListModel::toolTip(int row) const {
+    const DisplayText& text = displayText(row);
+    if (text.toolTip.isNull()) {
+        const PackageStore& pkgs = *m_store;
+        PackageId id = m_ids[row];
+        m_display[row].toolTip = QString("<b>%1</b> %2<br><br>%3<br><br>Installed: %4<br>Size: %5<br>Exclusive: %6")
+            .arg(pkgs.name(id))
+            .arg(pkgs.version(id))
+            .arg(pkgs.description(id))
+            .arg(pkgs.installDate(id).toString("yyyy-MM-dd hh:mm"))
+            .arg(text.size)
+            .arg(text.exclusiveSize);
+    }
+    return text.toolTip;
+}
+
 QVariant PackageListModel::headerData(int section, Qt::Orientation orientation, int role) const {
     if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
         return QVariant();
@@ -92,6 +132,7 @@ QVariant PackageListModel::headerData(int section, Qt::Orientation orientation,
         case NameColumn: return tr("Name");
         case VersionColumn: return tr("Version");
         case SizeColumn: return tr("Size");
+        case ExclusiveSizeColumn: return tr("Exclusive");
         case InstallDateColumn: return tr("Installed");
         case ReasonColumn: return tr("Reason");
         case DescriptionColumn: return tr("Description");
@@ -100,68 +141,300 @@ QVariant PackageListModel::headerData(int section, Qt::Orientation orientation,
     return QVariant();
 }
 
-void PackageListModel::setPackages(const QList<Package>& packages) {
+void PackageListModel::setStore(std::shared_ptr<const PackageStore> store, const QVector<UserData>& userData) {
+    int count = store ? store->size() : 0;
+    
+    // A reload of the same database: move the rows over instead of resetting
+    if (m_store && store && store != m_store) {
+        std::shared_ptr<const PackageStore> previous = m_store;
+        if (applyChanges(store, LocalDbChanges::between(*previous, *store))) {
+            if (userData.size() == count) {
+                QVector<int> changedRows;
+                for (int row = 0; row < m_ids.size(); ++row) {
+                    if (m_userData[row] != userData[m_ids[row]]) {
+                        m_userData[row] = userData[m_ids[row]];
+                        changedRows.append(row);
+                    }
+                }
+                emitRowsChanged(changedRows);
+            }
+            return;
+        }
+    }
+    
     beginResetModel();
-    m_packages = packages;
+    m_store = std::move(store);
+    m_ids.resize(count);
+    for (PackageId id = 0; id < count; ++id) {
+        m_ids[id] = id;
+    }
+    m_userData = userData.size() == count ? userData : QVector<UserData>(count);
+    m_display = QVector<DisplayText>(count);
+    m_details.clear();
+    rebuildRowIndex();
+    rebuildSortKeys();
     endResetModel();
     emit packagesChanged();
 }
 
-void PackageListModel::addPackage(const Package& package) {
-    beginInsertRows(QModelIndex(), m_packages.size(), m_packages.size());
-    m_packages.append(package);
-    endInsertRows();
+bool PackageListModel::applyChanges(std::shared_ptr<const PackageStore> store, const LocalDbChanges& changes,
+                                    const QHash<QString, UserData>& addedUserData) {
+    if (!m_store || !store) return false;
+    
+    // Removed packages, highest row first so pending rows keep their index
+    QVector<int> removedRows;
+    for (const QString& name : changes.removed) {
+        int row = findPackageRow(name);
+        if (row >= 0 && !store->contains(name)) {
+            removedRows.append(row);
+        }
+    }
+    std::sort(removedRows.begin(), removedRows.end(), std::greater<int>());
+    for (int i = 0; i < removedRows.size();) {
+        int last = removedRows[i];
+        int first = last;
+        for (++i; i < removedRows.size() && removedRows[i] == first - 1; ++i) {
+            first = removedRows[i];
+        }
+        beginRemoveRows(QModelIndex(), first, last);
+        m_ids.remove(first, last - first + 1);
+        m_userData.remove(first, last - first + 1);
+        m_display.remove(first, last - first + 1);
+        endRemoveRows();
+    }
+    
+    // Ids shift when packages come and go, so the remaining rows are
+    // matched to the new store by name
+    QVector<PackageId> ids(m_ids.size());
+    QVector<int> rowOf(store->size(), -1);
+    QVector<int> changedRows;
+    for (int row = 0; row < m_ids.size(); ++row) {
+        PackageId oldId = m_ids[row];
+        PackageId id = store->find(m_store->name(oldId));
+        if (id < 0) {  // a removal we weren't told about
+            rebuildRowIndex();
+            return false;
+        }
+        
+        ids[row] = id;
+        rowOf[id] = row;
+        // Orphan status and exclusive size follow other packages' dependencies
+        if (m_store->isOrphan(oldId) != store->isOrphan(id)
+            || m_store->exclusiveSize(oldId) != store->exclusiveSize(id)) {
+            changedRows.append(row);
+        }
+    }
+    m_sortKeys.update(*m_store, *store);
+    m_store = std::move(store);
+    m_ids = ids;
+    m_rowOf = rowOf;
+    m_details.clear();  // ids moved and reverse dependencies may have changed
+    
+    for (const QString& name : changes.changed) {
+        PackageId id = m_store->find(name);
+        if (id >= 0 && rowOf[id] >= 0) {
+            changedRows.append(rowOf[id]);
+        }
+    }
+    
+    // New packages go at the end; the proxy sorts them into place
+    QVector<PackageId> addedIds;
+    for (const QStringList* names : {&changes.added, &changes.changed}) {
+        for (const QString& name : *names) {
+            PackageId id = m_store->find(name);
+            if (id >= 0 && rowOf[id] < 0) {
+                rowOf[id] = m_ids.size() + addedIds.size();
+                addedIds.append(id);
+            }
+        }
+    }
+    if (!addedIds.isEmpty()) {
+        int first = m_ids.size();
+        beginInsertRows(QModelIndex(), first, first + addedIds.size() - 1);
+        for (PackageId id : addedIds) {
+            m_ids.append(id);
+            m_userData.append(addedUserData.value(m_store->name(id)));
+            m_display.append(DisplayText());
+        }
+        m_rowOf = rowOf;
+        endInsertRows();
+    }
+    
+    emitRowsChanged(changedRows);
     emit packagesChanged();
+    
+    // Anything still missing is an install we weren't told about
+    return m_ids.size() == m_store->size();
 }
 
-void PackageListModel::updatePackage(const Package& package) {
-    int row = findPackageRow(package.name);
-    if (row >= 0) {
-        m_packages[row] = package;
-        emit dataChanged(index(row, 0), index(row, ColumnCount - 1));
+void PackageListModel::emitRowsChanged(QVector<int> rows) {
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+    for (int row : rows) {
+        m_display[row] = DisplayText();
+    }
+    
+    // One signal per run of consecutive rows
+    for (int i = 0; i < rows.size();) {
+        int first = rows[i];
+        int last = first;
+        for (++i; i < rows.size() && rows[i] == last + 1; ++i) {
+            last = rows[i];
+        }
+        emit dataChanged(index(first, 0), index(last, ColumnCount - 1));
     }
 }
 
-void PackageListModel::removePackage(const QString& name) {
-    int row = findPackageRow(name);
-    if (row >= 0) {
-        beginRemoveRows(QModelIndex(), row, row);
-        m_packages.removeAt(row);
-        endRemoveRows();
-        emit packagesChanged();
+void PackageListModel::emitUserDataChanged(int row) {
+    emit dataChanged(index(row, 0), index(row, ColumnCount - 1));
+}
+
+void PackageListModel::rebuildRowIndex() {
+    m_rowOf.fill(-1, m_store ? m_store->size() : 0);
+    for (int row = 0; row < m_ids.size(); ++row) {
+        m_rowOf[m_ids[row]] = row;
+    }
+}
+
+void PackageListModel::rebuildSortKeys() {
+    if (m_store) {
+        m_sortKeys.build(*m_store);
+    } else {
+        m_sortKeys.clear();
+    }
+}
+
+void PackageListModel::setUserData(int row, const UserData& data) {
+    if (row < 0 || row >= m_userData.size()) return;
+    
+    m_userData[row] = data;
+    emitUserDataChanged(row);
+}
+
+void PackageListModel::setNotes(int row, const QString& notes) {
+    if (row < 0 || row >= m_userData.size() || m_userData[row].notes == notes) return;
+    
+    m_userData[row].notes = notes;
+    emitUserDataChanged(row);
+}
+
+void PackageListModel::setTags(int row, const QStringList& tags) {
+    if (row < 0 || row >= m_userData.size() || m_userData[row].tags == tags) return;
+    
+    m_userData[row].tags = tags;
+    emitUserDataChanged(row);
+}
+
+void PackageListModel::setKeep(int row, bool keep) {
+    if (row < 0 || row >= m_userData.size() || m_userData[row].keep == keep) return;
+    
+    m_userData[row].keep = keep;
+    emitUserDataChanged(row);
+}
+
+void PackageListModel::setReview(int row, bool review) {
+    if (row < 0 || row >= m_userData.size() || m_userData[row].review == review) return;
+    
+    m_userData[row].review = review;
+    emitUserDataChanged(row);
+}
+
+QBitArray PackageListModel::keepMarks() const {
+    QBitArray keep(m_store ? m_store->size() : 0);
+    for (int row = 0; row < m_ids.size(); ++row) {
+        if (m_userData[row].keep) {
+            keep.setBit(m_ids[row]);
+        }
     }
+    return keep;
+}
+
+bool PackageListModel::rowLessThan(int left, int right, int column) const {
+    const PackageStore& pkgs = *m_store;
+    PackageId a = m_ids[left];
+    PackageId b = m_ids[right];
+    
+    qint64 keyA = 0;
+    qint64 keyB = 0;
+    switch (column) {
+        case VersionColumn:
+            keyA = m_sortKeys.version(a);
+            keyB = m_sortKeys.version(b);
+            break;
+        case SizeColumn:
+            keyA = pkgs.installedSize(a);
+            keyB = pkgs.installedSize(b);
+            break;
+        case ExclusiveSizeColumn:
+            keyA = pkgs.exclusiveSize(a);
+            keyB = pkgs.exclusiveSize(b);
+            break;
+        case InstallDateColumn:
+            keyA = pkgs.installDateSecs(a);
+            keyB = pkgs.installDateSecs(b);
+            break;
+        case ReasonColumn:
+            // "dependency" before "explicit"
+            keyA = pkgs.isExplicit(a);
+            keyB = pkgs.isExplicit(b);
+            break;
+        case DescriptionColumn:
+            keyA = m_sortKeys.description(a);
+            keyB = m_sortKeys.description(b);
+            break;
+    }
+    if (keyA != keyB) {
+        return keyA < keyB;
+    }
+    return m_sortKeys.name(a) < m_sortKeys.name(b);
 }
 
 void PackageListModel::clear() {
     beginResetModel();
-    m_packages.clear();
+    m_store.reset();
+    m_ids.clear();
+    m_userData.clear();
+    m_rowOf.clear();
+    m_display.clear();
+    m_details.clear();
+    m_sortKeys.clear();
     endResetModel();
     emit packagesChanged();
 }
 
-Package PackageListModel::getPackage(int row) const {
-    if (row >= 0 && row < m_packages.size()) {
-        return m_packages[row];
+PackageId PackageListModel::packageId(int row) const {
+    if (row >= 0 && row < m_ids.size()) {
+        return m_ids[row];
     }
-    return Package();
+    return -1;
 }
 
-Package PackageListModel::getPackageByName(const QString& name) const {
-    for (const Package& pkg : m_packages) {
-        if (pkg.name == name) {
-            return pkg;
-        }
+int PackageListModel::findPackageRow(const QString& name) const {
+    if (!m_store) return -1;
+    
+    PackageId id = m_store->find(name);
+    return id >= 0 && id < m_rowOf.size() ? m_rowOf[id] : -1;
+}
+
+PackageSummary PackageListModel::summary(int row) const {
+    if (row < 0 || row >= m_ids.size()) {
+        return PackageSummary();
     }
-    return Package();
+    return m_store->summary(m_ids[row]);
 }
 
-int PackageListModel::findPackageRow(const QString& name) const {
-    for (int i = 0; i < m_packages.size(); ++i) {
-        if (m_packages[i].name == name) {
-            return i;
-        }
+PackageDetails PackageListModel::details(int row) const {
+    if (row < 0 || row >= m_ids.size()) {
+        return PackageDetails();
     }
-    return -1;
+    
+    PackageId id = m_ids[row];
+    if (PackageDetails* cached = m_details.object(id)) {
+        return *cached;
+    }
+    PackageDetails details = m_store->details(id);
+    m_details.insert(id, new PackageDetails(details));
+    return details;
 }
 
 // PackageFilterProxyModel implementation
@@ -173,88 +446,193 @@ PackageFilterProxyModel::PackageFilterProxyModel(QObject* parent)
     setSortRole(PackageListModel::SortRole);
 }
 
+void PackageFilterProxyModel::setSourceModel(QAbstractItemModel* sourceModel) {
+    for (const QMetaObject::Connection& connection : m_sourceConnections) {
+        disconnect(connection);
+    }
+    m_sourceConnections.clear();
+    
+    // Connected ahead of the base class so the bitmap is up to date before
+    // the proxy refilters the affected rows
+    if (sourceModel) {
+        auto invalidate = [this]() { m_matchesValid = false; };
+        m_sourceConnections = {
+            connect(sourceModel, &QAbstractItemModel::dataChanged, this,
+                    [this](const QModelIndex& topLeft, const QModelIndex& bottomRight) {
+                        updateMatches(topLeft.row(), bottomRight.row());
+                    }),
+            connect(sourceModel, &QAbstractItemModel::rowsInserted, this,
+                    [this](const QModelIndex&, int first, int last) { insertMatches(first, last); }),
+            connect(sourceModel, &QAbstractItemModel::rowsRemoved, this,
+                    [this](const QModelIndex&, int first, int last) { removeMatches(first, last); }),
+            connect(sourceModel, &QAbstractItemModel::modelReset, this, invalidate),
+            connect(sourceModel, &QAbstractItemModel::layoutChanged, this, invalidate)
+        };
+    }
+    m_matchesValid = false;
+    QSortFilterProxyModel::setSourceModel(sourceModel);
+}
+
 void PackageFilterProxyModel::setFilterType(FilterType type) {
     if (m_filterType != type) {
         m_filterType = type;
-        beginFilterChange();
-        endFilterChange();
+        rebuildQuery();
     }
 }
 
 void PackageFilterProxyModel::setSearchText(const QString& text) {
     if (m_searchText != text) {
+        // More letters typed after plain words can only drop rows
+        const bool narrows = !m_searchText.isEmpty() && text.startsWith(m_searchText)
+                             && PackageQuery::isPlainText(text) && PackageQuery::isPlainText(m_searchText);
         m_searchText = text;
-        beginFilterChange();
-        endFilterChange();
+        rebuildQuery(narrows);
     }
 }
 
 void PackageFilterProxyModel::setTagFilter(const QString& tag) {
     if (m_tagFilter != tag) {
         m_tagFilter = tag;
-        beginFilterChange();
-        endFilterChange();
+        rebuildQuery();
     }
 }
 
 void PackageFilterProxyModel::setMinSize(qint64 size) {
     if (m_minSize != size) {
         m_minSize = size;
-        beginFilterChange();
-        endFilterChange();
+        rebuildQuery();
     }
 }
 
 void PackageFilterProxyModel::setMaxSize(qint64 size) {
     if (m_maxSize != size) {
         m_maxSize = size;
-        beginFilterChange();
-        endFilterChange();
+        rebuildQuery();
     }
 }
 
-bool PackageFilterProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const {
-    QModelIndex index = sourceModel()->index(sourceRow, 0, sourceParent);
-    Package pkg = index.data(PackageListModel::PackageRole).value<Package>();
+void PackageFilterProxyModel::rebuildQuery(bool narrows) {
+    beginFilterChange();
     
-    // Search text filter
-    if (!m_searchText.isEmpty()) {
-        bool matchesSearch = pkg.name.contains(m_searchText, Qt::CaseInsensitive) ||
-                            pkg.description.contains(m_searchText, Qt::CaseInsensitive);
-        if (!matchesSearch) return false;
+    PackageQuery query = PackageQuery::compile(m_searchText, &m_queryError);
+    if (!m_queryError.isEmpty()) {
+        query = PackageQuery::containing(m_searchText.trimmed());
     }
     
-    // Tag filter
-    if (!m_tagFilter.isEmpty()) {
-        if (!pkg.userTags.contains(m_tagFilter)) return false;
-    }
-    
-    // Size filter
-    if (m_minSize > 0 && pkg.installedSize < m_minSize) return false;
-    if (m_maxSize >= 0 && pkg.installedSize > m_maxSize) return false;
-    
-    // Type filter
     switch (m_filterType) {
         case FilterAll:
-            return true;
+            break;
         case FilterExplicit:
-            return pkg.isExplicit();
+            query &= PackageQuery::compile("is:explicit");
+            break;
         case FilterDependency:
-            return !pkg.isExplicit();
+            query &= PackageQuery::compile("is:dep");
+            break;
         case FilterOrphan:
-            return pkg.isOrphan();
+            query &= PackageQuery::compile("is:orphan");
+            break;
         case FilterKeep:
-            return pkg.isMarkedKeep;
+            query &= PackageQuery::compile("is:keep");
+            break;
         case FilterReview:
-            return pkg.isMarkedReview;
+            query &= PackageQuery::compile("is:review");
+            break;
         case FilterLarge:
-            return pkg.installedSize > 100 * 1024 * 1024;  // > 100MB
+            query &= PackageQuery::sizeBetween(100 * 1024 * 1024 + 1, -1);  // > 100MB
+            break;
     }
+    query &= PackageQuery::withTag(m_tagFilter);
+    query &= PackageQuery::sizeBetween(m_minSize, m_maxSize);
     
-    return true;
+    m_query = query;
+    auto* model = qobject_cast<const PackageListModel*>(sourceModel());
+    if (narrows && m_matchesValid && model && m_matches.size() == model->rowCount()) {
+        m_matches = m_query.evaluate(*model, m_searchIndex, m_matches);
+    } else {
+        m_matchesValid = false;
+    }
+    endFilterChange();
+}
+
+const QBitArray& PackageFilterProxyModel::matches() const {
+    auto* model = qobject_cast<const PackageListModel*>(sourceModel());
+    if (!model) {
+        m_matches.clear();
+        return m_matches;
+    }
+    
+    if (!m_matchesValid || m_matches.size() != model->rowCount()) {
+        m_matches = m_query.evaluate(*model, m_searchIndex);
+        m_matchesValid = true;
+    }
+    return m_matches;
+}
+
+void PackageFilterProxyModel::updateMatches(int first, int last) {
+    auto* model = qobject_cast<const PackageListModel*>(sourceModel());
+    const int count = last - first + 1;
+    if (!m_matchesValid || !model || m_matches.size() != model->rowCount()
+        || count * PatchedRowsDivisor > model->rowCount()) {
+        m_matchesValid = false;
+        return;
+    }
+    
+    for (int row = first; row <= last; ++row) {
+        m_matches.setBit(row, m_query.matches(*model, m_searchIndex, row));
+    }
+}
+
+void PackageFilterProxyModel::insertMatches(int first, int last) {
+    auto* model = qobject_cast<const PackageListModel*>(sourceModel());
+    const int count = last - first + 1;
+    if (!m_matchesValid || !model || m_matches.size() + count != model->rowCount()
+        || count * PatchedRowsDivisor > model->rowCount()) {
+        m_matchesValid = false;
+        return;
+    }
+    
+    // Rows from first on move down by count; the new ones are checked
+    QBitArray shifted(model->rowCount());
+    for (int row = 0; row < m_matches.size(); ++row) {
+        if (m_matches.testBit(row)) {
+            shifted.setBit(row < first ? row : row + count);
+        }
+    }
+    for (int row = first; row <= last; ++row) {
+        shifted.setBit(row, m_query.matches(*model, m_searchIndex, row));
+    }
+    m_matches = shifted;
+}
+
+void PackageFilterProxyModel::removeMatches(int first, int last) {
+    auto* model = qobject_cast<const PackageListModel*>(sourceModel());
+    const int count = last - first + 1;
+    if (!m_matchesValid || !model || m_matches.size() - count != model->rowCount()) {
+        m_matchesValid = false;
+        return;
+    }
+    
+    // The remaining rows keep their results and move up by count
+    QBitArray shifted(model->rowCount());
+    for (int row = 0; row < m_matches.size(); ++row) {
+        if ((row < first || row > last) && m_matches.testBit(row)) {
+            shifted.setBit(row < first ? row : row - count);
+        }
+    }
+    m_matches = shifted;
+}
+
+bool PackageFilterProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const {
+    Q_UNUSED(sourceParent);
+    const QBitArray& rows = matches();
+    return sourceRow < rows.size() && rows.testBit(sourceRow);
 }
 
 bool PackageFilterProxyModel::lessThan(const QModelIndex& left, const QModelIndex& right) const {
+    if (auto* model = qobject_cast<const PackageListModel*>(sourceModel())) {
+        return model->rowLessThan(left.row(), right.row(), left.column());
+    }
+    
     QVariant leftData = sourceModel()->data(left, PackageListModel::SortRole);
     QVariant rightData = sourceModel()->data(right, PackageListModel::SortRole);
     
@@ -2,9 +2,21 @@
 #define PACKAGELISTMODEL_H
 
 #include <QAbstractTableModel>
+#include <QBitArray>
+#include <QCache>
+#include <QFont>
+#include <QHash>
 #include <QList>
 #include <QSortFilterProxyModel>
+#include <QVector>
+#include <memory>
 #include "Package.h"
+#include "PackageQuery.h"
+#include "PackageSortKeys.h"
+#include "core/TrigramIndex.h"
+
+class PackageStore;
+struct LocalDbChanges;
 
 class PackageListModel : public QAbstractTableModel {
     Q_OBJECT
@@ -14,6 +26,7 @@ public:
         NameColumn = 0,
         VersionColumn,
         SizeColumn,
+        ExclusiveSizeColumn,  // what removing it with -Rs would free
         InstallDateColumn,
         ReasonColumn,
         DescriptionColumn,
@@ -21,10 +34,23 @@ public:
     };
     
     enum Role {
-        PackageRole = Qt::UserRole + 1,
+        PackageRole = Qt::UserRole + 1,  // PackageSummary
         SortRole
     };
     
+    // Notes, tags and marks from our database; not part of the alpm data
+    struct UserData {
+        QString notes;
+        QStringList tags;
+        bool keep = false;
+        bool review = false;
+        
+        bool operator==(const UserData& other) const {
+            return keep == other.keep && review == other.review && notes == other.notes && tags == other.tags;
+        }
+        bool operator!=(const UserData& other) const { return !(*this == other); }
+    };
+    
     explicit PackageListModel(QObject* parent = nullptr);
     
     // QAbstractTableModel interface
@@ -33,24 +59,80 @@ public:
     QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
     QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
     
-    // Data management
-    void setPackages(const QList<Package>& packages);
-    void addPackage(const Package& package);
-    void updatePackage(const Package& package);
-    void removePackage(const QString& name);
+    // Data management. userData is indexed by package id and may be empty.
+    // A first store resets the model; later ones are diffed by name against
+    // the current rows, so selection and scroll position survive a reload.
+    void setStore(std::shared_ptr<const PackageStore> store, const QVector<UserData>& userData = {});
+    
+    // Moves to a reloaded store, emitting row inserts, removes and
+    // dataChanged for the packages in changes instead of a reset.
+    // addedUserData holds user data of newly installed packages by name.
+    // Returns false if changes don't account for the new store; the caller
+    // should then fall back to setStore().
+    bool applyChanges(std::shared_ptr<const PackageStore> store, const LocalDbChanges& changes,
+                      const QHash<QString, UserData>& addedUserData = {});
+    
+    void setUserData(int row, const UserData& data);
+    
+    // Single user data fields, changed in place
+    void setNotes(int row, const QString& notes);
+    void setTags(int row, const QStringList& tags);
+    void setKeep(int row, bool keep);
+    void setReview(int row, bool review);
     void clear();
     
-    Package getPackage(int row) const;
-    Package getPackageByName(const QString& name) const;
-    int findPackageRow(const QString& name) const;
+    const PackageStore* store() const { return m_store.get(); }
+    PackageId packageId(int row) const;
+    
+    int findPackageRow(const QString& name) const;  // -1 if not listed
+    
+    // Invalid / empty for rows out of range. Details are built for the rows
+    // asked about and the last few are kept until the store changes.
+    PackageSummary summary(int row) const;
+    PackageDetails details(int row) const;
+    
+    // Per-row user data
+    const UserData& userData(int row) const { return m_userData[row]; }
+    const QStringList& userTags(int row) const { return m_userData[row].tags; }
+    bool isMarkedKeep(int row) const { return m_userData[row].keep; }
+    bool isMarkedReview(int row) const { return m_userData[row].review; }
     
-    QList<Package> getAllPackages() const { return m_packages; }
+    // Keep marks as a bitset over package ids, for RemovalSimulator
+    QBitArray keepMarks() const;
+    
+    // Sort order of two rows by column, from the precomputed keys without
+    // going through SortRole variants. Ties go by name, so the order is
+    // total and rows keep their places across incremental updates.
+    bool rowLessThan(int left, int right, int column) const;
     
 signals:
     void packagesChanged();
     
 private:
-    QList<Package> m_packages;
+    // Formatted cell text, built the first time a row is shown and dropped
+    // whenever the row changes
+    struct DisplayText {
+        QString size;
+        QString exclusiveSize;
+        QString installDate;
+        QString toolTip;
+    };
+    const DisplayText& displayText(int row) const;
+    const QString& toolTip(int row) const;
+    
+    void emitRowsChanged(QVector<int> rows);
+    void emitUserDataChanged(int row);
+    void rebuildRowIndex();
+    void rebuildSortKeys();
+    
+    std::shared_ptr<const PackageStore> m_store;
+    QVector<PackageId> m_ids;       // row -> package id
+    QVector<UserData> m_userData;   // parallel to m_ids
+    QVector<int> m_rowOf;           // package id -> row; the store hashes names to ids
+    PackageSortKeys m_sortKeys;     // by package id
+    mutable QVector<DisplayText> m_display;  // parallel to m_ids
+    mutable QCache<PackageId, PackageDetails> m_details;
+    QFont m_boldFont;
 };
 
 // Proxy model for filtering and sorting
@@ -70,11 +152,16 @@ public:
     
     explicit PackageFilterProxyModel(QObject* parent = nullptr);
     
+    void setSourceModel(QAbstractItemModel* sourceModel) override;
+    
     void setFilterType(FilterType type);
     FilterType filterType() const { return m_filterType; }
     
+    // Compiled as a PackageQuery; text that doesn't parse is searched for
+    // literally and queryError() says why
     void setSearchText(const QString& text);
     QString searchText() const { return m_searchText; }
+    QString queryError() const { return m_queryError; }
     
     void setTagFilter(const QString& tag);
     QString tagFilter() const { return m_tagFilter; }
@@ -87,11 +174,30 @@ protected:
     bool lessThan(const QModelIndex& left, const QModelIndex& right) const override;
     
 private:
+    // Combines the search text and the other filters into m_query. With
+    // narrows, the new query can only match a subset of the current rows.
+    void rebuildQuery(bool narrows = false);
+    
+    // m_query evaluated over the source rows. Source changes are patched
+    // in: changed and inserted rows are re-checked on their own, removed
+    // ones dropped. Resets, layout changes and large updates redo it all.
+    const QBitArray& matches() const;
+    void updateMatches(int first, int last);
+    void insertMatches(int first, int last);
+    void removeMatches(int first, int last);
+    
     FilterType m_filterType = FilterAll;
     QString m_searchText;
+    QString m_queryError;
     QString m_tagFilter;
     qint64 m_minSize = 0;
     qint64 m_maxSize = -1;  // -1 means no limit
+    
+    PackageQuery m_query;
+    mutable TrigramIndex m_searchIndex;
+    mutable QBitArray m_matches;
+    mutable bool m_matchesValid = false;
+    QList<QMetaObject::Connection> m_sourceConnections;
 };
 
 #endif // PACKAGELISTMODEL_H
@@ -0,0 +1,645 @@
+#include "PackageQuery.h"
+#include "PackageListModel.h"
+#include "core/PackageStore.h"
+#include "core/TrigramIndex.h"
+#include "utils/SubstringSearch.h"
+#include <QDate>
+#include <QDateTime>
+#include <QVarLengthArray>
+#include <cmath>
+
+namespace {
+
+struct Token {
+    enum Kind { Word, Open, Close, Not, Or, And, End };
+    Kind kind = End;
+    QString key;    // for key:value words, lowercased
+    QString value;
+    bool quoted = false;
+};
+
+bool isBreak(QChar c) {
+    return c.isSpace() || c == u'(' || c == u')';
+}
+
+// i sits on the opening quote and ends up past the closing one
+bool readQuoted(const QString& text, int& i, QString* value, QString* error) {
+    const int close = text.indexOf(u'"', i + 1);
+    if (close < 0) {
+        *error = QStringLiteral("Missing closing quote");
+        return false;
+    }
+    *value = text.mid(i + 1, close - i - 1);
+    i = close + 1;
+    return true;
+}
+
+QVector<Token> tokenize(const QString& text, QString* error) {
+    QVector<Token> tokens;
+    const int n = text.size();
+    int i = 0;
+    while (i < n) {
+        const QChar c = text[i];
+        if (c.isSpace()) {
+            ++i;
+            continue;
+        }
+        if (c == u'(' || c == u')' || c == u'-' || c == u'!') {
+            Token token;
+            token.kind = c == u'(' ? Token::Open : (c == u')' ? Token::Close : Token::Not);
+            tokens.append(token);
+            ++i;
+            continue;
+        }
+    
+        Token token;
+        token.kind = Token::Word;
+        if (c == u'"') {
+            if (!readQuoted(text, i, &token.value, error)) return {};
+            token.quoted = true;
+            tokens.append(token);
+            continue;
+        }
+    
+        const int start = i;
+        while (i < n && !isBreak(text[i]) && text[i] != u':' && text[i] != u'"') {
+            ++i;
+        }
+        if (i < n && i > start && text[i] == u':') {
+            token.key = text.mid(start, i - start).toLower();
+            ++i;
+            if (i < n && text[i] == u'"') {
+                if (!readQuoted(text, i, &token.value, error)) return {};
+                token.quoted = true;
+            } else {
+                const int valueStart = i;
+                while (i < n && !isBreak(text[i])) {
+                    ++i;
+                }
+                token.value = text.mid(valueStart, i - valueStart);
+            }
+        } else {
+            // A stray ':' or '"' is just part of the word
+            while (i < n && !isBreak(text[i])) {
+                ++i;
+            }
+            token.value = text.mid(start, i - start);
+    
+            const QString word = token.value.toLower();
+            if (word == "or" || word == "|" || word == "||") {
+                token.kind = Token::Or;
+            } else if (word == "not") {
+                token.kind = Token::Not;
+            } else if (word == "and" || word == "&" || word == "&&") {
+                token.kind = Token::And;
+            }
+        }
+        tokens.append(token);
+    }
+    tokens.append(Token());  // End
+    
+    // Terms are ANDed anyway, so a conjunction between two operands is
+    // dropped; one without an operand on both sides is searched for
+    QVector<Token> resolved;
+    resolved.reserve(tokens.size());
+    for (int t = 0; t < tokens.size(); ++t) {
+        Token token = tokens[t];
+        if (token.kind == Token::And) {
+            const Token::Kind before = resolved.isEmpty() ? Token::End : resolved.last().kind;
+            const Token::Kind after = tokens[t + 1].kind;
+            if ((before == Token::Word || before == Token::Close)
+                && (after == Token::Word || after == Token::Open || after == Token::Not)) {
+                continue;
+            }
+            token.kind = Token::Word;
+        }
+        resolved.append(token);
+    }
+    return resolved;
+}
+
+// A value covers [first, end): one byte for sizes, a whole day, month or
+// year for dates
+struct Span {
+    qint64 first = 0;
+    qint64 end = 0;
+};
+
+bool parseSize(const QString& text, Span* span) {
+    static const QRegularExpression re(QStringLiteral("^(\\d+(?:\\.\\d+)?)\\s*([kmgt]?)(?:i?b)?$"),
+                                       QRegularExpression::CaseInsensitiveOption);
+    const QRegularExpressionMatch match = re.match(text);
+    if (!match.hasMatch()) return false;
+    
+    double bytes = match.captured(1).toDouble();
+    const QString unit = match.captured(2).toLower();
+    const int power = unit.isEmpty() ? 0 : QStringLiteral("kmgt").indexOf(unit) + 1;
+    bytes *= std::pow(1024.0, power);
+    span->first = qint64(std::llround(bytes));
+    span->end = span->first + 1;
+    return true;
+}
+
+bool parseDate(const QString& text, Span* span) {
+    QDate first = QDate::fromString(text, QStringLiteral("yyyy-MM-dd"));
+    QDate end = first.addDays(1);
+    if (!first.isValid()) {
+        first = QDate::fromString(text, QStringLiteral("yyyy-MM"));
+        end = first.addMonths(1);
+    }
+    if (!first.isValid()) {
+        first = QDate::fromString(text, QStringLiteral("yyyy"));
+        end = first.addYears(1);
+    }
+    if (!first.isValid()) return false;
+    
+    // Install dates are shown in local time, so periods are local too
+    span->first = first.startOfDay().toSecsSinceEpoch();
+    span->end = end.startOfDay().toSecsSinceEpoch();
+    return true;
+}
+
+} // namespace
+
+class PackageQuery::Parser {
+public:
+    Parser(const QVector<Token>& tokens, QVector<Instruction>& program)
+        : m_tokens(tokens), m_program(program) {}
+    
+    bool parse() {
+        if (peek().kind == Token::End) return true;
+        if (!parseOr()) return false;
+        if (peek().kind != Token::End) return fail(QStringLiteral("Unexpected \")\""));
+        return true;
+    }
+    
+    const QString& error() const { return m_error; }
+
+private:
+    using SpanParser = bool (*)(const QString&, Span*);
+    
+    const Token& peek() const { return m_tokens[m_pos]; }
+    
+    bool fail(const QString& message) {
+        m_error = message;
+        return false;
+    }
+    
+    void emitOp(Op op) {
+        Instruction instruction;
+        instruction.op = op;
+        m_program.append(instruction);
+    }
+    
+    bool emitTest(Field field, const QString& text = QString()) {
+        Instruction instruction;
+        instruction.field = field;
+        instruction.text = text;
+        m_program.append(instruction);
+        return true;
+    }
+    
+    bool parseOr() {
+        if (!parseAnd()) return false;
+        while (peek().kind == Token::Or) {
+            ++m_pos;
+            if (!parseAnd()) return false;
+            emitOp(Op::Or);
+        }
+        return true;
+    }
+    
+    bool parseAnd() {
+        if (!parseUnary()) return false;
+        for (Token::Kind kind = peek().kind; kind == Token::Word || kind == Token::Open || kind == Token::Not;
+             kind = peek().kind) {
+            if (!parseUnary()) return false;
+            emitOp(Op::And);
+        }
+        return true;
+    }
+    
+    bool parseUnary() {
+        const Token& token = peek();
+        switch (token.kind) {
+            case Token::Not:
+                ++m_pos;
+                if (!parseUnary()) return false;
+                emitOp(Op::Not);
+                return true;
+            case Token::Open:
+                ++m_pos;
+                if (!parseOr()) return false;
+                if (peek().kind != Token::Close) return fail(QStringLiteral("Missing \")\""));
+                ++m_pos;
+                return true;
+            case Token::Word:
+                ++m_pos;
+                return parseTerm(token);
+            case Token::Close:
+                return fail(QStringLiteral("Unexpected \")\""));
+            case Token::Or:
+                return fail(QStringLiteral("\"or\" needs a term on both sides"));
+            case Token::And:  // resolved by tokenize()
+            case Token::End:
+                break;
+        }
+        return fail(QStringLiteral("Expected a term"));
+    }
+    
+    bool parseFlag(const QString& value) {
+        const QString flag = value.toLower();
+        if (flag == "orphan") return emitTest(Field::Orphan);
+        if (flag == "keep") return emitTest(Field::Keep);
+        if (flag == "review") return emitTest(Field::Review);
+        if (flag == "explicit" || flag == "exp") return emitTest(Field::Explicit);
+        if (flag == "dep" || flag == "dependency") {
+            emitTest(Field::Explicit);
+            emitOp(Op::Not);
+            return true;
+        }
+        return fail(QString("Unknown value \"%1\"").arg(value));
+    }
+    
+    bool parseTerm(const Token& token) {
+        const QString& key = token.key;
+        const QString& value = token.value;
+        if (key.isEmpty()) return emitTest(Field::Text, value);
+        if (value.isEmpty()) return fail(QString("Missing value after \"%1:\"").arg(key));
+    
+        if (key == "name") {
+            if (!value.contains(u'*') && !value.contains(u'?')) return emitTest(Field::Name, value);
+    
+            Instruction instruction;
+            instruction.field = Field::Name;
+            instruction.pattern = QRegularExpression(QRegularExpression::wildcardToRegularExpression(value),
+                                                     QRegularExpression::CaseInsensitiveOption);
+            if (!instruction.pattern.isValid()) return fail(QString("Invalid pattern \"%1\"").arg(value));
+            m_program.append(instruction);
+            return true;
+        }
+        if (key == "desc" || key == "description") return emitTest(Field::Description, value);
+        if (key == "group" || key == "groups") return emitTest(Field::Group, value);
+        if (key == "provides") return emitTest(Field::Provides, value);
+        if (key == "tag") return emitTest(Field::Tag, value);
+        if (key == "size") return parseRange(Field::Size, value, parseSize);
+        if (key == "exclusive") return parseRange(Field::ExclusiveSize, value, parseSize);
+        if (key == "installed") return parseRange(Field::Installed, value, parseDate);
+        if (key == "reason") {
+            const QString reason = value.toLower();
+            if (reason != "explicit" && reason != "exp" && reason != "dep" && reason != "dependency") {
+                return fail(QString("Unknown reason \"%1\"").arg(value));
+            }
+            return parseFlag(reason);
+        }
+        if (key == "is") return parseFlag(value);
+    
+        return fail(QString("Unknown filter \"%1:\"").arg(key));
+    }
+    
+    // =v, <v, <=v, >v, >=v or lo..hi, turned into an inclusive range
+    bool parseRange(Field field, const QString& value, SpanParser parseValue) {
+        Instruction instruction;
+        instruction.field = field;
+        const QString invalid = QString("Invalid value \"%1\"").arg(value);
+    
+        const int dots = value.indexOf(QLatin1String(".."));
+        if (dots >= 0) {
+            const QString low = value.left(dots);
+            const QString high = value.mid(dots + 2);
+            Span span;
+            if (!low.isEmpty()) {
+                if (!parseValue(low, &span)) return fail(invalid);
+                instruction.min = span.first;
+            }
+            if (!high.isEmpty()) {
+                if (!parseValue(high, &span)) return fail(invalid);
+                instruction.max = span.end - 1;
+            }
+            m_program.append(instruction);
+            return true;
+        }
+    
+        QString op;
+        for (const char* candidate : {">=", "<=", ">", "<", "="}) {
+            if (value.startsWith(QLatin1String(candidate))) {
+                op = QLatin1String(candidate);
+                break;
+            }
+        }
+        Span span;
+        if (!parseValue(value.mid(op.size()), &span)) return fail(invalid);
+    
+        if (op == ">") {
+            instruction.min = span.end;
+        } else if (op == ">=") {
+            instruction.min = span.first;
+        } else if (op == "<") {
+            instruction.max = span.first - 1;
+        } else if (op == "<=") {
+            instruction.max = span.end - 1;
+        } else {
+            instruction.min = span.first;
+            instruction.max = span.end - 1;
+        }
+        m_program.append(instruction);
+        return true;
+    }
+    
+    const QVector<Token>& m_tokens;
+    QVector<Instruction>& m_program;
+    int m_pos = 0;
+    QString m_error;
+};
+
+PackageQuery PackageQuery::compile(const QString& text, QString* error) {
+    PackageQuery query;
+    QString message;
+    const QVector<Token> tokens = tokenize(text, &message);
+    if (message.isEmpty()) {
+        Parser parser(tokens, query.m_program);
+        if (!parser.parse()) {
+            message = parser.error();
+        }
+    }
+    
+    if (!message.isEmpty()) {
+        query.m_program.clear();
+    }
+    if (error) {
+        *error = message;
+    }
+    return query;
+}
+
+PackageQuery PackageQuery::single(const Instruction& instruction) {
+    PackageQuery query;
+    query.m_program.append(instruction);
+    return query;
+}
+
+PackageQuery PackageQuery::containing(const QString& text) {
+    if (text.isEmpty()) return PackageQuery();
+    Instruction instruction;
+    instruction.field = Field::Text;
+    instruction.text = text;
+    return single(instruction);
+}
+
+PackageQuery PackageQuery::withTag(const QString& tag) {
+    if (tag.isEmpty()) return PackageQuery();
+    Instruction instruction;
+    instruction.field = Field::Tag;
+    instruction.text = tag;
+    return single(instruction);
+}
+
+PackageQuery PackageQuery::sizeBetween(qint64 min, qint64 max) {
+    if (min <= 0 && max < 0) return PackageQuery();
+    Instruction instruction;
+    instruction.field = Field::Size;
+    if (min > 0) instruction.min = min;
+    if (max >= 0) instruction.max = max;
+    return single(instruction);
+}
+
+PackageQuery& PackageQuery::operator&=(const PackageQuery& other) {
+    if (other.isEmpty()) return *this;
+    if (isEmpty()) {
+        m_program = other.m_program;
+        return *this;
+    }
+    m_program += other.m_program;
+    Instruction conjunction;
+    conjunction.op = Op::And;
+    m_program.append(conjunction);
+    return *this;
+}
+
+bool PackageQuery::isPlainText(const QString& text) {
+    QString error;
+    const QVector<Token> tokens = tokenize(text, &error);
+    if (!error.isEmpty()) return false;
+    
+    for (const Token& token : tokens) {
+        if (token.kind == Token::End) break;
+        if (token.kind != Token::Word || !token.key.isEmpty()) return false;
+    }
+    return true;
+}
+
+QBitArray PackageQuery::test(const Instruction& instruction, const PackageListModel& model,
+                             TrigramIndex& textIndex, const QBitArray* within) {
+    const int rows = model.rowCount();
+    const PackageStore& pkgs = *model.store();
+    QBitArray bits(rows);
+    
+    // One tight loop per predicate, reading a single column
+    auto select = [&](auto accept) {
+        for (int row = 0; row < rows; ++row) {
+            if (within && !within->testBit(row)) continue;
+            if (accept(row, model.packageId(row))) {
+                bits.setBit(row);
+            }
+        }
+    };
+    auto inRange = [&instruction](qint64 value) {
+        return value >= instruction.min && value <= instruction.max;
+    };
+    auto selectIds = [&](const QBitArray& ids) {
+        select([&ids](int, PackageId id) { return ids.testBit(id); });
+    };
+    auto listContains = [&pkgs, &instruction](PackageStore::IdRange ids) {
+        for (StringPool::Id id : ids) {
+            if (pkgs.strings().at(id).compare(instruction.text, Qt::CaseInsensitive) == 0) return true;
+        }
+        return false;
+    };
+    
+    switch (instruction.field) {
+        case Field::Text: {
+            if (textIndex.generation() != pkgs.generation() || textIndex.size() != pkgs.size()) {
+                textIndex.update(pkgs);
+            }
+            // Few rows left: checking them directly beats a full index lookup
+            if (within && within->count(true) < rows / 8) {
+                const QByteArray needle = SubstringSearch::fold(instruction.text);
+                select([&](int, PackageId id) { return textIndex.contains(id, needle); });
+                break;
+            }
+            QBitArray hits(pkgs.size());
+            for (PackageId id : textIndex.search(instruction.text)) {
+                hits.setBit(id);
+            }
+            selectIds(hits);
+            break;
+        }
+        case Field::Name:
+            if (instruction.text.isEmpty()) {
+                select([&](int, PackageId id) { return instruction.pattern.match(pkgs.name(id)).hasMatch(); });
+            } else {
+                selectIds(pkgs.foldedText().matching(instruction.text, FoldedText::NameField));
+            }
+            break;
+        case Field::Description:
+            selectIds(pkgs.foldedText().matching(instruction.text, FoldedText::DescriptionField));
+            break;
+        case Field::Group:
+            select([&](int, PackageId id) { return listContains(pkgs.groupIds(id)); });
+            break;
+        case Field::Provides:
+            select([&](int, PackageId id) { return listContains(pkgs.provideIds(id)); });
+            break;
+        case Field::Size:
+            select([&](int, PackageId id) { return inRange(pkgs.installedSize(id)); });
+            break;
+        case Field::ExclusiveSize:
+            select([&](int, PackageId id) { return inRange(pkgs.exclusiveSize(id)); });
+            break;
+        case Field::Installed:
+            select([&](int, PackageId id) { return inRange(pkgs.installDateSecs(id)); });
+            break;
+        case Field::Explicit:
+            select([&](int, PackageId id) { return pkgs.isExplicit(id); });
+            break;
+        case Field::Orphan:
+            select([&](int, PackageId id) { return pkgs.isOrphan(id); });
+            break;
+        case Field::Keep:
+            select([&](int row, PackageId) { return model.isMarkedKeep(row); });
+            break;
+        case Field::Review:
+            select([&](int row, PackageId) { return model.isMarkedReview(row); });
+            break;
+        case Field::Tag:
+            select([&](int row, PackageId) { return model.userTags(row).contains(instruction.text); });
+            break;
+    }
+    return bits;
+}
+
+bool PackageQuery::testRow(const Instruction& instruction, const PackageListModel& model,
+                           TrigramIndex& textIndex, int row) {
+    const PackageStore& pkgs = *model.store();
+    const PackageId id = model.packageId(row);
+    auto inRange = [&instruction](qint64 value) {
+        return value >= instruction.min && value <= instruction.max;
+    };
+    auto listContains = [&pkgs, &instruction](PackageStore::IdRange ids) {
+        for (StringPool::Id id : ids) {
+            if (pkgs.strings().at(id).compare(instruction.text, Qt::CaseInsensitive) == 0) return true;
+        }
+        return false;
+    };
+    
+    switch (instruction.field) {
+        case Field::Text:
+            if (textIndex.generation() != pkgs.generation() || textIndex.size() != pkgs.size()) {
+                textIndex.update(pkgs);
+            }
+            return textIndex.contains(id, SubstringSearch::fold(instruction.text));
+        case Field::Name:
+            if (instruction.text.isEmpty()) {
+                return instruction.pattern.match(pkgs.name(id)).hasMatch();
+            }
+            return SubstringSearch::contains(pkgs.foldedText().name(id), SubstringSearch::fold(instruction.text));
+        case Field::Description:
+            return SubstringSearch::contains(pkgs.foldedText().description(id), SubstringSearch::fold(instruction.text));
+        case Field::Group:
+            return listContains(pkgs.groupIds(id));
+        case Field::Provides:
+            return listContains(pkgs.provideIds(id));
+        case Field::Size:
+            return inRange(pkgs.installedSize(id));
+        case Field::ExclusiveSize:
+            return inRange(pkgs.exclusiveSize(id));
+        case Field::Installed:
+            return inRange(pkgs.installDateSecs(id));
+        case Field::Explicit:
+            return pkgs.isExplicit(id);
+        case Field::Orphan:
+            return pkgs.isOrphan(id);
+        case Field::Keep:
+            return model.isMarkedKeep(row);
+        case Field::Review:
+            return model.isMarkedReview(row);
+        case Field::Tag:
+            return model.userTags(row).contains(instruction.text);
+    }
+    return false;
+}
+
+QBitArray PackageQuery::evaluate(const PackageListModel& model, TrigramIndex& textIndex) const {
+    return run(model, textIndex, nullptr);
+}
+
+QBitArray PackageQuery::evaluate(const PackageListModel& model, TrigramIndex& textIndex, const QBitArray& within) const {
+    if (within.size() != model.rowCount()) return run(model, textIndex, nullptr);
+    return run(model, textIndex, &within);
+}
+
+QBitArray PackageQuery::run(const PackageListModel& model, TrigramIndex& textIndex, const QBitArray* within) const {
+    const int rows = model.rowCount();
+    if (!model.store()) return QBitArray(rows);
+    if (m_program.isEmpty()) return within ? *within : QBitArray(rows, true);
+    
+    // Postfix program over whole-table bitmaps; combining them is a bulk
+    // word-wise operation instead of a branch per row
+    QVector<QBitArray> stack;
+    for (const Instruction& instruction : m_program) {
+        switch (instruction.op) {
+            case Op::Test:
+                stack.append(test(instruction, model, textIndex, within));
+                break;
+            case Op::Not:
+                stack.last() = ~stack.last();
+                break;
+            case Op::And: {
+                QBitArray rhs = stack.takeLast();
+                stack.last() &= rhs;
+                break;
+            }
+            case Op::Or: {
+                QBitArray rhs = stack.takeLast();
+                stack.last() |= rhs;
+                break;
+            }
+        }
+    }
+    // NOT may have set rows outside within
+    if (within) {
+        stack.last() &= *within;
+    }
+    return stack.last();
+}
+
+bool PackageQuery::matches(const PackageListModel& model, TrigramIndex& textIndex, int row) const {
+    if (!model.store() || row < 0 || row >= model.rowCount()) return false;
+    if (m_program.isEmpty()) return true;
+    
+    // The same postfix program, over one bit per term
+    QVarLengthArray<bool, 16> stack;
+    for (const Instruction& instruction : m_program) {
+        switch (instruction.op) {
+            case Op::Test:
+                stack.append(testRow(instruction, model, textIndex, row));
+                break;
+            case Op::Not:
+                stack.last() = !stack.last();
+                break;
+            case Op::And: {
+                bool rhs = stack.last();
+                stack.removeLast();
+                stack.last() = stack.last() && rhs;
+                break;
+            }
+            case Op::Or: {
+                bool rhs = stack.last();
+                stack.removeLast();
+                stack.last() = stack.last() || rhs;
+                break;
+            }
+        }
+    }
+    return stack.last();
+}
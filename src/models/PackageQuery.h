@@ -0,0 +1,107 @@
+#ifndef PACKAGEQUERY_H
+#define PACKAGEQUERY_H
+
+#include <QBitArray>
+#include <QRegularExpression>
+#include <QString>
+#include <QVector>
+#include <limits>
+
+class PackageListModel;
+class TrigramIndex;
+
+// Filter expression for the Packages view, compiled once and evaluated a
+// column at a time into bitmaps over the model's rows.
+//
+//   size:>100M reason:dep tag:work installed:<2024-01 is:orphan name:lib*
+//
+// Terms are ANDed ("and"/"&" between two terms is allowed; anywhere else
+// it is a word); "or"/"|" and "not"/"-" combine them and parentheses
+// group. Bare words search name, description, provides and groups. Keys:
+//   name:      substring, or an anchored glob with * and ?
+//   desc:      substring of the description
+//   group:, provides:  exact entry, case-insensitive
+//   size:, exclusive:  bytes with an optional K/M/G/T suffix
+//   installed: yyyy, yyyy-MM or yyyy-MM-dd
+//   reason:    explicit or dep
+//   tag:       one of the user's tags
+//   is:        orphan, keep, review, explicit or dep
+// Numbers and dates take =, <, <=, > or >=, or a lo..hi range.
+class PackageQuery {
+public:
+    PackageQuery() = default;  // matches every row
+    
+    // An empty query on error, with a message in *error
+    static PackageQuery compile(const QString& text, QString* error = nullptr);
+    
+    // Single terms, for filters set from the UI rather than typed
+    static PackageQuery containing(const QString& text);
+    static PackageQuery withTag(const QString& tag);
+    static PackageQuery sizeBetween(qint64 min, qint64 max);
+    
+    bool isEmpty() const { return m_program.isEmpty(); }
+    
+    // Only bare words: typing more can then only narrow the matches, so the
+    // previous result can be refined instead of rescanning
+    static bool isPlainText(const QString& text);
+    
+    PackageQuery& operator&=(const PackageQuery& other);
+    
+    // One bit per model row. textIndex answers the text terms and is
+    // brought up to date with the model's store first.
+    QBitArray evaluate(const PackageListModel& model, TrigramIndex& textIndex) const;
+    
+    // Same, but only rows set in within are considered
+    QBitArray evaluate(const PackageListModel& model, TrigramIndex& textIndex, const QBitArray& within) const;
+    
+    // Whether a single row matches, for re-checking rows that changed
+    // without going over whole columns
+    bool matches(const PackageListModel& model, TrigramIndex& textIndex, int row) const;
+
+private:
+    class Parser;
+    
+    enum class Field {
+        Text,
+        Name,
+        Description,
+        Group,
+        Provides,
+        Size,
+        ExclusiveSize,
+        Installed,
+        Explicit,
+        Orphan,
+        Keep,
+        Review,
+        Tag
+    };
+    
+    enum class Op {
+        Test,  // pushes the rows matching one predicate
+        And,
+        Or,
+        Not
+    };
+    
+    // Numeric predicates are inclusive ranges; text ones use text/pattern
+    struct Instruction {
+        Op op = Op::Test;
+        Field field = Field::Text;
+        qint64 min = std::numeric_limits<qint64>::min();
+        qint64 max = std::numeric_limits<qint64>::max();
+        QString text;
+        QRegularExpression pattern;  // name globs
+    };
+    
+    static PackageQuery single(const Instruction& instruction);
+    static QBitArray test(const Instruction& instruction, const PackageListModel& model,
+                          TrigramIndex& textIndex, const QBitArray* within);
+    static bool testRow(const Instruction& instruction, const PackageListModel& model,
+                        TrigramIndex& textIndex, int row);
+    QBitArray run(const PackageListModel& model, TrigramIndex& textIndex, const QBitArray* within) const;
+    
+    QVector<Instruction> m_program;  // postfix
+};
+
+#endif // PACKAGEQUERY_H
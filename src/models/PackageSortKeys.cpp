@@ -0,0 +1,171 @@
+#include "PackageSortKeys.h"
+#include "core/PackageStore.h"
+#include "utils/VersionCompare.h"
+#include <QtConcurrent>
+#include <algorithm>
+#include <functional>
+#include <numeric>
+
+namespace {
+
+// Rank of every package under compare (< 0, 0, > 0), equal keys sharing one
+QVector<int> rankBy(int count, const std::function<int(PackageId, PackageId)>& compare) {
+    QVector<PackageId> order(count);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&compare](PackageId a, PackageId b) {
+        return compare(a, b) < 0;
+    });
+    
+    QVector<int> ranks(count);
+    int rank = 0;
+    for (int i = 0; i < count; ++i) {
+        if (i > 0 && compare(order[i - 1], order[i]) != 0) {
+            ++rank;
+        }
+        ranks[order[i]] = rank;
+    }
+    return ranks;
+}
+
+// Ranks for a store in which only the fresh packages are new or changed.
+// oldIdOf maps every other package to its id in the store oldRanks were
+// built for; those keep their order among themselves, and the fresh ones
+// are sorted and placed by binary search, so compare runs O(k log n) times
+// instead of the O(n log n) of rankBy.
+QVector<int> spliceRanks(const QVector<int>& oldRanks, const QVector<PackageId>& oldIdOf,
+                         QVector<PackageId> fresh, const std::function<int(PackageId, PackageId)>& compare) {
+    const int count = oldIdOf.size();
+    auto less = [&compare](PackageId a, PackageId b) { return compare(a, b) < 0; };
+    
+    // Kept packages in their old order, bucketed by old rank
+    QVector<int> start(oldRanks.size() + 1, 0);
+    for (PackageId id = 0; id < count; ++id) {
+        if (oldIdOf[id] >= 0) ++start[oldRanks[oldIdOf[id]] + 1];
+    }
+    std::partial_sum(start.begin(), start.end(), start.begin());
+    QVector<PackageId> kept(start.last());
+    for (PackageId id = 0; id < count; ++id) {
+        if (oldIdOf[id] >= 0) kept[start[oldRanks[oldIdOf[id]]]++] = id;
+    }
+    
+    std::sort(fresh.begin(), fresh.end(), less);
+    QVector<PackageId> order;
+    order.reserve(count);
+    auto next = kept.cbegin();
+    for (PackageId id : fresh) {
+        auto after = std::upper_bound(next, kept.cend(), id, less);
+        for (; next != after; ++next) order.append(*next);
+        order.append(id);
+    }
+    for (; next != kept.cend(); ++next) order.append(*next);
+    
+    // Kept neighbours tie as they did before; only a fresh one is compared
+    QVector<int> ranks(count);
+    int rank = 0;
+    for (int i = 0; i < order.size(); ++i) {
+        if (i > 0) {
+            const PackageId a = order[i - 1];
+            const PackageId b = order[i];
+            const bool tie = oldIdOf[a] >= 0 && oldIdOf[b] >= 0
+                ? oldRanks[oldIdOf[a]] == oldRanks[oldIdOf[b]]
+                : compare(a, b) == 0;
+            if (!tie) ++rank;
+        }
+        ranks[order[i]] = rank;
+    }
+    return ranks;
+}
+
+int compareBytes(QByteArrayView a, QByteArrayView b) {
+    return a == b ? 0 : (std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end(),
+                             [](char x, char y) { return uchar(x) < uchar(y); }) ? -1 : 1);
+}
+
+int compareNames(const PackageStore& store, PackageId a, PackageId b) {
+    const FoldedText& folded = store.foldedText();
+    int rc = compareBytes(folded.name(a), folded.name(b));
+    return rc != 0 ? rc : store.name(a).compare(store.name(b));
+}
+
+int compareDescriptions(const PackageStore& store, PackageId a, PackageId b) {
+    const FoldedText& folded = store.foldedText();
+    return compareBytes(folded.description(a), folded.description(b));
+}
+
+// Above this share of new or changed packages, update() sorts from scratch
+constexpr int SpliceDivisor = 8;
+
+} // namespace
+
+void PackageSortKeys::build(const PackageStore& store) {
+    const int count = store.size();
+    
+    // Versions split once; the parts point into utf8
+    QVector<QByteArray> utf8(count);
+    QVector<VersionCompare::Parts> versions(count);
+    
+    // The three columns sort independently of each other
+    QVector<std::function<void()>> jobs = {
+        [&]() {
+            m_name = rankBy(count, [&](PackageId a, PackageId b) { return compareNames(store, a, b); });
+        },
+        [&]() {
+            for (PackageId id = 0; id < count; ++id) {
+                utf8[id] = store.version(id).toUtf8();
+                versions[id] = VersionCompare::split(utf8[id]);
+            }
+            m_version = rankBy(count, [&](PackageId a, PackageId b) {
+                return VersionCompare::compare(versions[a], versions[b]);
+            });
+        },
+        [&]() {
+            m_description = rankBy(count, [&](PackageId a, PackageId b) { return compareDescriptions(store, a, b); });
+        }
+    };
+    QtConcurrent::blockingMap(jobs, [](const std::function<void()>& job) { job(); });
+}
+
+void PackageSortKeys::update(const PackageStore& previous, const PackageStore& store) {
+    const int count = store.size();
+    if (m_name.size() != previous.size()) {
+        build(store);
+        return;
+    }
+    
+    // A package keeps its place if its name, version and folded description
+    // are what they were; everything else is fresh
+    const FoldedText& oldFolded = previous.foldedText();
+    const FoldedText& folded = store.foldedText();
+    QVector<PackageId> oldIdOf(count, -1);
+    QVector<PackageId> fresh;
+    for (PackageId id = 0; id < count; ++id) {
+        const PackageId old = previous.find(store.name(id));
+        if (old >= 0 && previous.version(old) == store.version(id)
+            && oldFolded.description(old) == folded.description(id)) {
+            oldIdOf[id] = old;
+        } else {
+            fresh.append(id);
+        }
+    }
+    if (fresh.size() > count / SpliceDivisor) {
+        build(store);
+        return;
+    }
+    
+    m_name = spliceRanks(m_name, oldIdOf, fresh, [&](PackageId a, PackageId b) {
+        return compareNames(store, a, b);
+    });
+    // Only the versions compared are split, not every package's
+    m_version = spliceRanks(m_version, oldIdOf, fresh, [&](PackageId a, PackageId b) {
+        return VersionCompare::compare(store.version(a).toUtf8(), store.version(b).toUtf8());
+    });
+    m_description = spliceRanks(m_description, oldIdOf, fresh, [&](PackageId a, PackageId b) {
+        return compareDescriptions(store, a, b);
+    });
+}
+
+void PackageSortKeys::clear() {
+    m_name.clear();
+    m_version.clear();
+    m_description.clear();
+}
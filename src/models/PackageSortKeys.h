@@ -0,0 +1,37 @@
+#ifndef PACKAGESORTKEYS_H
+#define PACKAGESORTKEYS_H
+
+#include <QVector>
+#include "Package.h"
+
+class PackageStore;
+
+// Sort keys for the package table's text columns, computed once per store.
+//
+// Each package gets its rank in the column's order: names and descriptions
+// by their case-folded text, versions by alpm's vercmp. Sorting the table
+// then compares two ints per step instead of folding strings or parsing
+// versions. Equal keys share a rank; names never tie, since the folded
+// text falls back to the exact name.
+//
+// After an incremental reload, update() keeps the order of the packages
+// that didn't change and only sorts the new and changed ones into it.
+class PackageSortKeys {
+public:
+    void build(const PackageStore& store);
+    // Keys for store from those built for previous; builds from scratch
+    // when too much changed
+    void update(const PackageStore& previous, const PackageStore& store);
+    void clear();
+    
+    int name(PackageId id) const { return m_name[id]; }
+    int version(PackageId id) const { return m_version[id]; }
+    int description(PackageId id) const { return m_description[id]; }
+    
+private:
+    QVector<int> m_name;
+    QVector<int> m_version;
+    QVector<int> m_description;
+};
+
+#endif // PACKAGESORTKEYS_H
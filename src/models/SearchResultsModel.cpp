@@ -0,0 +1,172 @@
+#include "SearchResultsModel.h"
+#include "utils/VersionCompare.h"
+#include <QColor>
+#include <algorithm>
+#include <numeric>
+
+SearchResultsModel::SearchResultsModel(QObject* parent)
+    : QAbstractTableModel(parent)
+{
+}
+
+int SearchResultsModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : m_order.size();
+}
+
+int SearchResultsModel::columnCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant SearchResultsModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || index.row() >= m_order.size()) {
+        return QVariant();
+    }
+
+    const int i = m_order[index.row()];
+    const SearchResult& result = m_results[i];
+
+    if (role == Qt::DisplayRole) {
+        switch (index.column()) {
+            case NameColumn:
+                return result.name;
+            case VersionColumn:
+                return result.version;
+            case StatusColumn: {
+                static const QString installed = QStringLiteral("✅ Installed");
+                static const QString available = QStringLiteral("⬇️ Available");
+                return result.installed ? installed : available;
+            }
+            case DescriptionColumn:
+                return m_descriptions[i];
+        }
+    }
+    else if (role == Qt::ForegroundRole && index.column() == StatusColumn) {
+        if (result.installed) {
+            return QColor(m_dark ? "#a6e3a1" : "#40a02b");
+        }
+        return QColor(m_dark ? "#89b4fa" : "#1e66f5");
+    }
+    else if (role == Qt::ToolTipRole && index.column() == DescriptionColumn) {
+        return m_descriptions[i];
+    }
+
+    return QVariant();
+}
+
+QVariant SearchResultsModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+
+    switch (section) {
+        case NameColumn: return tr("Name");
+        case VersionColumn: return tr("Version");
+        case StatusColumn: return tr("Status");
+        case DescriptionColumn: return tr("Description");
+    }
+
+    return QVariant();
+}
+
+void SearchResultsModel::sort(int column, Qt::SortOrder order) {
+    emit layoutAboutToBeChanged({}, QAbstractItemModel::VerticalSortHint);
+    const QModelIndexList before = persistentIndexList();
+    QVector<int> results;
+    results.reserve(before.size());
+    for (const QModelIndex& index : before) {
+        results.append(m_order[index.row()]);
+    }
+
+    m_sortColumn = column;
+    m_sortOrder = order;
+    applySort();
+
+    // Selection and current row follow their results
+    QVector<int> rowOf(m_order.size());
+    for (int row = 0; row < m_order.size(); ++row) {
+        rowOf[m_order[row]] = row;
+    }
+    QModelIndexList after;
+    after.reserve(before.size());
+    for (int k = 0; k < before.size(); ++k) {
+        after.append(index(rowOf[results[k]], before[k].column()));
+    }
+    changePersistentIndexList(before, after);
+    emit layoutChanged({}, QAbstractItemModel::VerticalSortHint);
+}
+
+void SearchResultsModel::applySort() {
+    m_order.resize(m_results.size());
+    std::iota(m_order.begin(), m_order.end(), 0);
+    if (m_sortColumn < 0) return;  // ranked order
+
+    // Versions are split once, not per comparison
+    QVector<QByteArray> utf8;
+    QVector<VersionCompare::Parts> versions;
+    if (m_sortColumn == VersionColumn) {
+        utf8.resize(m_results.size());
+        versions.resize(m_results.size());
+        for (int i = 0; i < m_results.size(); ++i) {
+            utf8[i] = m_results[i].version.toUtf8();
+            versions[i] = VersionCompare::split(utf8[i]);
+        }
+    }
+
+    auto less = [this, &versions](int a, int b) {
+        const SearchResult& left = m_results[a];
+        const SearchResult& right = m_results[b];
+        switch (m_sortColumn) {
+            case VersionColumn:
+                return VersionCompare::compare(versions[a], versions[b]) < 0;
+            case StatusColumn:
+                return left.installed && !right.installed;
+            case DescriptionColumn:
+                return m_descriptions[a].compare(m_descriptions[b], Qt::CaseInsensitive) < 0;
+            default:
+                return left.name.compare(right.name, Qt::CaseInsensitive) < 0;
+        }
+    };
+    // Stable, so equal keys keep their ranking
+    if (m_sortOrder == Qt::AscendingOrder) {
+        std::stable_sort(m_order.begin(), m_order.end(), less);
+    } else {
+        std::stable_sort(m_order.begin(), m_order.end(), [&less](int a, int b) { return less(b, a); });
+    }
+}
+
+void SearchResultsModel::setResults(const QVector<SearchResult>& results) {
+    beginResetModel();
+    m_results = results;
+    m_descriptions.clear();
+    m_descriptions.reserve(m_results.size());
+    for (const SearchResult& result : m_results) {
+        m_descriptions.append(result.files.isEmpty() ? result.description
+                                                     : "📂 " + result.files.join(", "));
+    }
+    applySort();
+    endResetModel();
+}
+
+void SearchResultsModel::clear() {
+    beginResetModel();
+    m_results.clear();
+    m_descriptions.clear();
+    m_order.clear();
+    endResetModel();
+}
+
+void SearchResultsModel::setInstalled(int row, bool installed) {
+    if (row < 0 || row >= m_order.size()) return;
+
+    m_results[m_order[row]].installed = installed;
+    emit dataChanged(index(row, StatusColumn), index(row, StatusColumn));
+}
+
+void SearchResultsModel::setDarkTheme(bool dark) {
+    if (m_dark == dark) return;
+
+    m_dark = dark;
+    if (!m_order.isEmpty()) {
+        emit dataChanged(index(0, StatusColumn), index(m_order.size() - 1, StatusColumn), {Qt::ForegroundRole});
+    }
+}
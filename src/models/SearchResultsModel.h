@@ -0,0 +1,68 @@
+#ifndef SEARCHRESULTSMODEL_H
+#define SEARCHRESULTSMODEL_H
+
+#include <QAbstractTableModel>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// One package found by SearchView, from whichever source
+struct SearchResult {
+    QString name;
+    QString version;
+    QString description;        // empty for file matches; the model shows their files
+    QString source;             // "aur", "repo", "local" (installed, in no sync repository),
+                                // or the repository of a file match
+    bool installed = false;
+    double popularity = -1.0;   // AUR only
+    QStringList files;          // file searches: the matching paths
+};
+
+// SearchView's results table. Rows live in a plain vector and cells are
+// only produced in data() for the rows the view paints; the one string
+// that has to be built (a file search's list of paths) is built once when
+// the results are set. Sorting reorders a row -> result index instead of
+// the results, and column -1 goes back to the ranked order they came in.
+class SearchResultsModel : public QAbstractTableModel {
+    Q_OBJECT
+
+public:
+    enum Column {
+        NameColumn = 0,
+        VersionColumn,
+        StatusColumn,
+        DescriptionColumn,
+        ColumnCount
+    };
+
+    explicit SearchResultsModel(QObject* parent = nullptr);
+
+    // QAbstractTableModel interface
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+    // Best first; shown in the current sort order
+    void setResults(const QVector<SearchResult>& results);
+    void clear();
+
+    const SearchResult& result(int row) const { return m_results[m_order[row]]; }
+    void setInstalled(int row, bool installed);
+
+    // Status colours follow the theme
+    void setDarkTheme(bool dark);
+
+private:
+    void applySort();
+
+    QVector<SearchResult> m_results;
+    QVector<QString> m_descriptions;  // display text, per result
+    QVector<int> m_order;             // row -> result
+    int m_sortColumn = -1;
+    Qt::SortOrder m_sortOrder = Qt::AscendingOrder;
+    bool m_dark = true;
+};
+
+#endif // SEARCHRESULTSMODEL_H
@@ -1,6 +1,7 @@
 #include "AnalyticsView.h"
 #include "core/PackageManager.h"
 #include "core/Database.h"
+#include "core/PackageStore.h"
 #include "models/Package.h"
 #include "PrivilegedRunner.h"
 
@@ -37,6 +38,14 @@ AnalyticsView::AnalyticsView(PackageManager* pm, Database* db, QWidget* parent)
     , m_database(db)
 {
     setupUI();
+    
+    // Stats are stale once packages change; reload now if on screen,
+    // otherwise on the next refresh()
+    connect(m_packageManager, &PackageManager::localPackagesChanged,
+            this, [this]() {
+                m_lastRefresh.invalidate();
+                if (isVisible()) refresh();
+            });
 }
 
 void AnalyticsView::setupUI() {
@@ -193,12 +202,13 @@ void AnalyticsView::setupUI() {
     tablesLayout->setSpacing(15);
     
     // Top packages by size
-    QGroupBox* topGroup = new QGroupBox("🏆 Top 10 Largest Packages");
+    QGroupBox* topGroup = new QGroupBox("🏆 Top 10 Space Consumers");
     QVBoxLayout* topLayout = new QVBoxLayout(topGroup);
     
     m_topPackagesTable = new QTableWidget();
-    m_topPackagesTable->setColumnCount(2);
-    m_topPackagesTable->setHorizontalHeaderLabels({"Package", "Size"});
+    m_topPackagesTable->setColumnCount(3);
+    m_topPackagesTable->setHorizontalHeaderLabels({"Package", "Size", "Exclusive"});
+    m_topPackagesTable->horizontalHeaderItem(2)->setToolTip("Own size plus dependencies nothing else needs");
     m_topPackagesTable->horizontalHeader()->setStretchLastSection(true);
     m_topPackagesTable->setSelectionBehavior(QAbstractItemView::SelectRows);
     m_topPackagesTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
@@ -462,7 +472,6 @@ void AnalyticsView::refresh() {
     } else {
         // First load — show fast stats immediately, defer heavy work
         updateStats();
-        updateOrphansList();
         m_dataLoaded = true;
         QTimer::singleShot(0, this, &AnalyticsView::refreshInBackground);
     }
@@ -471,32 +480,42 @@ void AnalyticsView::refresh() {
 }
 
 void AnalyticsView::refreshInBackground() {
-    // Cache all packages once for this refresh cycle
-    cachePackageData();
-    
-    // Now run all the expensive operations using cached data
-    updateHealthStatus();
-    updateDiskUsageChart();
-    updateTimelineChart();
-    updateTopPackages();
-    updateOrphansList();
-    updateRecentlyUpdated();
-    updateAurVsRepo();
-    m_lastRefresh.start();
+    // Store and statistics are built on the package manager's thread; the
+    // charts are filled in once both are cached
+    m_packageManager->statisticsAsync().then(this, [this](std::shared_ptr<const PackageStatistics>) {
+        cachePackageData();
+        
+        // Now run all the expensive operations using cached data
+        updateHealthStatus();
+        updateDiskUsageChart();
+        updateTimelineChart();
+        updateTopPackages();
+        updateOrphansList();
+        updateRecentlyUpdated();
+        updateAurVsRepo();
+        m_lastRefresh.start();
+    });
 }
 
 void AnalyticsView::cachePackageData() {
-    m_cachedPackages = m_packageManager->getAllPackages();
+    m_store = m_packageManager->store();
+    m_stats = m_packageManager->statistics();
+    
+    // A reload can land between the two calls; package ids must match the store
+    if (m_stats->generation != m_store->generation()) {
+        m_stats = std::make_shared<const PackageStatistics>(PackageStatistics::compute(*m_store));
+    }
 }
 
 void AnalyticsView::updateStats() {
-    m_totalPackagesLabel->setText(QString::number(m_packageManager->totalPackageCount()));
-    m_explicitLabel->setText(QString::number(m_packageManager->explicitPackageCount()));
-    m_depsLabel->setText(QString::number(m_packageManager->dependencyPackageCount()));
-    m_orphansLabel->setText(QString::number(m_packageManager->orphanPackageCount()));
+    std::shared_ptr<const PackageStatistics> stats = m_packageManager->statistics();
+    m_totalPackagesLabel->setText(QString::number(stats->totalCount));
+    m_explicitLabel->setText(QString::number(stats->explicitCount));
+    m_depsLabel->setText(QString::number(stats->dependencyCount));
+    m_orphansLabel->setText(QString::number(stats->orphanCount));
     
     // Format total size
-    qint64 totalSize = m_packageManager->totalInstalledSize();
+    qint64 totalSize = stats->totalSize;
     QString sizeStr;
     if (totalSize < 1024 * 1024 * 1024) {
         sizeStr = QString::number(totalSize / (1024.0 * 1024.0), 'f', 1) + " MB";
@@ -509,20 +528,8 @@ void AnalyticsView::updateStats() {
 }
 
 void AnalyticsView::updateDiskUsageChart() {
-    // Use cached packages to avoid expensive getAllPackages() call
-    const QList<Package>& packages = m_cachedPackages;
-    
-    // Calculate size by reason
-    qint64 explicitSize = 0;
-    qint64 depsSize = 0;
-    
-    for (const Package& pkg : packages) {
-        if (pkg.isExplicit()) {
-            explicitSize += pkg.installedSize;
-        } else {
-            depsSize += pkg.installedSize;
-        }
-    }
+    qint64 explicitSize = m_stats->explicitSize;
+    qint64 depsSize = m_stats->dependencySize;
     
     QPieSeries* series = new QPieSeries();
     
@@ -549,18 +556,9 @@ void AnalyticsView::updateDiskUsageChart() {
 }
 
 void AnalyticsView::updateTimelineChart() {
-    QList<Package> packages = m_packageManager->getAllPackages();
-    
-    // Group by month
-    QMap<QString, int> monthCounts;
-    for (const Package& pkg : packages) {
-        QString month = pkg.installDate.toString("yyyy-MM");
-        monthCounts[month]++;
-    }
-    
-    // Sort by date and take last 12 months
-    QStringList months = monthCounts.keys();
-    std::sort(months.begin(), months.end());
+    // Months come sorted by date; take the last 12
+    const QMap<int, int>& monthCounts = m_stats->installsByMonth;
+    QList<int> months = monthCounts.keys();
     if (months.size() > 12) {
         months = months.mid(months.size() - 12);
     }
@@ -569,9 +567,9 @@ void AnalyticsView::updateTimelineChart() {
     set->setColor(QColor("#cba6f7"));
     
     QStringList categories;
-    for (const QString& month : months) {
-        *set << monthCounts[month];
-        categories << month.mid(5);  // Just show MM
+    for (int month : months) {
+        *set << monthCounts.value(month);
+        categories << PackageStatistics::monthLabel(month).mid(5);  // Just show MM
     }
     
     QBarSeries* series = new QBarSeries();
@@ -601,61 +599,35 @@ void AnalyticsView::updateTimelineChart() {
 }
 
 void AnalyticsView::updateTopPackages() {
-    // Use cached packages instead of getSizeByPackage()
-    QList<QPair<QString, qint64>> sorted;
-    for (const Package& pkg : m_cachedPackages) {
-        sorted.append(qMakePair(pkg.name, pkg.installedSize));
-    }
-    std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
-        return a.second > b.second;
-    });
-    
-    // Take top 10
-    m_topPackagesTable->setRowCount(qMin(10, sorted.size()));
-    for (int i = 0; i < qMin(10, sorted.size()); ++i) {
-        m_topPackagesTable->setItem(i, 0, new QTableWidgetItem(sorted[i].first));
-        
-        QString sizeStr;
-        qint64 size = sorted[i].second;
-        if (size < 1024 * 1024) {
-            sizeStr = QString::number(size / 1024.0, 'f', 1) + " KB";
-        } else if (size < 1024 * 1024 * 1024) {
-            sizeStr = QString::number(size / (1024.0 * 1024.0), 'f', 1) + " MB";
-        } else {
-            sizeStr = QString::number(size / (1024.0 * 1024.0 * 1024.0), 'f', 2) + " GB";
-        }
-        m_topPackagesTable->setItem(i, 1, new QTableWidgetItem(sizeStr));
+    // Ranked by exclusive size so toolchains whose bulk lives in
+    // dependencies show up; already ranked by the statistics pass
+    const QVector<PackageId>& largest = m_stats->largestExclusive;
+    m_topPackagesTable->setRowCount(largest.size());
+    for (int i = 0; i < largest.size(); ++i) {
+        m_topPackagesTable->setItem(i, 0, new QTableWidgetItem(m_store->name(largest[i])));
+        m_topPackagesTable->setItem(i, 1, new QTableWidgetItem(Package::formatSize(m_store->installedSize(largest[i]))));
+        m_topPackagesTable->setItem(i, 2, new QTableWidgetItem(Package::formatSize(m_store->exclusiveSize(largest[i]))));
     }
 }
 
 void AnalyticsView::updateOrphansList() {
-    QList<Package> orphans = m_packageManager->getOrphanPackages();
+    const PackageStore* pkgs = m_store.get();
     
-    // Sort by size
-    std::sort(orphans.begin(), orphans.end(), [](const Package& a, const Package& b) {
-        return a.installedSize > b.installedSize;
-    });
+    // Already sorted by size
+    const QVector<PackageId>& orphans = m_stats->orphans;
     
     m_orphansTable->setRowCount(orphans.size());
     for (int i = 0; i < orphans.size(); ++i) {
-        m_orphansTable->setItem(i, 0, new QTableWidgetItem(orphans[i].name));
-        m_orphansTable->setItem(i, 1, new QTableWidgetItem(orphans[i].formattedSize()));
-        m_orphansTable->setItem(i, 2, new QTableWidgetItem(orphans[i].installDate.toString("yyyy-MM-dd")));
+        PackageId id = orphans[i];
+        m_orphansTable->setItem(i, 0, new QTableWidgetItem(pkgs->name(id)));
+        m_orphansTable->setItem(i, 1, new QTableWidgetItem(Package::formatSize(pkgs->installedSize(id))));
+        m_orphansTable->setItem(i, 2, new QTableWidgetItem(pkgs->installDate(id).toString("yyyy-MM-dd")));
     }
 }
 void AnalyticsView::expandDiskUsageChart() {
-    QList<Package> packages = m_packageManager->getAllPackages();
-    
-    qint64 explicitSize = 0;
-    qint64 depsSize = 0;
-    
-    for (const Package& pkg : packages) {
-        if (pkg.isExplicit()) {
-            explicitSize += pkg.installedSize;
-        } else {
-            depsSize += pkg.installedSize;
-        }
-    }
+    std::shared_ptr<const PackageStatistics> stats = m_packageManager->statistics();
+    qint64 explicitSize = stats->explicitSize;
+    qint64 depsSize = stats->dependencySize;
     
     QPieSeries* series = new QPieSeries();
     
@@ -682,16 +654,10 @@ void AnalyticsView::expandDiskUsageChart() {
 }
 
 void AnalyticsView::expandTimelineChart() {
-    QList<Package> packages = m_packageManager->getAllPackages();
+    std::shared_ptr<const PackageStatistics> stats = m_packageManager->statistics();
     
-    QMap<QString, int> monthCounts;
-    for (const Package& pkg : packages) {
-        QString month = pkg.installDate.toString("yyyy-MM");
-        monthCounts[month]++;
-    }
-    
-    QStringList months = monthCounts.keys();
-    std::sort(months.begin(), months.end());
+    const QMap<int, int>& monthCounts = stats->installsByMonth;
+    QList<int> months = monthCounts.keys();
     if (months.size() > 24) {
         months = months.mid(months.size() - 24);
     }
@@ -700,9 +666,9 @@ void AnalyticsView::expandTimelineChart() {
     set->setColor(QColor("#cba6f7"));
     
     QStringList categories;
-    for (const QString& month : months) {
-        *set << monthCounts[month];
-        categories << month;
+    for (int month : months) {
+        *set << monthCounts.value(month);
+        categories << PackageStatistics::monthLabel(month);
     }
     
     QBarSeries* series = new QBarSeries();
@@ -835,7 +801,8 @@ void AnalyticsView::onCleanOrphans() {
         if (success) {
             QMessageBox::information(this, "Success", 
                 "Orphaned packages removed successfully!\n\nRefreshing dashboard...");
-            refresh();
+            // The dashboard reloads once the new store is in
+            m_packageManager->syncLocalChanges();
         }
     }
 }
@@ -10,9 +10,12 @@
 #include <QPushButton>
 #include <QDateTime>
 #include <QElapsedTimer>
+#include <memory>
 
 class PackageManager;
 class Database;
+class PackageStore;
+struct PackageStatistics;
 
 #include "models/Package.h"
 
@@ -86,7 +89,8 @@ private:
     // Caching state
     bool m_dataLoaded = false;
     QElapsedTimer m_lastRefresh;
-    QList<Package> m_cachedPackages;
+    std::shared_ptr<const PackageStore> m_store;
+    std::shared_ptr<const PackageStatistics> m_stats;
 };
 
 #endif // ANALYTICSVIEW_H
@@ -1,6 +1,7 @@
 #include "ControlPanel.h"
 #include "core/PackageManager.h"
 #include "core/Database.h"
+#include "core/PackageStore.h"
 #include "models/Package.h"
 #include "PrivilegedRunner.h"
 #include "utils/Config.h"
@@ -22,7 +23,14 @@ ControlPanel::ControlPanel(PackageManager* pm, Database* db, QWidget* parent)
     setupUI();
     // Apply initial theme
     applyTheme(Config::instance()->darkMode());
-    onRefreshOrphans();
+    
+    // Fill the orphan list once the package store has loaded in the background
+    m_packageManager->storeAsync().then(this, [this](std::shared_ptr<const PackageStore>) {
+        onRefreshOrphans();
+    });
+    
+    connect(m_packageManager, &PackageManager::localPackagesChanged,
+            this, &ControlPanel::onRefreshOrphans);
 }
 
 void ControlPanel::applyTheme(bool isDark) {
@@ -314,18 +322,22 @@ void ControlPanel::onCleanCache() {
 }
 
 void ControlPanel::onRemoveOrphans() {
-    QList<Package> orphans = m_packageManager->getOrphanPackages();
-    
-    if (orphans.isEmpty()) {
-        QMessageBox::information(this, "No Orphans", "No orphan packages found.");
-        return;
-    }
+    std::shared_ptr<const PackageStore> store = m_packageManager->store();
     
     QStringList names;
-    for (const Package& pkg : orphans) {
+    int orphanCount = 0;
+    for (PackageId id = 0; id < store->size(); ++id) {
+        if (!store->isOrphan(id)) continue;
+        ++orphanCount;
+        
         // Skip if marked as keep
-        if (m_database->isPackageMarkedKeep(pkg.name)) continue;
-        names << pkg.name;
+        if (m_database->isPackageMarkedKeep(store->name(id))) continue;
+        names << store->name(id);
+    }
+    
+    if (orphanCount == 0) {
+        QMessageBox::information(this, "No Orphans", "No orphan packages found.");
+        return;
     }
     
     if (names.isEmpty()) {
@@ -376,25 +388,30 @@ void ControlPanel::onRemoveSelected() {
 void ControlPanel::onRefreshOrphans() {
     m_orphansList->clear();
     
-    QList<Package> orphans = m_packageManager->getOrphanPackages();
+    std::shared_ptr<const PackageStore> store = m_packageManager->store();
     
+    int orphanCount = 0;
     qint64 totalSize = 0;
-    for (const Package& pkg : orphans) {
+    for (PackageId id = 0; id < store->size(); ++id) {
+        if (!store->isOrphan(id)) continue;
+        
+        const QString& name = store->name(id);
         QString itemText = QString("%1  (%2)")
-            .arg(pkg.name)
-            .arg(pkg.formattedSize());
+            .arg(name)
+            .arg(Package::formatSize(store->installedSize(id)));
         
         QListWidgetItem* item = new QListWidgetItem(itemText);
-        item->setData(Qt::UserRole, pkg.name);
+        item->setData(Qt::UserRole, name);
         
         // Mark keep packages differently
-        if (m_database->isPackageMarkedKeep(pkg.name)) {
+        if (m_database->isPackageMarkedKeep(name)) {
             item->setForeground(QColor("#a6e3a1"));
             item->setToolTip("📌 Marked as Keep");
         }
         
         m_orphansList->addItem(item);
-        totalSize += pkg.installedSize;
+        totalSize += store->installedSize(id);
+        ++orphanCount;
     }
     
     QString sizeStr;
@@ -406,7 +423,7 @@ void ControlPanel::onRefreshOrphans() {
         sizeStr = QString::number(totalSize / (1024.0 * 1024.0 * 1024.0), 'f', 2) + " GB";
     }
     
-    m_orphanSizeLabel->setText(QString("%1 orphans (%2 total)").arg(orphans.size()).arg(sizeStr));
+    m_orphanSizeLabel->setText(QString("%1 orphans (%2 total)").arg(orphanCount).arg(sizeStr));
 }
 
 void ControlPanel::runCommand(const QString& title, const QString& command) {
@@ -421,7 +438,7 @@ void ControlPanel::runCommand(const QString& title, const QString& command) {
     if (success) {
         m_outputText->append("\n✅ Command completed successfully!");
         m_statusLabel->setText("✅ " + title + " completed");
-        onRefreshOrphans(); // Refresh orphans list
+        m_packageManager->syncLocalChanges();  // refreshes the orphans list if packages changed
     } else {
         m_outputText->append("\n❌ Command failed or was cancelled.");
         m_statusLabel->setText("❌ " + title + " failed");
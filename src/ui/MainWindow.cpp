@@ -8,6 +8,7 @@
 #include "LoadingOverlay.h"
 #include "core/PackageManager.h"
 #include "core/Database.h"
+#include "core/StoreSnapshot.h"
 #include "core/AURClient.h"
 #include "core/ProfileManager.h"
 #include "utils/Config.h"
@@ -20,6 +21,7 @@
 #include <QStyle>
 #include <QFile>
 #include <QShortcut>
+#include <QFutureWatcher>
 
 MainWindow::MainWindow(QWidget* parent)
     : QMainWindow(parent)
@@ -42,6 +44,13 @@ MainWindow::MainWindow(QWidget* parent)
             "Failed to initialize database:\n" + m_database->lastError());
     }
     
+    // The last session's snapshot lets the first frame show packages before
+    // the local db is read; views created below pick it up from store()
+    qint64 userDataStamp = 0;
+    QVector<PackageUserData> cachedUserData;
+    bool fromSnapshot = m_packageManager->loadSnapshot(StoreSnapshot::defaultPath(),
+                                                       &userDataStamp, &cachedUserData);
+    
     setupUI();
     setupToolbar();
     setupStatusBar();
@@ -50,12 +59,30 @@ MainWindow::MainWindow(QWidget* parent)
     loadSettings();
     applyTheme();
     
-    // Load initial data
-    refreshPackages();
+    if (fromSnapshot) {
+        // Notes and tags may have been edited by another instance since
+        if (userDataStamp != StoreSnapshot::fileStamp(m_database->path())) {
+            cachedUserData.clear();
+        }
+        m_packageView->loadPackages(cachedUserData);
+        updateStatusBar();
+    
+        // Reloads and applies the difference if pacman ran in the meantime
+        m_packageManager->validateSnapshot();
+    } else {
+        // Load initial data off the GUI thread; later refreshes are incremental
+        loadInitialPackages();
+    }
 }
 
 MainWindow::~MainWindow() {
     saveSettings();
+    
+    // Read back on the next start; the stamp is taken after reading so a
+    // later write to the user database invalidates the cached user data
+    QList<PackageUserData> userData = m_database->getAllUserData();
+    m_packageManager->saveSnapshot(StoreSnapshot::defaultPath(),
+                                   StoreSnapshot::fileStamp(m_database->path()), userData);
 }
 
 void MainWindow::setupUI() {
@@ -154,7 +181,11 @@ void MainWindow::setupConnections() {
             this, &MainWindow::onPackageSelected);
     
     // NOTE: Do NOT connect packagesChanged to refreshPackages — it creates 
-    // an infinite loop: refreshPackages → loadPackages → setPackages → packagesChanged → ...
+    // an infinite loop: refreshPackages → loadPackages → setStore → packagesChanged → ...
+    
+    // Transactions from any view (or outside the app) arrive through the watcher
+    connect(m_packageManager.get(), &PackageManager::localPackagesChanged,
+            this, &MainWindow::updateStatusBar);
     
     connect(m_packageManager.get(), &PackageManager::operationProgress,
             this, [this](const QString& msg, int percent) {
@@ -244,15 +275,40 @@ void MainWindow::refreshPackages() {
     m_statusLabel->setText("Refreshing package database...");
     qApp->processEvents();
     
-    // Re-initialize libalpm to get fresh data
-    m_packageManager->refresh();
-    
-    m_packageView->loadPackages();
+    if (m_packageManager->isInitialized()) {
+        // Views receive only what changed since the last load
+        m_packageManager->syncLocalChanges();
+    } else {
+        // Retry a failed initialization with a full load
+        m_packageManager->refresh();
+        m_packageView->loadPackages();
+    }
     updateStatusBar();
     
     m_statusLabel->setText("Ready");
 }
 
+void MainWindow::loadInitialPackages() {
+    m_loadingOverlay->show("Loading packages...");
+    
+    auto* watcher = new QFutureWatcher<std::shared_ptr<const PackageStore>>(this);
+    connect(watcher, &QFutureWatcherBase::progressValueChanged, this, [this, watcher](int value) {
+        if (watcher->progressMaximum() > 0) {
+            m_loadingOverlay->setMessage(QString("Loading packages... %1 / %2")
+                .arg(value).arg(watcher->progressMaximum()));
+        }
+    });
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher]() {
+        watcher->deleteLater();
+        
+        // The store is cached now, so these don't block
+        m_packageView->loadPackages();
+        updateStatusBar();
+        m_loadingOverlay->hide();
+    });
+    watcher->setFuture(m_packageManager->storeAsync());
+}
+
 void MainWindow::toggleDarkMode() {
     bool isDark = m_actionDarkMode->isChecked();
     
@@ -52,6 +52,7 @@ private:
     void setupStatusBar();
     void setupConnections();
     void setupShortcuts();
+    void loadInitialPackages();
     void applyTheme();
     void applyThemeToViews(bool isDark);
     void loadSettings();
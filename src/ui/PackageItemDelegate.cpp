@@ -0,0 +1,93 @@
+#include "PackageItemDelegate.h"
+#include <QApplication>
+#include <QFontMetrics>
+#include <QPainter>
+
+namespace {
+// Laid-out cell texts kept; a screenful is a few hundred
+constexpr int MaxCachedTexts = 4096;
+constexpr int RowPadding = 4;
+}
+
+PackageItemDelegate::PackageItemDelegate(QObject* parent)
+    : QStyledItemDelegate(parent)
+    , m_texts(MaxCachedTexts)
+{
+}
+
+int PackageItemDelegate::rowHeight(const QFont& font) {
+    return QFontMetrics(font).height() + 2 * RowPadding;
+}
+
+QSize PackageItemDelegate::sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const {
+    QSize size = QStyledItemDelegate::sizeHint(option, index);
+    size.setHeight(rowHeight(option.font));
+    return size;
+}
+
+void PackageItemDelegate::paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const {
+    QStyleOptionViewItem opt = option;
+    initStyleOption(&opt, index);
+    
+    // Background, selection and focus from the style, without the text
+    const QString text = opt.text;
+    opt.text.clear();
+    const QWidget* widget = opt.widget;
+    QStyle* style = widget ? widget->style() : QApplication::style();
+    style->drawControl(QStyle::CE_ItemViewItem, &opt, painter, widget);
+    if (text.isEmpty()) return;
+    
+    const int margin = style->pixelMetric(QStyle::PM_FocusFrameHMargin, nullptr, widget) + 1;
+    const QRect textRect = style->subElementRect(QStyle::SE_ItemViewItemText, &opt, widget)
+                               .adjusted(margin, 0, -margin, 0);
+    if (textRect.width() <= 0) return;
+    
+    const QStaticText& staticText = this->staticText(text, opt.font, textRect.width(), opt.textElideMode);
+    
+    QPalette::ColorGroup group = QPalette::Normal;
+    if (!(opt.state & QStyle::State_Enabled)) {
+        group = QPalette::Disabled;
+    } else if (!(opt.state & QStyle::State_Active)) {
+        group = QPalette::Inactive;
+    }
+    const QPalette::ColorRole role = (opt.state & QStyle::State_Selected) ? QPalette::HighlightedText : QPalette::Text;
+    
+    const QSizeF size = staticText.size();
+    qreal x = textRect.left();
+    if (opt.displayAlignment & Qt::AlignRight) {
+        x = textRect.right() + 1 - size.width();
+    } else if (opt.displayAlignment & Qt::AlignHCenter) {
+        x = textRect.left() + (textRect.width() - size.width()) / 2;
+    }
+    const qreal y = textRect.top() + (textRect.height() - size.height()) / 2;
+    
+    painter->save();
+    painter->setClipRect(textRect);
+    painter->setFont(opt.font);
+    painter->setPen(opt.palette.color(group, role));
+    painter->drawStaticText(QPointF(x, y), staticText);
+    painter->restore();
+}
+
+const QStaticText& PackageItemDelegate::staticText(const QString& text, const QFont& font, int width,
+                                                   Qt::TextElideMode elide) const {
+    // Only the weight varies between cells; anything else is a new font
+    QFont base = font;
+    base.setBold(false);
+    if (base != m_font) {
+        m_texts.clear();
+        m_font = base;
+    }
+    
+    TextKey key{text, width, font.bold()};
+    if (QStaticText* cached = m_texts.object(key)) {
+        return *cached;
+    }
+    
+    auto* staticText = new QStaticText(QFontMetrics(font).elidedText(text, elide, width));
+    staticText->setTextFormat(Qt::PlainText);
+    staticText->setPerformanceHint(QStaticText::AggressiveCaching);
+    staticText->prepare(QTransform(), font);
+    m_texts.insert(key, staticText);
+    return *staticText;
+}
@@ -0,0 +1,47 @@
+#ifndef PACKAGEITEMDELEGATE_H
+#define PACKAGEITEMDELEGATE_H
+
+#include <QCache>
+#include <QFont>
+#include <QStaticText>
+#include <QStyledItemDelegate>
+
+// Paints the package table's cells from cached QStaticText.
+//
+// QStyledItemDelegate lays out and elides every cell's text on every
+// paint. Here the style only draws the background, selection and focus;
+// the text is laid out once per (text, width, weight) and then just
+// blitted, which is what keeps scrolling smooth over slow remote
+// displays. All rows are one line of the same height.
+class PackageItemDelegate : public QStyledItemDelegate {
+    Q_OBJECT
+    
+public:
+    explicit PackageItemDelegate(QObject* parent = nullptr);
+    
+    void paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+    QSize sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+    
+    // The one row height for text in font
+    static int rowHeight(const QFont& font);
+    
+private:
+    struct TextKey {
+        QString text;
+        int width;
+        bool bold;
+        bool operator==(const TextKey& other) const {
+            return width == other.width && bold == other.bold && text == other.text;
+        }
+    };
+    friend size_t qHash(const TextKey& key, size_t seed) {
+        return qHashMulti(seed, key.text, key.width, key.bold);
+    }
+    
+    const QStaticText& staticText(const QString& text, const QFont& font, int width, Qt::TextElideMode elide) const;
+    
+    mutable QCache<TextKey, QStaticText> m_texts;
+    mutable QFont m_font;  // the cache is for this font, bold or not
+};
+
+#endif // PACKAGEITEMDELEGATE_H
@@ -3,8 +3,10 @@
 #include "core/Database.h"
 #include "core/AURClient.h"
 #include "core/PacmanConfig.h"
+#include "core/RemovalSimulator.h"
 #include "models/PackageListModel.h"
 #include "PrivilegedRunner.h"
+#include "PackageItemDelegate.h"
 
 #include <QVBoxLayout>
 #include <QHBoxLayout>
@@ -43,6 +45,13 @@ PackageView::PackageView(PackageManager* pm, Database* db, AURClient* aur, QWidg
     m_proxyModel->setSourceModel(m_model);
     
     setupUI();
+    
+    connect(m_packageManager, &PackageManager::localPackagesChanged,
+            this, &PackageView::onLocalPackagesChanged);
+    // Notes, tags and marks written by other views (or an import)
+    connect(m_database, &Database::userDataChanged,
+            this, &PackageView::onUserDataChanged);
+    
     // Apply initial theme based on config or default
     applyTheme(true); 
 }
@@ -126,6 +135,7 @@ void PackageView::applyTheme(bool isDark) {
     if(m_packageSizeLabel) m_packageSizeLabel->setStyleSheet(subLabelStyle);
     if(m_packageDateLabel) m_packageDateLabel->setStyleSheet(subLabelStyle);
     if(m_packageReasonLabel) m_packageReasonLabel->setStyleSheet(subLabelStyle);
+    if(m_removalLabel) m_removalLabel->setStyleSheet(subLabelStyle);
     if(m_packageDescLabel) m_packageDescLabel->setStyleSheet(QString("font-size: 14px; color: %1; margin-top: 10px;").arg(textColor));
     
     // Headers
@@ -182,9 +192,19 @@ void PackageView::setupUI() {
     // Search bar
     QHBoxLayout* searchLayout = new QHBoxLayout();
     m_searchEdit = new QLineEdit();
-    m_searchEdit->setPlaceholderText("🔍 Search packages...");
+    m_searchEdit->setPlaceholderText("🔍 Search packages, or filter: size:>100M reason:dep tag:work ...");
+    m_searchHelp = "Words search names, descriptions, provides and groups.\n"
+                   "Filters: name:lib* desc: group: provides: size:>100M exclusive:<1G\n"
+                   "installed:<2024-01 reason:explicit|dep tag:work is:orphan|keep|review\n"
+                   "Combine with or, not / -, and parentheses.";
+    m_searchEdit->setToolTip(m_searchHelp);
     m_searchEdit->setClearButtonEnabled(true);
+    // Filter once typing pauses rather than on every keystroke
+    m_searchDebounce = new QTimer(this);
+    m_searchDebounce->setSingleShot(true);
+    m_searchDebounce->setInterval(150);
     connect(m_searchEdit, &QLineEdit::textChanged, this, &PackageView::onSearchTextChanged);
+    connect(m_searchDebounce, &QTimer::timeout, this, &PackageView::applySearchText);
     
     m_filterCombo = new QComboBox();
     m_filterCombo->addItem("All Packages", PackageFilterProxyModel::FilterAll);
@@ -224,22 +244,31 @@ void PackageView::setupUI() {
     m_tableView->setModel(m_proxyModel);
     m_tableView->setAlternatingRowColors(true);
     m_tableView->setSelectionBehavior(QAbstractItemView::SelectRows);
-    m_tableView->setSelectionMode(QAbstractItemView::SingleSelection);
+    m_tableView->setSelectionMode(QAbstractItemView::ExtendedSelection);
     m_tableView->setSortingEnabled(true);
     m_tableView->horizontalHeader()->setStretchLastSection(true);
     m_tableView->horizontalHeader()->setSectionResizeMode(QHeaderView::Interactive);
     m_tableView->verticalHeader()->setVisible(false);
     m_tableView->setShowGrid(false);
+    m_tableView->setWordWrap(false);
+    
+    // One line per row, painted from cached text layouts
+    m_tableView->setItemDelegate(new PackageItemDelegate(m_tableView));
+    m_tableView->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    m_tableView->verticalHeader()->setDefaultSectionSize(PackageItemDelegate::rowHeight(m_tableView->font()));
     
     // Set column widths
     m_tableView->setColumnWidth(PackageListModel::NameColumn, 200);
     m_tableView->setColumnWidth(PackageListModel::VersionColumn, 150);
     m_tableView->setColumnWidth(PackageListModel::SizeColumn, 100);
+    m_tableView->setColumnWidth(PackageListModel::ExclusiveSizeColumn, 100);
     m_tableView->setColumnWidth(PackageListModel::InstallDateColumn, 100);
     m_tableView->setColumnWidth(PackageListModel::ReasonColumn, 80);
     
     connect(m_tableView->selectionModel(), &QItemSelectionModel::currentChanged,
             this, &PackageView::onPackageClicked);
+    connect(m_tableView->selectionModel(), &QItemSelectionModel::selectionChanged,
+            this, &PackageView::updateRemovalPreview);
     
     leftLayout->addWidget(m_tableView);
     
@@ -405,6 +434,10 @@ void PackageView::setupUI() {
     actionsLayout2->addWidget(m_removeBtn);
     actionsOuterLayout->addLayout(actionsLayout2);
     
+    m_removalLabel = new QLabel();
+    m_removalLabel->setWordWrap(true);
+    actionsOuterLayout->addWidget(m_removalLabel);
+    
     rightLayout->addWidget(actionsGroup);
     
     rightLayout->addStretch();
@@ -421,24 +454,83 @@ void PackageView::setupUI() {
     mainLayout->addWidget(splitter);
 }
 
-void PackageView::loadPackages() {
-    QList<Package> packages = m_packageManager->getAllPackages();
+void PackageView::loadPackages(const QVector<PackageUserData>& cachedUserData) {
+    std::shared_ptr<const PackageStore> store = m_packageManager->store();
+    const bool cached = cachedUserData.size() == store->size();
     
     // Merge user data
-    for (Package& pkg : packages) {
-        PackageUserData userData = m_database->getPackageUserData(pkg.name);
-        pkg.userNotes = userData.notes;
-        pkg.userTags = userData.tags;
-        pkg.isMarkedKeep = userData.markedKeep;
-        pkg.isMarkedReview = userData.markedReview;
+    QVector<PackageListModel::UserData> userData(store->size());
+    for (PackageId id = 0; id < store->size(); ++id) {
+        PackageUserData data = cached ? cachedUserData[id] : m_database->getPackageUserData(store->name(id));
+        userData[id] = {data.notes, data.tags, data.markedKeep, data.markedReview};
     }
     
-    m_model->setPackages(packages);
+    m_model->setStore(store, userData);
     m_proxyModel->sort(PackageListModel::NameColumn, Qt::AscendingOrder);
 }
 
+void PackageView::onLocalPackagesChanged(const LocalDbChanges& changes) {
+    if (!m_model->store()) {
+        loadPackages();
+        return;
+    }
+    
+    std::shared_ptr<const PackageStore> store = m_packageManager->store();
+    
+    // Only newly installed packages need their user data fetched
+    QHash<QString, PackageListModel::UserData> userData;
+    for (const QString& name : changes.added) {
+        PackageUserData data = m_database->getPackageUserData(name);
+        userData.insert(name, {data.notes, data.tags, data.markedKeep, data.markedReview});
+    }
+    
+    if (!m_model->applyChanges(store, changes, userData)) {
+        loadPackages();
+    }
+    updateRemovalPreview();
+    
+    if (changes.changed.contains(m_currentPackage) || changes.added.contains(m_currentPackage)) {
+        PackageSummary pkg = m_model->summary(m_model->findPackageRow(m_currentPackage));
+        if (pkg.isValid()) {
+            showPackageDetails(pkg);
+        }
+    }
+}
+
+void PackageView::onUserDataChanged(const QStringList& packageNames) {
+    bool keepChanged = false;
+    for (const QString& name : packageNames) {
+        int row = m_model->findPackageRow(name);
+        if (row < 0) continue;
+        
+        PackageUserData data = m_database->getPackageUserData(name);
+        PackageListModel::UserData userData{data.notes, data.tags, data.markedKeep, data.markedReview};
+        if (m_model->userData(row) != userData) {
+            keepChanged |= m_model->isMarkedKeep(row) != userData.keep;
+            m_model->setUserData(row, userData);
+        }
+    }
+    
+    if (keepChanged) {
+        updateRemovalPreview();
+    }
+}
+
 void PackageView::onSearchTextChanged(const QString& text) {
-    m_proxyModel->setSearchText(text);
+    // Clearing the box should feel instant
+    if (text.isEmpty()) {
+        m_searchDebounce->stop();
+        applySearchText();
+    } else {
+        m_searchDebounce->start();
+    }
+}
+
+void PackageView::applySearchText() {
+    m_proxyModel->setSearchText(m_searchEdit->text());
+    
+    QString error = m_proxyModel->queryError();
+    m_searchEdit->setToolTip(error.isEmpty() ? m_searchHelp : "⚠️ " + error + " - searching for the text as typed");
 }
 
 void PackageView::onFilterChanged(int index) {
@@ -450,13 +542,13 @@ void PackageView::onFilterChanged(int index) {
 void PackageView::onPackageClicked(const QModelIndex& index) {
     if (!index.isValid()) return;
     
-    Package pkg = index.data(PackageListModel::PackageRole).value<Package>();
+    PackageSummary pkg = index.data(PackageListModel::PackageRole).value<PackageSummary>();
     showPackageDetails(pkg);
     
     emit packageSelected(pkg.name);
 }
 
-void PackageView::showPackageDetails(const Package& pkg) {
+void PackageView::showPackageDetails(const PackageSummary& pkg) {
     m_currentPackage = pkg.name;
     
     m_packageNameLabel->setText("📦 " + pkg.name);
@@ -464,14 +556,15 @@ void PackageView::showPackageDetails(const Package& pkg) {
     m_packageSizeLabel->setText("<b>Size:</b> " + pkg.formattedSize());
     m_packageDateLabel->setText("<b>Installed:</b> " + pkg.installDate.toString("yyyy-MM-dd hh:mm"));
     m_packageReasonLabel->setText(QString("<b>Reason:</b> ") + 
-        (pkg.isExplicit() ? QString::fromUtf8("✅ Explicitly installed") : QString::fromUtf8("📦 Installed as dependency")));
+        (pkg.isExplicit ? QString::fromUtf8("✅ Explicitly installed") : QString::fromUtf8("📦 Installed as dependency")));
     m_packageDescLabel->setText(pkg.description);
     
     // Dependencies
-    QString deps = pkg.depends.isEmpty() ? "None" : pkg.depends.join(", ");
+    PackageDetails details = m_model->details(m_model->findPackageRow(pkg.name));
+    QString deps = details.depends.isEmpty() ? "None" : details.depends.join(", ");
     m_dependsLabel->setText("<b>Depends on:</b> " + deps);
     
-    QString reqBy = pkg.requiredBy.isEmpty() ? "None" : pkg.requiredBy.join(", ");
+    QString reqBy = details.requiredBy.isEmpty() ? "None" : details.requiredBy.join(", ");
     m_requiredByLabel->setText("<b>Required by:</b> " + reqBy);
     
     // User data
@@ -495,10 +588,7 @@ void PackageView::onSaveNotes() {
     
     m_database->setPackageNotes(m_currentPackage, m_notesEdit->toPlainText());
     
-    // Update model
-    Package pkg = m_model->getPackageByName(m_currentPackage);
-    pkg.userNotes = m_notesEdit->toPlainText();
-    m_model->updatePackage(pkg);
+    m_model->setNotes(m_model->findPackageRow(m_currentPackage), m_notesEdit->toPlainText());
 }
 
 void PackageView::onAddTag() {
@@ -511,10 +601,7 @@ void PackageView::onAddTag() {
     m_tagInput->clear();
     updateTagsList();
     
-    // Update model
-    Package pkg = m_model->getPackageByName(m_currentPackage);
-    pkg.userTags = m_database->getPackageTags(m_currentPackage);
-    m_model->updatePackage(pkg);
+    m_model->setTags(m_model->findPackageRow(m_currentPackage), m_database->getPackageTags(m_currentPackage));
 }
 
 void PackageView::onRemoveTag() {
@@ -526,10 +613,7 @@ void PackageView::onRemoveTag() {
     m_database->removePackageTag(m_currentPackage, item->text());
     updateTagsList();
     
-    // Update model
-    Package pkg = m_model->getPackageByName(m_currentPackage);
-    pkg.userTags = m_database->getPackageTags(m_currentPackage);
-    m_model->updatePackage(pkg);
+    m_model->setTags(m_model->findPackageRow(m_currentPackage), m_database->getPackageTags(m_currentPackage));
 }
 
 void PackageView::updateTagsList() {
@@ -542,10 +626,8 @@ void PackageView::onToggleKeep() {
     
     m_database->setPackageKeep(m_currentPackage, m_keepBtn->isChecked());
     
-    // Update model
-    Package pkg = m_model->getPackageByName(m_currentPackage);
-    pkg.isMarkedKeep = m_keepBtn->isChecked();
-    m_model->updatePackage(pkg);
+    m_model->setKeep(m_model->findPackageRow(m_currentPackage), m_keepBtn->isChecked());
+    updateRemovalPreview();
 }
 
 void PackageView::onToggleReview() {
@@ -553,35 +635,94 @@ void PackageView::onToggleReview() {
     
     m_database->setPackageReview(m_currentPackage, m_reviewBtn->isChecked());
     
-    // Update model
-    Package pkg = m_model->getPackageByName(m_currentPackage);
-    pkg.isMarkedReview = m_reviewBtn->isChecked();
-    m_model->updatePackage(pkg);
+    m_model->setReview(m_model->findPackageRow(m_currentPackage), m_reviewBtn->isChecked());
 }
 
-void PackageView::onRemovePackage() {
-    if (m_currentPackage.isEmpty()) return;
+QVector<PackageId> PackageView::selectedPackageIds() const {
+    QVector<PackageId> ids;
+    for (const QModelIndex& index : m_tableView->selectionModel()->selectedRows()) {
+        PackageId id = m_model->packageId(m_proxyModel->mapToSource(index).row());
+        if (id >= 0) {
+            ids.append(id);
+        }
+    }
     
-    // Get required by using pacman -Qi
-    QProcess proc;
-    proc.start("pacman", {"-Qi", m_currentPackage});
-    proc.waitForFinished(3000);
-    QString output = QString::fromUtf8(proc.readAllStandardOutput());
+    if (ids.isEmpty() && m_model->store() && !m_currentPackage.isEmpty()) {
+        PackageId id = m_model->store()->find(m_currentPackage);
+        if (id >= 0) {
+            ids.append(id);
+        }
+    }
+    return ids;
+}
+
+void PackageView::updateRemovalPreview() {
+    if (!m_removalLabel) return;
+    
+    const PackageStore* store = m_model->store();
+    QVector<PackageId> targets = selectedPackageIds();
+    if (!store || targets.isEmpty()) {
+        m_removalLabel->clear();
+        return;
+    }
+    
+    // Cheap enough to redo on every selection change
+    RemovalSimulator simulator(*store, m_model->keepMarks());
+    RemovalSimulator::Plan plan = simulator.simulate(targets, RemovalSimulator::Recursive);
+    
+    QString text = QString("<b>Remove %1 selected:</b> %2 packages, %3 freed")
+        .arg(targets.size()).arg(plan.removed.size()).arg(Package::formatSize(plan.freedBytes));
+    if (!plan.blockers.isEmpty()) {
+        RemovalSimulator::Plan cascade = simulator.simulate(targets,
+            RemovalSimulator::Recursive | RemovalSimulator::Cascade);
+        text += QString("<br>⚠️ Required by %1 installed packages; with them: %2 packages, %3 freed")
+            .arg(plan.blockers.size()).arg(cascade.removed.size()).arg(Package::formatSize(cascade.freedBytes));
+    }
+    m_removalLabel->setText(text);
+}
+
+void PackageView::onRemovePackage() {
+    const PackageStore* store = m_model->store();
+    QVector<PackageId> targets = selectedPackageIds();
+    if (!store || targets.isEmpty()) return;
+    
+    // Simulated against the loaded store instead of asking pacman; Keep
+    // marks stop packages from being pulled in
+    RemovalSimulator simulator(*store, m_model->keepMarks());
+    RemovalSimulator::Plan plan = simulator.simulate(targets, RemovalSimulator::Recursive);
+    QString targetNames = store->toNameList(plan.targets).join(", ");
+    
+    if (!plan.blockers.isEmpty()) {
+        QString message = QString("⚠️ <b>Warning:</b> <b>%1</b> is required by:<br>%2<br><br>"
+                                  "Remove these packages as well?")
+            .arg(targetNames, store->toNameList(plan.blockers).join(", "));
+        if (QMessageBox::question(this, "Remove Package", message,
+                                  QMessageBox::Yes | QMessageBox::No) != QMessageBox::Yes) {
+            return;
+        }
     
-    QStringList requiredBy;
-    QRegularExpression reqRe(R"(Required By\s*:\s*(.+))");
-    QRegularExpressionMatch match = reqRe.match(output);
-    if (match.hasMatch()) {
-        QString deps = match.captured(1).trimmed();
-        if (deps != "None") {
-            requiredBy = deps.split(QRegularExpression(R"(\s+)"), Qt::SkipEmptyParts);
+        plan = simulator.simulate(targets, RemovalSimulator::Recursive | RemovalSimulator::Cascade);
+        if (!plan.blockers.isEmpty()) {
+            QMessageBox::warning(this, "Remove Package",
+                QString("Cannot remove <b>%1</b>: packages marked Keep depend on it:<br>%2")
+                    .arg(targetNames, store->toNameList(plan.blockers).join(", ")));
+            return;
         }
     }
     
-    QString message = QString("Remove <b>%1</b>?").arg(m_currentPackage);
-    if (!requiredBy.isEmpty()) {
-        message += QString("\n\n⚠️ <b>Warning:</b> This package is required by:\n%1")
-            .arg(requiredBy.join(", "));
+    QString message = QString("Remove <b>%1</b>?<br><br>%2 packages will be removed, freeing %3.")
+        .arg(targetNames).arg(plan.removed.size()).arg(Package::formatSize(plan.freedBytes));
+    if (plan.removed.size() > plan.targets.size()) {
+        QVector<PackageId> extra;
+        for (PackageId id : plan.removed) {
+            if (!plan.targets.contains(id)) {
+                extra.append(id);
+            }
+        }
+        message += QString("<br><br>Also removed:<br>%1").arg(store->toNameList(extra).join(", "));
+    }
+    if (!plan.kept.isEmpty()) {
+        message += QString("<br><br>Kept (marked Keep):<br>%1").arg(store->toNameList(plan.kept).join(", "));
     }
     
     QMessageBox::StandardButton reply = QMessageBox::question(this, "Remove Package",
@@ -589,16 +730,16 @@ void PackageView::onRemovePackage() {
     
     if (reply == QMessageBox::Yes) {
         bool success = PrivilegedRunner::runCommand(
-            QString("pacman -Rs %1").arg(m_currentPackage),
-            QString("Removing package: %1").arg(m_currentPackage),
+            simulator.command(plan),
+            QString("Removing package: %1").arg(targetNames),
             this);
         
         if (success) {
             QMessageBox::information(this, "Success", 
-                QString("Package %1 removed successfully!").arg(m_currentPackage));
-            // Refresh the package list
-            loadPackages();
+                QString("Package %1 removed successfully!").arg(targetNames));
             m_currentPackage.clear();
+            // Drop the removed rows now rather than waiting for the watcher
+            m_packageManager->syncLocalChanges();
         }
     }
 }
@@ -822,17 +963,9 @@ void PackageView::onChangeVersion() {
 void PackageView::refreshCurrentPackage() {
     if (m_currentPackage.isEmpty()) return;
     
-    // Refresh package manager data
-    m_packageManager->refresh();
-    
-    // Reload packages to get fresh data
-    loadPackages();
-    
-    // Re-show details for current package
-    Package pkg = m_model->getPackageByName(m_currentPackage);
-    if (!pkg.name.isEmpty()) {
-        showPackageDetails(pkg);
-    }
+    // Pick up the transaction now; the model gets only the changed rows,
+    // and onLocalPackagesChanged re-shows this package once they're in
+    m_packageManager->syncLocalChanges();
 }
 
 void PackageView::onTogglePin() {
@@ -879,13 +1012,13 @@ void PackageView::onTogglePin() {
 
 void PackageView::onExportClicked() {
     // Get all installed packages
-    QList<Package> packages = m_packageManager->getAllPackages();
+    std::shared_ptr<const PackageStore> store = m_packageManager->store();
     QStringList installedPkgs;
     
-    for (const Package& pkg : packages) {
+    for (PackageId id = 0; id < store->size(); ++id) {
         // Only include explicitly installed packages
-        if (pkg.isExplicit()) {
-            installedPkgs.append(pkg.name);
+        if (store->isExplicit(id)) {
+            installedPkgs.append(store->name(id));
         }
     }
     
@@ -11,6 +11,9 @@
 #include <QPushButton>
 #include <QGroupBox>
 #include <QListWidget>
+#include <QVector>
+#include <QTimer>
+#include "models/Package.h"
 
 class PackageManager;
 class Database;
@@ -18,6 +21,8 @@ class AURClient;
 class PackageListModel;
 class PackageFilterProxyModel;
 struct Package;
+struct LocalDbChanges;
+struct PackageUserData;
 
 class PackageView : public QWidget {
     Q_OBJECT
@@ -27,13 +32,17 @@ public:
     
     void applyTheme(bool isDark);
     
-    void loadPackages();
+    // cachedUserData is indexed by package id (e.g. from the startup
+    // snapshot); when it doesn't match the store, user data is read from
+    // the database
+    void loadPackages(const QVector<PackageUserData>& cachedUserData = {});
     
 signals:
     void packageSelected(const QString& packageName);
     
 private slots:
     void onSearchTextChanged(const QString& text);
+    void applySearchText();
     void onFilterChanged(int index);
     void onPackageClicked(const QModelIndex& index);
     void onSaveNotes();
@@ -42,15 +51,19 @@ private slots:
     void onToggleKeep();
     void onToggleReview();
     void onRemovePackage();
+    void updateRemovalPreview();
     void onChangeVersion();
     void onTogglePin();
     void onExportClicked();
+    void onLocalPackagesChanged(const LocalDbChanges& changes);
+    void onUserDataChanged(const QStringList& packageNames);
     
 private:
     void setupUI();
-    void showPackageDetails(const Package& pkg);
+    void showPackageDetails(const PackageSummary& pkg);
     void updateTagsList();
     void refreshCurrentPackage();
+    QVector<PackageId> selectedPackageIds() const;
     
     PackageManager* m_packageManager;
     Database* m_database;
@@ -62,6 +75,8 @@ private:
     
     // Left panel
     QLineEdit* m_searchEdit;
+    QString m_searchHelp;
+    QTimer* m_searchDebounce;
     QComboBox* m_filterCombo;
     QTableView* m_tableView;
     
@@ -89,6 +104,7 @@ private:
     
     // Package actions
     QPushButton* m_removeBtn;
+    QLabel* m_removalLabel = nullptr;  // what removing the selection would take with it
     QPushButton* m_versionBtn;
     QPushButton* m_pinBtn;
     QPushButton* m_exportBtn;
@@ -531,8 +531,8 @@ void ProfileView::onCreateCustomClicked() {
     )");
     
     // Get explicit packages
-    QList<Package> allPkgs = m_packageManager->getExplicitPackages();
-    for (const Package& pkg : allPkgs) {
+    QList<PackageSummary> allPkgs = m_packageManager->getExplicitPackages();
+    for (const PackageSummary& pkg : allPkgs) {
         QListWidgetItem* item = new QListWidgetItem(pkg.name);
         item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
         item->setCheckState(Qt::Unchecked);
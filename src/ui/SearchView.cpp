@@ -2,13 +2,34 @@
 #include "core/AURClient.h"
 #include "core/PackageManager.h"
 #include "PrivilegedRunner.h"
+#include "core/SearchRanker.h"
+#include "core/SyncCatalogue.h"
+#include "core/FilesDatabase.h"
+#include "utils/SubstringSearch.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QGroupBox>
 #include <QHeaderView>
 #include <QMessageBox>
-#include <QProcess>
+#include <QHash>
+#include <QSet>
 #include <QSplitter>
+#include <QTimer>
+
+namespace {
+
+// The table only renders visible rows, so this is far above what a broad
+// query over every repo package returns
+constexpr int MaxResults = 50000;
+constexpr int MaxFileMatches = 5000;  // a glob like *.h matches far more
+
+QString sourceLabel(const QString& source) {
+    if (source == "aur") return "Arch User Repository (AUR)";
+    if (source == "local") return "Local (AUR or own build, in no sync repository)";
+    return "Official Repository";
+}
+
+} // namespace
 
 SearchView::SearchView(PackageManager* pm, AURClient* aur, QWidget* parent)
     : QWidget(parent)
@@ -16,6 +37,8 @@ SearchView::SearchView(PackageManager* pm, AURClient* aur, QWidget* parent)
     , m_aurClient(aur)
 {
     setupUI();
+    connect(m_aurClient, &AURClient::searchCompleted, this, &SearchView::onAurResults);
+    connect(m_aurClient, &AURClient::error, this, &SearchView::onAurError);
     // Apply initial theme based on Config or default
     // We'll let MainWindow call applyTheme, but we should have a default
 }
@@ -120,7 +143,7 @@ void SearchView::applyTheme(bool isDark) {
     // Table View
     if (m_resultsTable) {
         m_resultsTable->setStyleSheet(QString(R"(
-            QTableWidget {
+            QTableView {
                 background-color: %1;
                 alternate-background-color: %2;
                 color: %3;
@@ -148,19 +171,7 @@ void SearchView::applyTheme(bool isDark) {
             textColor, borderColor,
             isDark ? "#45475a" : "#bcc0cc")); // Selection Bg
             
-        // We also need to update row colors dynamically, but they are set in performSearch.
-        // We can't easily retroactively update items without iterating them.
-        // So we just rely on TableWidget style for main text, and custom items will be rebuilt on search.
-        // HOWEVER, we SHOULD update existing items if possible.
-        for(int i=0; i<m_resultsTable->rowCount(); i++) {
-            // Update status item color
-             QTableWidgetItem* statusItem = m_resultsTable->item(i, 2);
-             if (statusItem) {
-                 bool installed = statusItem->text().contains("Installed");
-                 if (installed) statusItem->setForeground(QColor(isDark ? "#a6e3a1" : "#40a02b"));
-                 else statusItem->setForeground(QColor(isDark ? "#89b4fa" : "#1e66f5"));
-             }
-        }
+        m_resultsModel->setDarkTheme(isDark);
     }
 }
 
@@ -187,12 +198,20 @@ void SearchView::setupUI() {
     m_searchEdit->setMinimumHeight(40);
     // Style applied by applyTheme
     connect(m_searchEdit, &QLineEdit::returnPressed, this, &SearchView::performSearch);
+    
+    // As-you-type search waits for a pause in typing
+    m_debounce = new QTimer(this);
+    m_debounce->setSingleShot(true);
+    m_debounce->setInterval(250);
+    connect(m_debounce, &QTimer::timeout, this, &SearchView::performSearch);
+    connect(m_searchEdit, &QLineEdit::textChanged, this, &SearchView::onSearchTextEdited);
     searchLayout->addWidget(m_searchEdit);
     
     m_sourceCombo = new QComboBox();
     m_sourceCombo->addItem("🌐 AUR", "aur");
     m_sourceCombo->addItem("📦 Official Repos", "repo");
     m_sourceCombo->addItem("📂 Find by File", "file");
+    m_sourceCombo->addItem("📂 Find by File (regex)", "file-regex");
     m_sourceCombo->setMinimumHeight(40);
     m_sourceCombo->setMinimumWidth(180);
     m_sourceCombo->setMinimumHeight(40);
@@ -223,18 +242,25 @@ void SearchView::setupUI() {
     // Style applied by applyTheme
     resultsLayout->addWidget(m_statusLabel);
     
-    m_resultsTable = new QTableWidget();
-    m_resultsTable->setColumnCount(4);
-    m_resultsTable->setHorizontalHeaderLabels({"Name", "Version", "Status", "Description"});
+    // A model over the results: only visible rows are ever turned into cells
+    m_resultsModel = new SearchResultsModel(this);
+    m_resultsTable = new QTableView();
+    m_resultsTable->setModel(m_resultsModel);
     m_resultsTable->setSelectionBehavior(QAbstractItemView::SelectRows);
     m_resultsTable->setSelectionMode(QAbstractItemView::SingleSelection);
+    m_resultsTable->setWordWrap(false);
     m_resultsTable->horizontalHeader()->setStretchLastSection(true);
     m_resultsTable->horizontalHeader()->setSectionResizeMode(0, QHeaderView::ResizeToContents);
     m_resultsTable->horizontalHeader()->setSectionResizeMode(1, QHeaderView::ResizeToContents);
     m_resultsTable->horizontalHeader()->setSectionResizeMode(2, QHeaderView::ResizeToContents);
+    m_resultsTable->horizontalHeader()->setResizeContentsPrecision(200);  // don't measure every row
     m_resultsTable->verticalHeader()->setVisible(false);
+    m_resultsTable->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
     m_resultsTable->setAlternatingRowColors(true);
-    connect(m_resultsTable, &QTableWidget::cellClicked, this, &SearchView::onResultClicked);
+    // Ranked order until a header is clicked
+    m_resultsTable->horizontalHeader()->setSortIndicator(-1, Qt::AscendingOrder);
+    m_resultsTable->setSortingEnabled(true);
+    connect(m_resultsTable, &QTableView::clicked, this, &SearchView::onResultClicked);
     resultsLayout->addWidget(m_resultsTable);
     
     splitter->addWidget(resultsGroup);
@@ -264,222 +290,221 @@ void SearchView::setupUI() {
     mainLayout->addWidget(splitter);
 }
 
+void SearchView::onSearchTextEdited() {
+    const QString query = m_searchEdit->text().trimmed();
+    const QString source = m_sourceCombo->currentData().toString();
+    
+    if (query.isEmpty()) {
+        cancelSearch();
+        m_searchResults.clear();
+        m_resultsModel->clear();
+        m_statusLabel->clear();
+        return;
+    }
+    if (source == "aur" && query.length() < 2) return;  // the RPC refuses shorter queries
+    
+    m_debounce->start();
+}
+
 void SearchView::performSearch() {
+    m_debounce->stop();
+    cancelSearch();
+    
     QString query = m_searchEdit->text().trimmed();
     if (query.isEmpty()) {
         m_statusLabel->setText("Please enter a search term");
         return;
     }
     
-    m_searchResults.clear();
-    m_resultsTable->setRowCount(0);
-    m_statusLabel->setText("Searching...");
     m_infoText->clear();
     m_installBtn->setEnabled(false);
     
     QString source = m_sourceCombo->currentData().toString();
+    if (refineResults(query, source)) return;
+    
+    m_searchResults.clear();
+    m_resultsModel->clear();
+    m_statusLabel->setText("Searching...");
+    m_activeQuery = query;
+    m_activeSource = source;
     
     if (source == "aur") {
         searchAUR(query);
-    } else if (source == "file") {
-        searchByFile(query);
+    } else if (source == "file" || source == "file-regex") {
+        searchByFile(query, source == "file-regex");
     } else {
         searchRepo(query);
     }
 }
 
-void SearchView::searchAUR(const QString& query) {
-    // Disable controls during search
-    m_searchBtn->setEnabled(false);
-    m_searchEdit->setEnabled(false);
-    m_statusLabel->setText("Searching AUR... ⏳");
-    setCursor(Qt::WaitCursor);
+void SearchView::cancelSearch() {
+    m_aurClient->cancelSearch();
+    m_activeQuery.clear();
+    setCursor(Qt::ArrowCursor);
+}
+
+bool SearchView::refineResults(const QString& query, const QString& source) {
+    // Only a finished search can be narrowed, and only by typing more. Repo
+    // searches are local and already capped, so they simply run again.
+    if (source != "aur" || source != m_candidatesSource || m_candidatesQuery.isEmpty()
+        || !query.startsWith(m_candidatesQuery, Qt::CaseInsensitive)) {
+        return false;
+    }
     
-    // Use AURClient to search
-    connect(m_aurClient, &AURClient::searchCompleted, this, [this, query](const QList<AURPackage>& packages) {
-        m_statusLabel->setText(QString("Found %1 packages in AUR").arg(packages.size()));
-        m_resultsTable->setRowCount(0);
-        m_searchResults.clear();
-        
-        // Convert to internal format
-        for (const AURPackage& pkg : packages) {
-            PackageResult result;
-            result.name = pkg.name;
-            result.version = pkg.version;
-            result.description = pkg.description;
-            result.source = "aur";
-            result.installed = m_packageManager->packageExists(pkg.name);
-            m_searchResults.append(result);
+    QList<QByteArray> words = SubstringSearch::fold(query).split(' ');
+    words.removeAll(QByteArray());
+    
+    m_searchResults.clear();
+    for (const SearchResult& candidate : m_candidates) {
+        const QByteArray text = SubstringSearch::fold(candidate.name) + '\n' + SubstringSearch::fold(candidate.description);
+        bool matches = true;
+        for (const QByteArray& word : words) {
+            if (!SubstringSearch::contains(text, word)) {
+                matches = false;
+                break;
+            }
         }
-        
-        // Sort: exact matches first, then startsWith, then alphabetical
-        QString searchTerm = query.toLower();
-        std::sort(m_searchResults.begin(), m_searchResults.end(),
-            [&searchTerm](const PackageResult& a, const PackageResult& b) {
-                bool aExact = (a.name.toLower() == searchTerm);
-                bool bExact = (b.name.toLower() == searchTerm);
-                if (aExact != bExact) return aExact;
-                
-                bool aStarts = a.name.toLower().startsWith(searchTerm);
-                bool bStarts = b.name.toLower().startsWith(searchTerm);
-                if (aStarts != bStarts) return aStarts;
-                
-                return a.name < b.name;
-            });
-        
-        // Display sorted results
-        m_resultsTable->setRowCount(qMin(m_searchResults.size(), 100));
-        for (int i = 0; i < m_resultsTable->rowCount(); ++i) {
-            const PackageResult& result = m_searchResults[i];
-            
-            m_resultsTable->setItem(i, 0, new QTableWidgetItem(result.name));
-            m_resultsTable->setItem(i, 1, new QTableWidgetItem(result.version));
-            
-            QString status = result.installed ? "✅ Installed" : "⬇️ Available";
-            QTableWidgetItem* statusItem = new QTableWidgetItem(status);
-            statusItem->setForeground(result.installed ? QColor("#a6e3a1") : QColor("#89b4fa"));
-            m_resultsTable->setItem(i, 2, statusItem);
-            
-            m_resultsTable->setItem(i, 3, new QTableWidgetItem(result.description));
+        if (matches) {
+            m_searchResults.append(candidate);
         }
-        
-        // Re-enable controls
-        m_searchBtn->setEnabled(true);
-        m_searchEdit->setEnabled(true);
-        setCursor(Qt::ArrowCursor);
-    }, Qt::SingleShotConnection);
+    }
+    m_candidates = m_searchResults;
+    m_candidatesQuery = query;
     
-    // Error handling
-    connect(m_aurClient, &AURClient::error, this, [this](const QString& errorMsg) {
-        m_statusLabel->setText("Error: " + errorMsg);
-        m_searchBtn->setEnabled(true);
-        m_searchEdit->setEnabled(true);
-        setCursor(Qt::ArrowCursor);
-    }, Qt::SingleShotConnection);
+    rankResults(query, MaxResults);
+    showResults();
+    m_statusLabel->setText(QString("Found %1 packages").arg(m_searchResults.size()));
+    return true;
+}
+
+void SearchView::finishSearch() {
+    m_candidates = m_searchResults;
+    m_candidatesQuery = m_activeQuery;
+    m_candidatesSource = m_activeSource;
+    
+    showResults();
+    m_activeQuery.clear();
+    setCursor(Qt::ArrowCursor);
+}
+
+void SearchView::showResults() {
+    m_resultsModel->setResults(m_searchResults);
+}
+
+void SearchView::rankResults(const QString& query, int limit) {
+    // Every result came from the backend, so they all stay whatever their score
+    QVector<SearchRanker::Document> documents;
+    documents.reserve(m_searchResults.size());
+    for (const SearchResult& result : m_searchResults) {
+        documents.append({result.name, result.description, result.popularity, true});
+    }
     
+    QList<SearchResult> ranked;
+    for (const SearchRanker::Hit& hit : SearchRanker(documents).search(query, limit)) {
+        ranked.append(m_searchResults[hit.index]);
+    }
+    m_searchResults = ranked;
+}
+
+void SearchView::searchAUR(const QString& query) {
+    m_statusLabel->setText("Searching AUR... ⏳");
+    setCursor(Qt::BusyCursor);
+    
+    // A newer search aborts this request, and an aborted one reports nothing
     m_aurClient->search(query);
 }
 
+void SearchView::onAurResults(const QList<AURPackage>& packages) {
+    if (m_activeSource != "aur" || m_activeQuery.isEmpty()) return;
+    
+    // Convert to internal format
+    m_searchResults.clear();
+    for (const AURPackage& pkg : packages) {
+        SearchResult result;
+        result.name = pkg.name;
+        result.version = pkg.version;
+        result.description = pkg.description;
+        result.source = "aur";
+        result.installed = m_packageManager->packageExists(pkg.name);
+        result.popularity = pkg.popularity;
+        m_searchResults.append(result);
+    }
+    
+    // Best matches first: name, typos, description words, popularity
+    rankResults(m_activeQuery, MaxResults);
+    finishSearch();
+    m_statusLabel->setText(QString("Found %1 packages in AUR").arg(m_searchResults.size()));
+}
+
+void SearchView::onAurError(const QString& errorMsg) {
+    if (m_activeSource != "aur" || m_activeQuery.isEmpty()) return;
+    
+    m_statusLabel->setText("Error: " + errorMsg);
+    m_activeQuery.clear();
+    setCursor(Qt::ArrowCursor);
+}
+
 void SearchView::searchRepo(const QString& query) {
-    // Disable controls during search
-    m_searchBtn->setEnabled(false);
-    m_searchEdit->setEnabled(false);
     m_statusLabel->setText("Searching Repos... ⏳");
-    setCursor(Qt::WaitCursor);
+    setCursor(Qt::BusyCursor);
     
-    QProcess* proc = new QProcess(this);
-    connect(proc, &QProcess::finished, this, [this, proc](int exitCode) {
-        m_searchBtn->setEnabled(true);
-        m_searchEdit->setEnabled(true);
-        setCursor(Qt::ArrowCursor);
+    // The sync dbs are read in-process once and kept until pacman -Sy
+    // changes them; the ranker behind them covers every repo package
+    m_packageManager->syncCatalogueAsync().then(this, [this, query](std::shared_ptr<const SyncCatalogue> catalogue) {
+        if (m_activeSource != "repo" || m_activeQuery != query) return;  // canceled or superseded
         
-        if (exitCode != 0) {
-            m_statusLabel->setText("Error: Failed to search repositories. Check if another pacman instance is running.");
-            proc->deleteLater();
+        if (!catalogue) {
+            m_statusLabel->setText("Error: Cannot read the sync databases. Synchronize them with a system update first.");
+            m_activeQuery.clear();
+            setCursor(Qt::ArrowCursor);
             return;
         }
         
-        QString output = QString::fromUtf8(proc->readAllStandardOutput());
-        proc->deleteLater();
+        // Installed packages no repository has (AUR, local builds) compete
+        // too, scored against the catalogue rather than re-ranking it
+        std::shared_ptr<const PackageStore> installed = m_packageManager->store();
+        QVector<SearchRanker::Document> local;
+        QVector<PackageId> localIds;
+        for (PackageId id = 0; installed && id < installed->size(); ++id) {
+            if (catalogue->find(installed->name(id)).isValid()) continue;
+            local.append({installed->name(id), installed->description(id)});
+            localIds.append(id);
+        }
         
         m_searchResults.clear();
-        QStringList lines = output.split('\n');
-        
-        QString currentName, currentVersion, currentDesc;
-        bool inPackage = false;
-        
-        for (const QString& line : lines) {
-            if (line.isEmpty()) continue;
-            
-            // Description lines start with spaces
-            if (line.startsWith("    ") || line.startsWith("\t")) {
-                if (inPackage) {
-                    if (!currentDesc.isEmpty()) currentDesc += " ";
-                    currentDesc += line.trimmed();
-                }
+        for (const SyncCatalogue::Entry& entry : catalogue->search(query, MaxResults, local)) {
+            SearchResult result;
+            if (entry.isValid()) {
+                const PackageStore& pkgs = *catalogue->repository(entry).packages;
+                result.name = pkgs.name(entry.id);
+                result.version = pkgs.version(entry.id);
+                result.description = pkgs.description(entry.id);
+                result.source = "repo";
+                result.installed = installed && installed->contains(result.name);
             } else {
-                // Save previous package if exists
-                if (inPackage && !currentName.isEmpty()) {
-                    PackageResult result;
-                    result.name = currentName;
-                    result.version = currentVersion;
-                    result.description = currentDesc;
-                    result.source = "repo";
-                    result.installed = m_packageManager->packageExists(result.name);
-                    m_searchResults.append(result);
-                }
-                
-                // Parse new package line: repo/pkgname version [installed]
-                QRegularExpression re(R"(^(\w+)/(\S+)\s+(\S+))");
-                QRegularExpressionMatch match = re.match(line);
-                
-                if (match.hasMatch()) {
-                    currentName = match.captured(2);
-                    currentVersion = match.captured(3);
-                    currentDesc.clear();
-                    inPackage = true;
-                } else {
-                    inPackage = false;
-                }
+                const PackageId id = localIds[entry.id];
+                result.name = installed->name(id);
+                result.version = installed->version(id);
+                result.description = installed->description(id);
+                result.source = "local";
+                result.installed = true;
             }
-        }
-        
-        // Don't forget last package
-        if (inPackage && !currentName.isEmpty()) {
-            PackageResult result;
-            result.name = currentName;
-            result.version = currentVersion;
-            result.description = currentDesc;
-            result.source = "repo";
-            result.installed = m_packageManager->packageExists(result.name);
             m_searchResults.append(result);
         }
         
-        // Sort: exact matches first, then by name
-        QString searchTerm = m_searchEdit->text().trimmed().toLower();
-        std::sort(m_searchResults.begin(), m_searchResults.end(), 
-            [&searchTerm](const PackageResult& a, const PackageResult& b) {
-                bool aExact = (a.name.toLower() == searchTerm);
-                bool bExact = (b.name.toLower() == searchTerm);
-                if (aExact != bExact) return aExact;
-                
-                bool aStarts = a.name.toLower().startsWith(searchTerm);
-                bool bStarts = b.name.toLower().startsWith(searchTerm);
-                if (aStarts != bStarts) return aStarts;
-                
-                return a.name < b.name;
-            });
-        
-        m_resultsTable->setRowCount(m_searchResults.size());
-        for (int i = 0; i < m_searchResults.size(); ++i) {
-            const PackageResult& result = m_searchResults[i];
-            
-            m_resultsTable->setItem(i, 0, new QTableWidgetItem(result.name));
-            m_resultsTable->setItem(i, 1, new QTableWidgetItem(result.version));
-            
-            QString status = result.installed ? "✅ Installed" : "⬇️ Available";
-            QTableWidgetItem* statusItem = new QTableWidgetItem(status);
-            statusItem->setForeground(result.installed ? QColor("#a6e3a1") : QColor("#89b4fa"));
-            m_resultsTable->setItem(i, 2, statusItem);
-            
-            m_resultsTable->setItem(i, 3, new QTableWidgetItem(result.description));
-        }
-        
+        finishSearch();
         m_statusLabel->setText(QString("Found %1 packages in official repos").arg(m_searchResults.size()));
     });
-    
-    proc->start("pacman", {"-Ss", query});
 }
 
-void SearchView::onResultClicked(int row, int column) {
-    Q_UNUSED(column)
-    showPackageInfo(row);
+void SearchView::onResultClicked(const QModelIndex& index) {
+    showPackageInfo(index.row());
 }
 
 void SearchView::showPackageInfo(int row) {
-    if (row < 0 || row >= m_searchResults.size()) return;
+    if (row < 0 || row >= m_resultsModel->rowCount()) return;
     
-    const PackageResult& pkg = m_searchResults[row];
+    const SearchResult& pkg = m_resultsModel->result(row);
     
     QString info = QString(
         "<h2>%1</h2>"
@@ -490,9 +515,9 @@ void SearchView::showPackageInfo(int row) {
         "<p>%5</p>"
     ).arg(pkg.name)
      .arg(pkg.version)
-     .arg(pkg.source == "aur" ? "Arch User Repository (AUR)" : "Official Repository")
+     .arg(sourceLabel(pkg.source))
      .arg(pkg.installed ? "Installed" : "Not installed")
-     .arg(pkg.description);
+     .arg(pkg.files.isEmpty() ? pkg.description : "<b>Matching files:</b><br>" + pkg.files.join(QChar('\n')).toHtmlEscaped().replace(QChar('\n'), "<br>"));
     
     m_infoText->setHtml(info);
     
@@ -501,16 +526,20 @@ void SearchView::showPackageInfo(int row) {
         m_installBtn->setText("🗑️ Remove Package");
     } else if (pkg.source == "aur") {
         m_installBtn->setText("📥 Install from AUR (requires yay/paru)");
+    } else if (pkg.source == "local") {
+        // Removed just now; no repository has it to reinstall from
+        m_installBtn->setText("📥 Not in any repository");
+        m_installBtn->setEnabled(false);
     } else {
         m_installBtn->setText("📥 Install Package (requires sudo)");
     }
 }
 
 void SearchView::onInstallClicked() {
-    int row = m_resultsTable->currentRow();
-    if (row < 0 || row >= m_searchResults.size()) return;
+    int row = m_resultsTable->currentIndex().row();
+    if (row < 0 || row >= m_resultsModel->rowCount()) return;
     
-    const PackageResult& pkg = m_searchResults[row];
+    const SearchResult& pkg = m_resultsModel->result(row);
     
     if (pkg.installed) {
         // Remove package
@@ -530,7 +559,7 @@ void SearchView::onInstallClicked() {
                 QMessageBox::information(this, "Success", 
                     QString("Package %1 removed successfully!").arg(pkg.name));
                 // Update the UI
-                m_searchResults[row].installed = false;
+                m_resultsModel->setInstalled(row, false);
                 showPackageInfo(row);
             }
         }
@@ -554,124 +583,65 @@ void SearchView::onInstallClicked() {
             QMessageBox::information(this, "Success", 
                 QString("Package %1 installed successfully!").arg(pkg.name));
             // Update the UI
-            m_searchResults[row].installed = true;
+            m_resultsModel->setInstalled(row, true);
             showPackageInfo(row);
         }
     }
 }
 
-void SearchView::searchByFile(const QString& filename) {
-    // Search for packages that provide a specific file using pacman -F
-    m_searchBtn->setEnabled(false);
-    m_searchEdit->setEnabled(false);
+void SearchView::searchByFile(const QString& pattern, bool regex) {
     m_statusLabel->setText("Searching files... ⏳");
-    setCursor(Qt::WaitCursor);
+    setCursor(Qt::BusyCursor);
     
-    QProcess* proc = new QProcess(this);
-    connect(proc, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-            this, [this, proc, filename](int exitCode, QProcess::ExitStatus status) {
-        proc->deleteLater();
-        
-        QString output = QString::fromUtf8(proc->readAllStandardOutput());
-        QString error = QString::fromUtf8(proc->readAllStandardError());
+    // The first search after pacman -Fy builds the index; later ones only map it
+    const QString source = m_activeSource;
+    m_packageManager->filesDatabaseAsync().then(this, [this, pattern, regex, source](std::shared_ptr<const FilesDatabase> files) {
+        if (m_activeSource != source || m_activeQuery != pattern) return;  // canceled or superseded
+        m_activeQuery.clear();
+        setCursor(Qt::ArrowCursor);
         
-        // Check if file database needs sync
-        if (error.contains("database") || output.isEmpty()) {
-            m_statusLabel->setText("⚠️ File database may need sync. Click Sync button.");
-            m_searchBtn->setEnabled(true);
-            m_searchEdit->setEnabled(true);
-            setCursor(Qt::ArrowCursor);
-            
-            // Show hint about syncing
+        if (!files) {
+            m_statusLabel->setText("⚠️ The file database has not been synced yet.");
             QMessageBox::information(this, "Sync Required",
-                "The file database may need to be updated.\n\n"
-                "Run 'sudo pacman -Fy' to sync the file database.\n"
-                "You can also use the Search tab again after syncing.");
+                "There is no file database to search yet.\n\n"
+                "Run 'sudo pacman -Fy' to sync the file database,\n"
+                "then search again.");
             return;
         }
         
-        // Parse output: repo/package version
-        //   /path/to/file
-        m_searchResults.clear();
-        m_resultsTable->setRowCount(0);
-        
-        QStringList lines = output.split('\n', Qt::SkipEmptyParts);
-        QString currentPkg, currentVersion, currentRepo;
-        QStringList currentFiles;
-        
-        for (const QString& line : lines) {
-            if (!line.startsWith(' ') && !line.startsWith('\t')) {
-                // Package line: repo/package version
-                if (!currentPkg.isEmpty()) {
-                    // Save previous package
-                    PackageResult result;
-                    result.name = currentPkg;
-                    result.version = currentVersion;
-                    result.description = currentFiles.join(", ");
-                    result.source = currentRepo;
-                    result.installed = m_packageManager->packageExists(currentPkg);
-                    m_searchResults.append(result);
-                }
-                
-                // Parse new package
-                QStringList parts = line.split(' ', Qt::SkipEmptyParts);
-                if (parts.size() >= 2) {
-                    QString repoAndName = parts[0];
-                    int slashPos = repoAndName.indexOf('/');
-                    if (slashPos > 0) {
-                        currentRepo = repoAndName.left(slashPos);
-                        currentPkg = repoAndName.mid(slashPos + 1);
-                    } else {
-                        currentPkg = repoAndName;
-                        currentRepo = "repo";
-                    }
-                    currentVersion = parts[1];
-                    currentFiles.clear();
-                }
-            } else {
-                // File line
-                QString file = line.trimmed();
-                if (!file.isEmpty()) {
-                    currentFiles.append(file);
-                }
-            }
+        bool truncated = false;
+        QString error;
+        const QVector<FilesDatabase::Match> matches = files->search(
+            pattern, regex ? FilesDatabase::Regex : FilesDatabase::Auto, MaxFileMatches, &truncated, &error);
+        if (!error.isEmpty()) {
+            m_statusLabel->setText("Error: " + error);
+            return;
         }
         
-        // Don't forget last package
-        if (!currentPkg.isEmpty()) {
-            PackageResult result;
-            result.name = currentPkg;
-            result.version = currentVersion;
-            result.description = currentFiles.join(", ");
-            result.source = currentRepo;
-            result.installed = m_packageManager->packageExists(currentPkg);
-            m_searchResults.append(result);
+        // One row per package, its matching files listed next to it
+        std::shared_ptr<const PackageStore> installed = m_packageManager->store();
+        QHash<int, int> rowOfPackage;
+        m_searchResults.clear();
+        for (const FilesDatabase::Match& match : matches) {
+            int row = rowOfPackage.value(match.package, -1);
+            if (row < 0) {
+                const FilesDatabase::Package& pkg = files->packages()[match.package];
+                SearchResult result;
+                result.name = pkg.name;
+                result.version = pkg.version;
+                result.source = pkg.repository;
+                result.installed = installed && installed->contains(pkg.name);
+                row = m_searchResults.size();
+                rowOfPackage.insert(match.package, row);
+                m_searchResults.append(result);
+            }
+            m_searchResults[row].files.append(match.path);
         }
-        
-        // Display results
-        m_resultsTable->setRowCount(m_searchResults.size());
-        for (int i = 0; i < m_searchResults.size(); ++i) {
-            const PackageResult& result = m_searchResults[i];
-            
-            m_resultsTable->setItem(i, 0, new QTableWidgetItem(result.name));
-            m_resultsTable->setItem(i, 1, new QTableWidgetItem(result.version));
-            
-            QString status = result.installed ? "✅ Installed" : "⬇️ Available";
-            QTableWidgetItem* statusItem = new QTableWidgetItem(status);
-            statusItem->setForeground(result.installed ? QColor("#a6e3a1") : QColor("#89b4fa"));
-            m_resultsTable->setItem(i, 2, statusItem);
-            
-            // Show files in description column
-            m_resultsTable->setItem(i, 3, new QTableWidgetItem(QString("📂 %1").arg(result.description)));
+        showResults();
+        QString status = QString("Found %1 packages providing '%2'").arg(m_searchResults.size()).arg(pattern);
+        if (truncated) {
+            status += QString(" (first %1 files)").arg(MaxFileMatches);
         }
-        
-        m_statusLabel->setText(QString("Found %1 packages providing '%2'")
-            .arg(m_searchResults.size()).arg(filename));
-        
-        m_searchBtn->setEnabled(true);
-        m_searchEdit->setEnabled(true);
-        setCursor(Qt::ArrowCursor);
+        m_statusLabel->setText(status);
     });
-    
-    proc->start("pacman", {"-F", filename});
 }
@@ -2,15 +2,19 @@
 #define SEARCHVIEW_H
 
 #include <QWidget>
+#include <QTimer>
 #include <QLineEdit>
-#include <QTableWidget>
+#include <QTableView>
 #include <QComboBox>
 #include <QPushButton>
 #include <QLabel>
 #include <QTextEdit>
 
+#include "models/SearchResultsModel.h"
+
 class AURClient;
 class PackageManager;
+struct AURPackage;
 
 class SearchView : public QWidget {
     Q_OBJECT
@@ -22,14 +26,25 @@ public:
     
 private slots:
     void performSearch();
-    void onResultClicked(int row, int column);
+    void onSearchTextEdited();  // debounced search as you type
+    void onAurResults(const QList<AURPackage>& packages);
+    void onAurError(const QString& errorMsg);
+    void onResultClicked(const QModelIndex& index);
     void onInstallClicked();
     
 private:
     void setupUI();
     void searchAUR(const QString& query);
     void searchRepo(const QString& query);
-    void searchByFile(const QString& filename);
+    void searchByFile(const QString& pattern, bool regex);
+    
+    // Aborts a running AUR request and drops the results of any running search
+    void cancelSearch();
+    // Narrows the last finished search locally when query only adds to it
+    bool refineResults(const QString& query, const QString& source);
+    void finishSearch();
+    // Orders the backend's results for query, best first, keeping at most limit
+    void rankResults(const QString& query, int limit);
     void showPackageInfo(int row);
     
     PackageManager* m_packageManager;
@@ -41,22 +56,28 @@ private:
     QPushButton* m_searchBtn;
     
     // Results
-    QTableWidget* m_resultsTable;
+    QTableView* m_resultsTable;
+    SearchResultsModel* m_resultsModel;
     QLabel* m_statusLabel;
     
     // Selected package info
     QTextEdit* m_infoText;
     QPushButton* m_installBtn;
     
-    // Current search results metadata
-    struct PackageResult {
-        QString name;
-        QString version;
-        QString description;
-        QString source;  // "aur" or "repo"
-        bool installed;
-    };
-    QList<PackageResult> m_searchResults;
+    // Working set of the current search; the table shows m_resultsModel
+    QList<SearchResult> m_searchResults;
+    
+    void showResults();
+    
+    // In-flight search
+    QTimer* m_debounce;
+    QString m_activeQuery;   // empty when nothing is running
+    QString m_activeSource;
+    
+    // Results of the last finished search, for refining
+    QList<SearchResult> m_candidates;
+    QString m_candidatesQuery;
+    QString m_candidatesSource;
 };
 
 #endif // SEARCHVIEW_H
@@ -0,0 +1,34 @@
+#include "BlockFile.h"
+
+void BlockWriter::block(const void* data, qint64 bytes) {
+    static const char padding[8] = {};
+    const quint64 length = bytes;
+    const qint64 pad = (8 - bytes % 8) % 8;
+    write(&length, sizeof(length));
+    write(data, bytes);
+    write(padding, pad);
+}
+
+void BlockWriter::write(const void* data, qint64 bytes) {
+    if (!m_ok || bytes == 0) return;
+    m_ok = m_device->write(static_cast<const char*>(data), bytes) == bytes;
+}
+
+QByteArrayView BlockReader::block() {
+    quint64 length = 0;
+    if (!m_ok || m_end - m_pos < qint64(sizeof(length))) return fail();
+    std::memcpy(&length, m_pos, sizeof(length));
+    m_pos += sizeof(length);
+
+    const quint64 available = m_end - m_pos;
+    if (length > available) return fail();
+    const quint64 padded = qMin(available, length + (8 - length % 8) % 8);
+    QByteArrayView data(m_pos, qsizetype(length));
+    m_pos += padded;
+    return data;
+}
+
+QByteArrayView BlockReader::fail() {
+    m_ok = false;
+    return QByteArrayView();
+}
@@ -0,0 +1,68 @@
+#ifndef BLOCKFILE_H
+#define BLOCKFILE_H
+
+#include <QByteArrayView>
+#include <QIODevice>
+#include <QVector>
+#include <cstring>
+
+// Length-prefixed binary blocks, padded to 8 bytes so every array in the
+// file starts aligned, in host byte order. Shared by the on-disk caches
+// (store snapshot, files index); their headers carry a byte order mark and
+// a format version, so a file from another machine or release is rejected.
+
+class BlockWriter {
+public:
+    explicit BlockWriter(QIODevice* device) : m_device(device) {}
+
+    void block(const void* data, qint64 bytes);
+
+    template <typename T>
+    void array(const QVector<T>& values) {
+        block(values.constData(), values.size() * qint64(sizeof(T)));
+    }
+
+    bool ok() const { return m_ok; }
+
+private:
+    void write(const void* data, qint64 bytes);
+
+    QIODevice* m_device;
+    bool m_ok = true;
+};
+
+// Reads blocks back from a mapped or loaded file. Any short or oversized
+// block fails the whole read.
+class BlockReader {
+public:
+    BlockReader(const char* data, qint64 size) : m_pos(data), m_end(data + size) {}
+
+    // Points into the file; valid as long as the mapping is
+    QByteArrayView block();
+
+    // Copies a block into out
+    template <typename T>
+    bool array(QVector<T>& out) {
+        const QByteArrayView data = block();
+        if (!m_ok || data.size() % sizeof(T) != 0) {
+            fail();
+            return false;
+        }
+        out.resize(data.size() / sizeof(T));
+        if (!data.isEmpty()) {
+            std::memcpy(out.data(), data.data(), data.size());
+        }
+        return true;
+    }
+
+    bool ok() const { return m_ok; }
+
+private:
+    QByteArrayView fail();
+
+    const char* m_pos;
+    const char* m_end;
+    bool m_ok = true;
+};
+
+#endif // BLOCKFILE_H
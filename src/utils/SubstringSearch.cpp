@@ -0,0 +1,147 @@
+#include "SubstringSearch.h"
+#include <QString>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SUBSTRING_SEARCH_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Searches hay[0, n) for needle[0, k), k >= 1
+using KernelFunction = qsizetype (*)(const char* hay, qsizetype n, const char* needle, qsizetype k);
+
+qsizetype scalarIndexOf(const char* hay, qsizetype n, const char* needle, qsizetype k) {
+    if (n < k) return -1;
+    const char* last = hay + n - k;  // last possible start
+    for (const char* p = hay; p <= last; ++p) {
+        p = static_cast<const char*>(std::memchr(p, needle[0], last - p + 1));
+        if (!p) return -1;
+        if (std::memcmp(p + 1, needle + 1, k - 1) == 0) return p - hay;
+    }
+    return -1;
+}
+
+#ifdef SUBSTRING_SEARCH_X86
+
+// Bytes between the first and the last one still need comparing
+inline bool middleMatches(const char* candidate, const char* needle, qsizetype k) {
+    return k <= 2 || std::memcmp(candidate + 1, needle + 1, k - 2) == 0;
+}
+
+__attribute__((target("sse2")))
+qsizetype sse2IndexOf(const char* hay, qsizetype n, const char* needle, qsizetype k) {
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[k - 1]);
+    qsizetype i = 0;
+    for (; i + k - 1 + 16 <= n; i += 16) {
+        const __m128i blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hay + i));
+        const __m128i blockLast = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hay + i + k - 1));
+        unsigned mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(first, blockFirst),
+                                                        _mm_cmpeq_epi8(last, blockLast)));
+        while (mask) {
+            const int bit = __builtin_ctz(mask);
+            if (middleMatches(hay + i + bit, needle, k)) return i + bit;
+            mask &= mask - 1;
+        }
+    }
+    const qsizetype rest = scalarIndexOf(hay + i, n - i, needle, k);
+    return rest < 0 ? -1 : i + rest;
+}
+
+__attribute__((target("avx2")))
+qsizetype avx2IndexOf(const char* hay, qsizetype n, const char* needle, qsizetype k) {
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i last = _mm256_set1_epi8(needle[k - 1]);
+    qsizetype i = 0;
+    for (; i + k - 1 + 32 <= n; i += 32) {
+        const __m256i blockFirst = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(hay + i));
+        const __m256i blockLast = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(hay + i + k - 1));
+        unsigned mask = unsigned(_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(first, blockFirst),
+                                                                       _mm256_cmpeq_epi8(last, blockLast))));
+        while (mask) {
+            const int bit = __builtin_ctz(mask);
+            if (middleMatches(hay + i + bit, needle, k)) return i + bit;
+            mask &= mask - 1;
+        }
+    }
+    const qsizetype rest = scalarIndexOf(hay + i, n - i, needle, k);
+    return rest < 0 ? -1 : i + rest;
+}
+
+#endif // SUBSTRING_SEARCH_X86
+
+struct Selected {
+    KernelFunction kernel;
+    const char* name;
+};
+
+Selected select() {
+#ifdef SUBSTRING_SEARCH_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return {avx2IndexOf, "avx2"};
+    if (__builtin_cpu_supports("sse2")) return {sse2IndexOf, "sse2"};
+#endif
+    return {scalarIndexOf, "scalar"};
+}
+
+const Selected& selected() {
+    static const Selected instance = select();
+    return instance;
+}
+
+// nullptr if this build or CPU can't run it
+KernelFunction kernelFunction(SubstringSearch::Kernel kernel) {
+    switch (kernel) {
+        case SubstringSearch::Kernel::Scalar:
+            return scalarIndexOf;
+#ifdef SUBSTRING_SEARCH_X86
+        case SubstringSearch::Kernel::Sse2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("sse2") ? sse2IndexOf : nullptr;
+        case SubstringSearch::Kernel::Avx2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2") ? avx2IndexOf : nullptr;
+#else
+        default:
+            return nullptr;
+#endif
+    }
+    return nullptr;
+}
+
+qsizetype run(KernelFunction kernel, QByteArrayView haystack, QByteArrayView needle, qsizetype from) {
+    if (from < 0 || from > haystack.size()) return -1;
+    if (needle.isEmpty()) return from;
+    
+    const qsizetype found = kernel(haystack.data() + from, haystack.size() - from, needle.data(), needle.size());
+    return found < 0 ? -1 : from + found;
+}
+
+} // namespace
+
+namespace SubstringSearch {
+
+qsizetype indexOf(QByteArrayView haystack, QByteArrayView needle, qsizetype from) {
+    return run(selected().kernel, haystack, needle, from);
+}
+
+QByteArray fold(QStringView text) {
+    return text.toString().toCaseFolded().toUtf8();
+}
+
+const char* kernelName() {
+    return selected().name;
+}
+
+bool isAvailable(Kernel kernel) {
+    return kernelFunction(kernel) != nullptr;
+}
+
+qsizetype indexOf(Kernel kernel, QByteArrayView haystack, QByteArrayView needle, qsizetype from) {
+    KernelFunction function = kernelFunction(kernel);
+    return function ? run(function, haystack, needle, from) : -1;
+}
+
+} // namespace SubstringSearch
@@ -0,0 +1,39 @@
+#ifndef SUBSTRINGSEARCH_H
+#define SUBSTRINGSEARCH_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QStringView>
+
+// Byte substring search for text that was case-folded up front.
+//
+// The kernel is picked once at runtime: AVX2 or SSE2 on x86 (both compare
+// the needle's first and last byte against a whole vector of positions and
+// only verify where both match), memchr + memcmp everywhere else. Folding
+// once and searching bytes is what makes case-insensitive search cheap;
+// QString::contains(Qt::CaseInsensitive) folds every character on every call.
+namespace SubstringSearch {
+
+// Position of needle in haystack at or after from, or -1. An empty needle
+// matches at from.
+qsizetype indexOf(QByteArrayView haystack, QByteArrayView needle, qsizetype from = 0);
+
+inline bool contains(QByteArrayView haystack, QByteArrayView needle) {
+    return indexOf(haystack, needle) >= 0;
+}
+
+// Case-folded UTF-8, the form both sides of a search must be in
+QByteArray fold(QStringView text);
+
+// "avx2", "sse2" or "scalar"
+const char* kernelName();
+
+// The individual kernels, for benchmarks and for checking that they agree.
+// indexOf() above uses the best one this CPU can run.
+enum class Kernel { Scalar, Sse2, Avx2 };
+bool isAvailable(Kernel kernel);
+qsizetype indexOf(Kernel kernel, QByteArrayView haystack, QByteArrayView needle, qsizetype from = 0);
+
+} // namespace SubstringSearch
+
+#endif // SUBSTRINGSEARCH_H
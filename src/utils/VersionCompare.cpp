@@ -0,0 +1,129 @@
+#include "VersionCompare.h"
+#include <cstring>
+
+namespace {
+
+// ASCII only, like the C locale libalpm runs these in
+bool isDigit(char c) { return c >= '0' && c <= '9'; }
+bool isAlpha(char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'); }
+bool isAlnum(char c) { return isDigit(c) || isAlpha(c); }
+
+int compareBytes(QByteArrayView a, QByteArrayView b) {
+    const qsizetype common = qMin(a.size(), b.size());
+    const int rc = common ? std::memcmp(a.data(), b.data(), common) : 0;
+    if (rc != 0) return rc < 0 ? -1 : 1;
+    return a.size() == b.size() ? 0 : (a.size() < b.size() ? -1 : 1);
+}
+
+} // namespace
+
+namespace VersionCompare {
+
+Parts split(QByteArrayView evr) {
+    Parts parts;
+    
+    // Epoch: leading digits followed by ':'
+    qsizetype s = 0;
+    while (s < evr.size() && isDigit(evr[s])) ++s;
+    const qsizetype dash = evr.sliced(s).lastIndexOf('-');
+    
+    qsizetype versionStart = 0;
+    if (s < evr.size() && evr[s] == ':') {
+        parts.epoch = s > 0 ? evr.first(s) : QByteArrayView("0");
+        versionStart = s + 1;
+    } else {
+        parts.epoch = QByteArrayView("0");
+    }
+    
+    if (dash >= 0) {
+        parts.version = evr.sliced(versionStart, s + dash - versionStart);
+        parts.release = evr.sliced(s + dash + 1);
+        if (parts.release.isNull()) {
+            parts.release = QByteArrayView("");  // "1.0-" still has a (blank) pkgrel
+        }
+    } else {
+        parts.version = evr.sliced(versionStart);
+    }
+    return parts;
+}
+
+int compare(const Parts& a, const Parts& b) {
+    int rc = compareSegments(a.epoch, b.epoch);
+    if (rc == 0) {
+        rc = compareSegments(a.version, b.version);
+        if (rc == 0 && !a.release.isNull() && !b.release.isNull()) {
+            rc = compareSegments(a.release, b.release);
+        }
+    }
+    return rc;
+}
+
+int compare(QByteArrayView a, QByteArrayView b) {
+    if (a == b) return 0;
+    return compare(split(a), split(b));
+}
+
+int compareSegments(QByteArrayView a, QByteArrayView b) {
+    if (a == b) return 0;
+    
+    const qsizetype endA = a.size();
+    const qsizetype endB = b.size();
+    qsizetype one = 0, two = 0;    // start of the current segment
+    qsizetype ptr1 = 0, ptr2 = 0;  // end of the previous one
+    
+    while (one < endA && two < endB) {
+        while (one < endA && !isAlnum(a[one])) ++one;
+        while (two < endB && !isAlnum(b[two])) ++two;
+        if (one >= endA || two >= endB) break;
+        
+        // Different separator lengths decide it
+        if (one - ptr1 != two - ptr2) {
+            return one - ptr1 < two - ptr2 ? -1 : 1;
+        }
+        
+        // The next run of digits or letters, same kind on both sides
+        ptr1 = one;
+        ptr2 = two;
+        const bool numeric = isDigit(a[ptr1]);
+        if (numeric) {
+            while (ptr1 < endA && isDigit(a[ptr1])) ++ptr1;
+            while (ptr2 < endB && isDigit(b[ptr2])) ++ptr2;
+        } else {
+            while (ptr1 < endA && isAlpha(a[ptr1])) ++ptr1;
+            while (ptr2 < endB && isAlpha(b[ptr2])) ++ptr2;
+        }
+        
+        // b has the other kind here; numbers are newer than letters
+        if (two == ptr2) {
+            return numeric ? 1 : -1;
+        }
+        
+        QByteArrayView segmentA = a.sliced(one, ptr1 - one);
+        QByteArrayView segmentB = b.sliced(two, ptr2 - two);
+        if (numeric) {
+            // By value: drop leading zeros, then more digits is bigger
+            while (segmentA.size() > 0 && segmentA[0] == '0') segmentA = segmentA.sliced(1);
+            while (segmentB.size() > 0 && segmentB[0] == '0') segmentB = segmentB.sliced(1);
+            if (segmentA.size() != segmentB.size()) {
+                return segmentA.size() < segmentB.size() ? -1 : 1;
+            }
+        }
+        const int rc = compareBytes(segmentA, segmentB);
+        if (rc != 0) return rc;
+        
+        one = ptr1;
+        two = ptr2;
+    }
+    
+    // Every segment matched and only separators were left
+    if (one >= endA && two >= endB) return 0;
+    
+    // A leftover run of letters never beats nothing ("1.0a" < "1.0"), any
+    // other leftover does ("1.0.1" > "1.0")
+    if ((one >= endA && !isAlpha(b[two])) || (one < endA && isAlpha(a[one]))) {
+        return -1;
+    }
+    return 1;
+}
+
+} // namespace VersionCompare
@@ -0,0 +1,34 @@
+#ifndef VERSIONCOMPARE_H
+#define VERSIONCOMPARE_H
+
+#include <QByteArrayView>
+
+// Package version ordering, the same as alpm_pkg_vercmp / vercmp(8).
+//
+// "[epoch:]pkgver[-pkgrel]" is split into its parts and each part compared
+// with rpmvercmp: alternating runs of digits and letters, numbers compared
+// by value, so 1.10 is newer than 1.9 and 2.0 is newer than 2.0rc1. A
+// missing epoch is 0 and pkgrel only counts when both sides have one.
+// Splitting is separate from comparing so a sort can split each version
+// once up front.
+namespace VersionCompare {
+
+struct Parts {
+    QByteArrayView epoch;    // "0" when absent
+    QByteArrayView version;
+    QByteArrayView release;  // null when absent
+};
+
+// Views into evr, which must outlive the result
+Parts split(QByteArrayView evr);
+
+// < 0, 0 or > 0 as a is older than, the same as or newer than b
+int compare(const Parts& a, const Parts& b);
+int compare(QByteArrayView a, QByteArrayView b);
+
+// rpmvercmp on a single part
+int compareSegments(QByteArrayView a, QByteArrayView b);
+
+} // namespace VersionCompare
+
+#endif // VERSIONCOMPARE_H